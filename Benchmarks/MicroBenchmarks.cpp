@@ -0,0 +1,264 @@
+#include "MicroBenchmarks.h"
+#include <algorithm>
+#include <cstring>
+
+static constexpr Price MID_PRICE = 30000; // bids rest at and below, asks above, well inside the default ladder
+static constexpr Quantity ORDER_QTY = 10;
+
+/**
+ * @brief Retrieves the id of a resting order placed by fillBook
+ *
+ * @param shape The shape of the book
+ * @param side The side of the order
+ * @param level The level index, 0 being the best
+ * @param position The position in the level's queue, 0 being the front
+ *
+ * @return The id of the order
+ */
+static IdNumber restingId(const BookShape& shape, const Side side, const std::size_t level, const std::size_t position) {
+    return 1 + 2 * (level * shape.ordersPerLevel + position) + (side == Side::SELL ? 1 : 0);
+}
+
+/**
+ * @brief Retrieves the price of a level placed by fillBook
+ *
+ * @param side The side of the level
+ * @param level The level index, 0 being the best
+ *
+ * @return The price of the level
+ */
+static Price levelPrice(const Side side, const std::size_t level) {
+    return side == Side::BUY ? MID_PRICE - static_cast<Price>(level) : MID_PRICE + 1 + static_cast<Price>(level);
+}
+
+template<typename BookType>
+void fillBook(BookType& book, const BookShape& shape, const bool fillBids, const bool fillAsks) {
+    for (std::size_t q = 0; q < shape.ordersPerLevel; q++) {
+        for (std::size_t l = 0; l < shape.depth; l++) {
+            if (fillBids) { book.addOrder(restingId(shape, Side::BUY, l, q), Side::BUY, levelPrice(Side::BUY, l), ORDER_QTY); }
+            if (fillAsks) { book.addOrder(restingId(shape, Side::SELL, l, q), Side::SELL, levelPrice(Side::SELL, l), ORDER_QTY); }
+        }
+    }
+}
+
+/**
+ * @brief Prints the results of a run as CSV with a header line, or as one JSON array
+ *
+ * @param results The results in the order they were measured
+ * @param json If the results should be printed as JSON
+ */
+static void printResults(const std::vector<MicroResult>& results, const bool json) {
+    if (!json) {
+        std::cout << "benchmark,book,depth,orders_per_level,levels_swept,ops_per_rep,reps,ns_per_op_min,ns_per_op_median\n";
+        for (const MicroResult& result : results) {
+            std::cout << result.benchmark << "," << result.book << "," << result.shape.depth << "," << result.shape.ordersPerLevel << ","
+                      << result.levelsSwept << "," << result.opsPerRep << "," << result.reps << "," << result.nsPerOpMin << ","
+                      << result.nsPerOpMedian << "\n";
+        }
+        return;
+    }
+    std::cout << "[\n";
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const MicroResult& result = results[i];
+        std::cout << "  {\"benchmark\":\"" << result.benchmark << "\",\"book\":\"" << result.book << "\",\"depth\":" << result.shape.depth
+                  << ",\"orders_per_level\":" << result.shape.ordersPerLevel << ",\"levels_swept\":" << result.levelsSwept
+                  << ",\"ops_per_rep\":" << result.opsPerRep << ",\"reps\":" << result.reps << ",\"ns_per_op_min\":" << result.nsPerOpMin
+                  << ",\"ns_per_op_median\":" << result.nsPerOpMedian << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    std::cout << "]\n";
+}
+
+/**
+ * @brief Runs a case over fresh books and records the minimum and median time per operation.
+ * Only the body is timed, building and destroying the books is not.
+ *
+ * @param result The description of the case, completed with the timings
+ * @param options The run options
+ * @param setup Builds the book of one repetition
+ * @param body Performs result.opsPerRep operations on the book
+ * @param results Receives the result
+ */
+template<typename Setup, typename Body>
+static void measure(MicroResult result, const MicroOptions& options, Setup&& setup, Body&& body, std::vector<MicroResult>& results) {
+    if (!options.filter.empty() && result.benchmark.find(options.filter) == std::string::npos) { return; }
+
+    result.reps = std::clamp<std::size_t>((options.minOps + result.opsPerRep - 1) / result.opsPerRep, 5, 1000);
+    std::vector<double> nsPerOp;
+    nsPerOp.reserve(result.reps);
+    for (std::size_t rep = 0; rep < result.reps; rep++) {
+        auto book = setup();
+        const auto start = std::chrono::steady_clock::now();
+        body(*book);
+        const auto end = std::chrono::steady_clock::now();
+        nsPerOp.push_back(std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(result.opsPerRep));
+    }
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    result.nsPerOpMin = nsPerOp.front();
+    result.nsPerOpMedian = nsPerOp[nsPerOp.size() / 2];
+    results.push_back(std::move(result));
+}
+
+/**
+ * @brief Builds a book with room for the filled orders plus the orders a case adds
+ *
+ * @param shape The shape to fill
+ * @param extraOrders The orders the case adds on top of the shape
+ * @param mode The matching mode of the book
+ * @param fillBids If the bid side should be filled
+ * @param fillAsks If the ask side should be filled
+ *
+ * @return The filled book
+ */
+template<typename BookType>
+static std::unique_ptr<BookType> makeBook(const BookShape& shape, const std::size_t extraOrders, const MatchingMode mode, const bool fillBids, const bool fillAsks) {
+    auto book = std::make_unique<BookType>(BookConfig{.orderCapacity = 2 * shape.depth * shape.ordersPerLevel + extraOrders, .matchingMode = mode});
+    fillBook(*book, shape, fillBids, fillAsks);
+    return book;
+}
+
+template<typename BookType>
+void benchmarkAddExistingLevel(const char* book, const BookShape& shape, const MicroOptions& options, std::vector<MicroResult>& results) {
+    constexpr std::size_t ADDS = 10000;
+    const IdNumber firstId = restingId(shape, Side::SELL, shape.depth, 0) + 1;
+    measure({.benchmark = "add_existing_level", .book = book, .shape = shape, .opsPerRep = ADDS}, options,
+        [&] { return makeBook<BookType>(shape, ADDS, MatchingMode::BATCH, true, true); },
+        [&](BookType& b) {
+            std::size_t level = 0;
+            for (std::size_t i = 0; i < ADDS; i++) {
+                const Side side = (i & 1) ? Side::SELL : Side::BUY;
+                b.addOrder(firstId + i, side, levelPrice(side, level), ORDER_QTY);
+                if ((i & 1) && ++level == shape.depth) { level = 0; }
+            }
+        }, results);
+}
+
+template<typename BookType>
+void benchmarkAddNewLevel(const char* book, const BookShape& shape, const MicroOptions& options, std::vector<MicroResult>& results) {
+    constexpr std::size_t ADDS = 10000;
+    const IdNumber firstId = restingId(shape, Side::SELL, shape.depth, 0) + 1;
+    measure({.benchmark = "add_new_level", .book = book, .shape = shape, .opsPerRep = ADDS}, options,
+        [&] { return makeBook<BookType>(shape, ADDS, MatchingMode::BATCH, true, true); },
+        [&](BookType& b) {
+            for (std::size_t i = 0; i < ADDS; i++) {
+                const Side side = (i & 1) ? Side::SELL : Side::BUY;
+                b.addOrder(firstId + i, side, levelPrice(side, shape.depth + i / 2), ORDER_QTY);
+            }
+        }, results);
+}
+
+template<typename BookType>
+void benchmarkCancel(const char* book, const BookShape& shape, const MicroOptions& options, std::vector<MicroResult>& results) {
+    // Queue positions in the order they are canceled so that each cancel hits the front, the middle or the back
+    const std::size_t n = shape.ordersPerLevel;
+    std::vector<std::size_t> front(n), back(n), middle;
+    for (std::size_t q = 0; q < n; q++) {
+        front[q] = q;
+        back[q] = n - 1 - q;
+    }
+    for (std::size_t lo = (n - 1) / 2, hi = lo + 1, i = 0; middle.size() < n; i++) {
+        if (i % 2 == 0) { middle.push_back(lo--); }
+        else if (hi < n) { middle.push_back(hi++); }
+    }
+
+    const std::pair<const char*, const std::vector<std::size_t>*> cases[] = {
+        {"cancel_front", &front}, {"cancel_middle", &middle}, {"cancel_back", &back}
+    };
+    for (const auto& [name, positions] : cases) {
+        measure({.benchmark = name, .book = book, .shape = shape, .opsPerRep = shape.depth * n}, options,
+            [&] { return makeBook<BookType>(shape, 0, MatchingMode::BATCH, true, false); },
+            [&](BookType& b) {
+                for (std::size_t l = 0; l < shape.depth; l++) {
+                    for (const std::size_t q : *positions) {
+                        b.cancelOrder(restingId(shape, Side::BUY, l, q));
+                    }
+                }
+            }, results);
+    }
+}
+
+template<typename BookType>
+void benchmarkModify(const char* book, const BookShape& shape, const MicroOptions& options, std::vector<MicroResult>& results) {
+    // A size-up requeues the order at the back of its level, a size-down is applied in place
+    const std::pair<const char*, Quantity> cases[] = {{"modify", ORDER_QTY + 1}, {"modify_reduce", ORDER_QTY - 1}};
+    for (const auto& [name, newQty] : cases) {
+        measure({.benchmark = name, .book = book, .shape = shape, .opsPerRep = shape.depth * shape.ordersPerLevel}, options,
+            [&] { return makeBook<BookType>(shape, 0, MatchingMode::BATCH, true, false); },
+            [&](BookType& b) {
+                for (std::size_t q = 0; q < shape.ordersPerLevel; q++) {
+                    for (std::size_t l = 0; l < shape.depth; l++) {
+                        b.modifyOrder(restingId(shape, Side::BUY, l, q), levelPrice(Side::BUY, l), newQty);
+                    }
+                }
+            }, results);
+    }
+}
+
+template<typename BookType>
+void benchmarkMatchSweep(const char* book, const BookShape& shape, const std::size_t levels, const MicroOptions& options, std::vector<MicroResult>& results) {
+    const IdNumber takerId = restingId(shape, Side::SELL, shape.depth, 0) + 1;
+    const auto sweepQty = static_cast<Quantity>(levels * shape.ordersPerLevel * ORDER_QTY);
+    measure({.benchmark = "match_sweep", .book = book, .shape = shape, .levelsSwept = levels, .opsPerRep = 1}, options,
+        [&] { return makeBook<BookType>(shape, 1, MatchingMode::CONTINUOUS, false, true); },
+        [&](BookType& b) { b.addOrder(takerId, Side::BUY, levelPrice(Side::SELL, levels - 1), sweepQty); },
+        results);
+}
+
+template<typename EngineType>
+void benchmarkEnginePipeline(const char* engine, const MicroOptions& options, std::vector<MicroResult>& results) {
+    constexpr std::size_t COMMANDS = 1000000;
+    static const std::vector<ReplayRecord> flow = generateSyntheticFlow(COMMANDS);
+    std::vector<Command> commands(flow.size());
+    std::transform(flow.begin(), flow.end(), commands.begin(), [](const ReplayRecord& record) { return record.toCommand(); });
+
+    MicroOptions pipelineOptions = options;
+    pipelineOptions.minOps = 5 * COMMANDS; // five repetitions
+    measure({.benchmark = "engine_pipeline", .book = engine, .shape = {0, 0}, .opsPerRep = COMMANDS}, pipelineOptions,
+        [&] {
+            auto eng = std::make_unique<EngineType>(1 << 16, BookConfig{.orderCapacity = COMMANDS});
+            eng->start();
+            return eng;
+        },
+        [&](EngineType& eng) {
+            SeqNum lastSeqNum = 0;
+            for (const Command& c : commands) {
+                lastSeqNum = eng.submit(c);
+            }
+            while (eng.lastProcessed() < lastSeqNum) {
+                std::this_thread::yield();
+            }
+        }, results);
+}
+
+int main(const int argc, char** argv) {
+    MicroOptions options;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--json") == 0) { options.json = true; }
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) { options.filter = argv[++i]; }
+        else if (std::strcmp(argv[i], "--min-ops") == 0 && i + 1 < argc) { options.minOps = std::stoull(argv[++i]); }
+        else {
+            std::cerr << "Usage: Micro_Benchmarks [--json] [--filter name] [--min-ops N]\n";
+            return 1;
+        }
+    }
+    std::vector<MicroResult> results;
+    const BookShape shapes[] = {{10, 1}, {10, 10}, {10, 100}, {100, 1}, {100, 10}, {100, 100}, {1000, 1}, {1000, 10}};
+    for (const BookShape& shape : shapes) {
+        benchmarkAddExistingLevel<OrderBook>("map", shape, options, results);
+        benchmarkAddExistingLevel<LadderOrderBook>("ladder", shape, options, results);
+        benchmarkAddNewLevel<OrderBook>("map", shape, options, results);
+        benchmarkAddNewLevel<LadderOrderBook>("ladder", shape, options, results);
+        benchmarkCancel<OrderBook>("map", shape, options, results);
+        benchmarkCancel<LadderOrderBook>("ladder", shape, options, results);
+        benchmarkModify<OrderBook>("map", shape, options, results);
+        benchmarkModify<LadderOrderBook>("ladder", shape, options, results);
+        for (const std::size_t levels : {std::size_t{1}, std::size_t{10}, std::size_t{100}}) {
+            if (levels > shape.depth) { continue; }
+            benchmarkMatchSweep<OrderBook>("map", shape, levels, options, results);
+            benchmarkMatchSweep<LadderOrderBook>("ladder", shape, levels, options, results);
+        }
+    }
+    benchmarkEnginePipeline<Engine>("mutex", options, results);
+    benchmarkEnginePipeline<SpscEngine>("spsc", options, results);
+    printResults(results, options.json);
+    return 0;
+}
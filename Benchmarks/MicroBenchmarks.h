@@ -0,0 +1,85 @@
+#pragma once
+#include "Order_Book/OrderBook.h"
+#include "Engine/Engine.h"
+#include "Replay/SyntheticFlow.h"
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Shape of the resting book a microbenchmark runs against
+ */
+struct BookShape {
+    std::size_t depth; // price levels on each side
+    std::size_t ordersPerLevel;
+};
+
+/**
+ * @brief Timings of one microbenchmark case
+ */
+struct MicroResult {
+    std::string benchmark;
+    std::string book; // book backend, or the engine for pipeline cases
+    BookShape shape;
+    std::size_t levelsSwept = 0; // match sweeps only
+    std::size_t opsPerRep = 1; // timed operations in each repetition
+    std::size_t reps = 0; // filled in by the run, like the timings
+    double nsPerOpMin = 0.0;
+    double nsPerOpMedian = 0.0;
+};
+
+/**
+ * @brief Options of a microbenchmark run
+ */
+struct MicroOptions {
+    bool json = false; // one JSON array instead of CSV
+    std::string filter; // only run benchmarks whose name contains this
+    std::size_t minOps = 200000; // timed operations per case, spread over the repetitions
+};
+
+/**
+ * @brief Fills both sides of a book with non-crossing orders of quantity 10, in arrival order within
+ * each level. The bid at level l and queue position q has id 1 + 2 * (l * ordersPerLevel + q), the
+ * matching ask the next id.
+ *
+ * @param book The empty book
+ * @param shape The number of levels and orders per level
+ * @param fillBids If the bid side should be filled
+ * @param fillAsks If the ask side should be filled
+ */
+template<typename BookType>
+void fillBook(BookType& book, const BookShape& shape, bool fillBids, bool fillAsks);
+
+/**
+ * @brief Benchmarks adding orders to the back of existing levels, round robin over the levels of both sides
+ */
+template<typename BookType>
+void benchmarkAddExistingLevel(const char* book, const BookShape& shape, const MicroOptions& options, std::vector<MicroResult>& results);
+/**
+ * @brief Benchmarks adding orders that each open a new level behind the existing ones
+ */
+template<typename BookType>
+void benchmarkAddNewLevel(const char* book, const BookShape& shape, const MicroOptions& options, std::vector<MicroResult>& results);
+/**
+ * @brief Benchmarks canceling every bid, always at the front, the middle or the back of its level's queue
+ */
+template<typename BookType>
+void benchmarkCancel(const char* book, const BookShape& shape, const MicroOptions& options, std::vector<MicroResult>& results);
+/**
+ * @brief Benchmarks modifying every bid to a larger (requeued) and to a smaller (in place) quantity at the same price
+ */
+template<typename BookType>
+void benchmarkModify(const char* book, const BookShape& shape, const MicroOptions& options, std::vector<MicroResult>& results);
+/**
+ * @brief Benchmarks one aggressive order sweeping a number of ask levels in continuous matching mode
+ */
+template<typename BookType>
+void benchmarkMatchSweep(const char* book, const BookShape& shape, std::size_t levels, const MicroOptions& options, std::vector<MicroResult>& results);
+/**
+ * @brief Benchmarks a pre-generated add/cancel/modify flow submitted through an engine, per command end to end
+ */
+template<typename EngineType>
+void benchmarkEnginePipeline(const char* engine, const MicroOptions& options, std::vector<MicroResult>& results);
@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Hint to the CPU that the caller is spinning on shared memory
+ */
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/**
+ * @brief How a thread waits for work, trading CPU for wake-up latency
+ */
+enum class WaitStrategy {
+    BUSY_SPIN, // pause instruction only, the lowest latency but the core is never given up
+    SPIN_YIELD, // pause, then yield the time slice once the wait gets long
+    SPIN_PARK // pause, then yield, then sleep in the kernel until a producer wakes the thread
+};
+
+/**
+ * @brief Spin-wait helper for lock-free queues. Spins with a pause instruction first and, unless
+ * busy-spinning, yields the time slice once the wait gets long, so short waits never enter the kernel
+ * while oversubscribed cores still make progress.
+ */
+class Backoff {
+private:
+    static constexpr int SPIN_LIMIT = 128;
+    static constexpr int YIELD_LIMIT = 64; // yields before a SPIN_PARK waiter parks
+    WaitStrategy strategy;
+    int spins = 0;
+
+public:
+    /**
+     * @brief Constructs a backoff for one wait
+     * @param strategy How to wait once spinning gets long
+     */
+    explicit Backoff(const WaitStrategy strategy = WaitStrategy::SPIN_YIELD): strategy(strategy) {}
+
+    /**
+     * @brief Wait a little before retrying
+     * @return True once a SPIN_PARK waiter has spun and yielded long enough that it should park
+     */
+    bool pause() {
+        if (strategy == WaitStrategy::BUSY_SPIN) {
+            cpuRelax();
+            return false;
+        }
+        if (spins < SPIN_LIMIT) {
+            spins++;
+            cpuRelax();
+            return false;
+        }
+        std::this_thread::yield();
+        if (strategy != WaitStrategy::SPIN_PARK) { return false; }
+        if (spins < SPIN_LIMIT + YIELD_LIMIT) {
+            spins++;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Reset after progress was made
+     */
+    void reset() { spins = 0; }
+};
+
+/**
+ * @brief Lets a single consumer sleep in the kernel until a producer publishes. The consumer announces
+ * itself before its final check for work, and producers check for it after publishing, with a full fence
+ * on both sides so at least one of them sees the other and no wake-up is lost. Producers pay one fence
+ * and a load per publish and only enter the kernel when the consumer is actually asleep.
+ */
+class ParkingSpot {
+private:
+    std::atomic<std::uint32_t> parked{0};
+
+public:
+    /**
+     * @brief Sleep until woken, unless work arrived in the meantime (consumer only)
+     * @param ready Returns true if there is work or the queue was stopped
+     */
+    template<typename Ready>
+    void park(const Ready& ready) {
+        parked.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ready()) {
+            parked.wait(1, std::memory_order_acquire);
+        }
+        parked.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Wake the consumer if it is asleep, called after publishing
+     */
+    void wake() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed) && parked.exchange(0, std::memory_order_acq_rel)) {
+            parked.notify_one();
+        }
+    }
+};
@@ -0,0 +1,90 @@
+#include "BatchController.h"
+#include <algorithm>
+
+BatchController::BatchController(const BatchConfig& config):
+    config(config),
+    pending(0),
+    commandNanos(0.0),
+    matchNanos(0.0),
+    passes(0),
+    commands(0),
+    lastBatch(0),
+    minBatch(UINT32_MAX),
+    maxBatch(0),
+    targetBatch(config.policy == BatchPolicy::ADAPTIVE ? config.minBatch : config.maxBatch),
+    lastQueueDepth(0)
+{}
+
+void BatchController::onCommand() {
+    if (pending++ == 0 && config.policy != BatchPolicy::COUNT) {
+        batchStart = Clock::now();
+    }
+}
+
+bool BatchController::shouldMatch(const bool queueEmpty) {
+    if (pending == 0) { return false; }
+    // Nothing is waiting behind this batch so there is nothing to amortize
+    if (queueEmpty) { return true; }
+
+    switch (config.policy) {
+        case BatchPolicy::COUNT:
+            return pending >= config.maxBatch;
+        case BatchPolicy::TIME:
+            return pending % CLOCK_STRIDE == 0 && Clock::now() - batchStart >= config.maxDelay;
+        case BatchPolicy::ADAPTIVE:
+            return pending >= targetBatch.load(std::memory_order_relaxed) ||
+                   (pending % CLOCK_STRIDE == 0 && Clock::now() - batchStart >= config.latencyBudget);
+    }
+    return true;
+}
+
+void BatchController::onMatch(const std::size_t queueDepth, const std::chrono::nanoseconds matchTime) {
+    const std::uint32_t batch = pending;
+    pending = 0;
+
+    passes.fetch_add(1, std::memory_order_relaxed);
+    commands.fetch_add(batch, std::memory_order_relaxed);
+    lastBatch.store(batch, std::memory_order_relaxed);
+    minBatch.store(std::min(minBatch.load(std::memory_order_relaxed), batch), std::memory_order_relaxed);
+    maxBatch.store(std::max(maxBatch.load(std::memory_order_relaxed), batch), std::memory_order_relaxed);
+    lastQueueDepth.store(static_cast<std::uint32_t>(std::min<std::size_t>(queueDepth, UINT32_MAX)), std::memory_order_relaxed);
+
+    if (config.policy != BatchPolicy::ADAPTIVE || batch == 0) { return; }
+
+    // Track the cost of applying a command and of a match pass with moving averages
+    constexpr double WEIGHT = 0.125;
+    const double passNanos = static_cast<double>(matchTime.count());
+    const double batchNanos = std::chrono::duration<double, std::nano>(Clock::now() - batchStart).count();
+    const double perCommand = std::max(batchNanos - passNanos, 0.0) / batch;
+    commandNanos = (commandNanos == 0.0) ? perCommand : commandNanos + WEIGHT * (perCommand - commandNanos);
+    matchNanos = (matchNanos == 0.0) ? passNanos : matchNanos + WEIGHT * (passNanos - matchNanos);
+
+    // The largest batch whose oldest command is still matched within the budget
+    const double budget = static_cast<double>(config.latencyBudget.count()) - matchNanos;
+    double target = (commandNanos > 0.0 && budget > 0.0) ? budget / commandNanos : config.minBatch;
+
+    // Under a burst the backlog already exceeds the budget, so drain it in larger batches
+    // (up to the maximum) rather than paying for extra match passes that lengthen the queue
+    if (static_cast<double>(queueDepth) > target) {
+        target = static_cast<double>(queueDepth);
+    }
+    target = std::clamp(target, static_cast<double>(config.minBatch), static_cast<double>(config.maxBatch));
+    targetBatch.store(static_cast<std::uint32_t>(target), std::memory_order_relaxed);
+}
+
+bool BatchController::timesMatches() const {
+    return config.policy == BatchPolicy::ADAPTIVE;
+}
+
+BatchStats BatchController::stats() const {
+    const std::uint64_t passCount = passes.load(std::memory_order_relaxed);
+    return {
+        passCount,
+        commands.load(std::memory_order_relaxed),
+        lastBatch.load(std::memory_order_relaxed),
+        passCount ? minBatch.load(std::memory_order_relaxed) : 0,
+        maxBatch.load(std::memory_order_relaxed),
+        targetBatch.load(std::memory_order_relaxed),
+        lastQueueDepth.load(std::memory_order_relaxed)
+    };
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief All batching policies that decide when the engine runs the matcher
+ */
+enum class BatchPolicy {
+    COUNT, // match after a fixed number of commands
+    TIME, // match once the oldest unmatched command has waited a fixed delay
+    ADAPTIVE // size batches from measured costs, queue depth and a latency budget
+};
+
+/**
+ * @brief Configuration of the batching policy
+ */
+struct BatchConfig {
+    BatchPolicy policy = BatchPolicy::COUNT;
+    std::uint32_t maxBatch = 30000; // COUNT threshold and upper bound for ADAPTIVE
+    std::uint32_t minBatch = 64; // lower bound for ADAPTIVE
+    std::chrono::nanoseconds maxDelay = std::chrono::microseconds(50); // TIME threshold
+    std::chrono::nanoseconds latencyBudget = std::chrono::microseconds(100); // ADAPTIVE target from command to match
+};
+
+/**
+ * @brief Snapshot of the batch sizes chosen by the controller
+ */
+struct BatchStats {
+    std::uint64_t passes; // number of match passes
+    std::uint64_t commands; // commands covered by all passes
+    std::uint32_t lastBatch;
+    std::uint32_t minBatch;
+    std::uint32_t maxBatch;
+    std::uint32_t targetBatch; // current ADAPTIVE target, or the COUNT threshold
+    std::uint32_t lastQueueDepth; // queue depth observed at the last pass
+};
+
+/**
+ * @brief Decides when the engine should run the matcher. Owned and driven by the engine thread;
+ * the metrics are atomics so other threads can read them without locks.
+ */
+class BatchController {
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::uint32_t CLOCK_STRIDE = 32; // commands between clock reads
+
+    BatchConfig config;
+    std::uint32_t pending;
+    Clock::time_point batchStart;
+    double commandNanos; // moving average of the apply cost per command
+    double matchNanos; // moving average of a match pass
+
+    std::atomic<std::uint64_t> passes;
+    std::atomic<std::uint64_t> commands;
+    std::atomic<std::uint32_t> lastBatch;
+    std::atomic<std::uint32_t> minBatch;
+    std::atomic<std::uint32_t> maxBatch;
+    std::atomic<std::uint32_t> targetBatch;
+    std::atomic<std::uint32_t> lastQueueDepth;
+
+public:
+    /**
+     * @brief Construct a controller
+     * @param config Batching policy configuration
+     */
+    explicit BatchController(const BatchConfig& config = {});
+
+    /**
+     * @brief Record that a command was applied
+     */
+    void onCommand();
+
+    /**
+     * @brief Evaluates if the matcher should run now
+     * @param queueEmpty If the ingress queue is currently empty
+     * @return if the matcher should run
+     */
+    bool shouldMatch(bool queueEmpty);
+
+    /**
+     * @brief Record a match pass and adapt the target batch size
+     * @param queueDepth Number of commands waiting in the ingress queue
+     * @param matchTime Time spent in the match pass
+     */
+    void onMatch(std::size_t queueDepth, std::chrono::nanoseconds matchTime);
+
+    /**
+     * @brief Evaluates if the policy needs match passes to be timed
+     * @return if match passes should be timed
+     */
+    bool timesMatches() const;
+
+    /**
+     * @brief Read the batch size metrics (safe from any thread)
+     * @return Snapshot of the metrics
+     */
+    BatchStats stats() const;
+};
@@ -0,0 +1,70 @@
+#include "BookView.h"
+#include "Order_Book/OrderBook.h"
+#include <algorithm>
+#include <cstring>
+
+BookView::BookView(const std::size_t depth):
+    topVersion(0),
+    top{},
+    current(0),
+    writeIndex(1),
+    depth(depth)
+{
+    for (DepthBuffer& buffer : buffers) {
+        buffer.version.store(0, std::memory_order_relaxed);
+        buffer.seqNum = 0;
+        buffer.bidLevels = 0;
+        buffer.askLevels = 0;
+        buffer.levels = std::make_unique<DepthLevel[]>(2 * depth);
+    }
+}
+
+template<typename Book>
+void BookView::publish(const Book& book, const SeqNum seqNum) {
+    // Fill the buffer readers are not pointed at. A reader still copying from it after the previous flip sees
+    // its version change and retries.
+    DepthBuffer& buffer = buffers[writeIndex];
+    const std::uint64_t version = buffer.version.load(std::memory_order_relaxed);
+    buffer.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    buffer.seqNum = seqNum;
+    buffer.bidLevels = book.getDepth(Side::BUY, std::span<DepthLevel>(buffer.levels.get(), depth));
+    buffer.askLevels = book.getDepth(Side::SELL, std::span<DepthLevel>(buffer.levels.get() + depth, depth));
+    buffer.version.store(version + 2, std::memory_order_release);
+    current.store(writeIndex, std::memory_order_release);
+    writeIndex ^= 1;
+
+    const TopOfBook latest = {seqNum, book.getBestBid(), book.getBestAsk()};
+    const std::uint64_t topSeq = topVersion.load(std::memory_order_relaxed);
+    topVersion.store(topSeq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&top, &latest, sizeof(top));
+    topVersion.store(topSeq + 2, std::memory_order_release);
+}
+
+TopOfBook BookView::readTopOfBook() const {
+    TopOfBook out;
+    while (true) {
+        const std::uint64_t version = topVersion.load(std::memory_order_acquire);
+        if (version & 1) { continue; }
+        std::memcpy(&out, &top, sizeof(out));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (topVersion.load(std::memory_order_relaxed) == version) { return out; }
+    }
+}
+
+DepthView BookView::readDepth(const std::span<DepthLevel> bids, const std::span<DepthLevel> asks) const {
+    while (true) {
+        const DepthBuffer& buffer = buffers[current.load(std::memory_order_acquire)];
+        const std::uint64_t version = buffer.version.load(std::memory_order_acquire);
+        if (version & 1) { continue; }
+        DepthView view = {buffer.seqNum, std::min(buffer.bidLevels, bids.size()), std::min(buffer.askLevels, asks.size())};
+        std::memcpy(bids.data(), buffer.levels.get(), view.bidLevels * sizeof(DepthLevel));
+        std::memcpy(asks.data(), buffer.levels.get() + depth, view.askLevels * sizeof(DepthLevel));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (buffer.version.load(std::memory_order_relaxed) == version) { return view; }
+    }
+}
+
+template void BookView::publish<OrderBook>(const OrderBook&, SeqNum);
+template void BookView::publish<LadderOrderBook>(const LadderOrderBook&, SeqNum);
@@ -0,0 +1,89 @@
+#pragma once
+#include "EngineCommand.h"
+#include "Order_Book/PriceLevel.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+/**
+ * @brief Best bid and ask of a book as of a sequence number
+ */
+struct TopOfBook {
+    SeqNum seqNum; // last command reflected, 0 before the first publish
+    DepthLevel bid; // quantity 0 when the side is empty
+    DepthLevel ask;
+};
+
+/**
+ * @brief Outcome of a depth read
+ */
+struct DepthView {
+    SeqNum seqNum; // last command reflected, 0 before the first publish
+    std::size_t bidLevels; // number of levels copied per side
+    std::size_t askLevels;
+};
+
+/**
+ * @brief Consistent images of a book that the engine thread publishes for readers on other threads.
+ * The top of book sits behind a seqlock, and the depth image is double-buffered with a seqlock on each
+ * buffer: the writer fills the buffer readers are not pointed at and then flips them over. The writer
+ * never waits, a reader only retries when it was overtaken mid-copy, which for the depth image takes
+ * two publishes during one read.
+ */
+class BookView {
+private:
+    /**
+     * @brief One depth image, bids in the first depth slots and asks in the rest
+     */
+    struct alignas(64) DepthBuffer {
+        std::atomic<std::uint64_t> version; // odd while the writer is copying the image in
+        SeqNum seqNum;
+        std::size_t bidLevels;
+        std::size_t askLevels;
+        std::unique_ptr<DepthLevel[]> levels;
+    };
+
+    alignas(64) std::atomic<std::uint64_t> topVersion; // odd while the writer is copying the top of book in
+    TopOfBook top;
+    DepthBuffer buffers[2];
+    alignas(64) std::atomic<std::uint32_t> current; // buffer readers copy from
+    std::uint32_t writeIndex; // buffer the next publish fills, engine thread only
+    std::size_t depth;
+
+public:
+    /**
+     * @brief Constructs an empty view
+     * @param depth Number of levels per side kept in the depth image
+     */
+    explicit BookView(std::size_t depth);
+
+    /**
+     * @brief Copies the top of book and the top levels of both sides of a book into the view (engine thread only)
+     * @tparam Book The order book type (OrderBook or LadderOrderBook)
+     * @param book Book to copy, not crossed
+     * @param seqNum Sequence number of the last command applied to the book
+     */
+    template<typename Book>
+    void publish(const Book& book, SeqNum seqNum);
+
+    /**
+     * @brief Reads the latest top of book (safe from any thread)
+     * @return The best bid and ask and the sequence number they reflect
+     */
+    TopOfBook readTopOfBook() const;
+
+    /**
+     * @brief Reads the latest depth image, both sides as of the same sequence number (safe from any thread)
+     * @param bids Receives the best bid levels, up to its size or the view depth
+     * @param asks Receives the best ask levels, up to its size or the view depth
+     * @return The number of levels copied per side and the sequence number they reflect
+     */
+    DepthView readDepth(std::span<DepthLevel> bids, std::span<DepthLevel> asks) const;
+
+    /**
+     * @brief Retrieves the number of levels per side kept in the depth image
+     * @return The depth
+     */
+    std::size_t getDepth() const { return depth; }
+};
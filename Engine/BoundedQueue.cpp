@@ -1,34 +1,85 @@
 #include "BoundedQueue.h"
+#include <algorithm>
 
 BoundedQueue::BoundedQueue(size_t capacity):
     capacity(capacity),
-    stopped(false)
+    stopped(false),
+    queued(0),
+    waitStrategy(WaitStrategy::SPIN_PARK)
 {}
 
+void BoundedQueue::setWaitStrategy(const WaitStrategy strategy) {
+    waitStrategy = strategy;
+}
+
+void BoundedQueue::spinForWork() const {
+    Backoff backoff(waitStrategy);
+    while (queued.load(std::memory_order_acquire) == 0 && !stopped.load(std::memory_order_acquire)) {
+        if (backoff.pause()) { return; } // time to sleep on the condition variable
+    }
+}
+
 void BoundedQueue::push(const Command& command) {
     std::unique_lock<std::mutex> lock(m);
     // Wait for queue to be not full
     notFull.wait(lock, [&]{ return stopped || q.size() < capacity; });
     if (stopped) return;
     q.push_back(command);
+    queued.store(q.size(), std::memory_order_release);
     notEmpty.notify_one();
 }
 
+void BoundedQueue::pushBulk(const Command* commands, std::size_t count) {
+    std::unique_lock<std::mutex> lock(m);
+    while (count > 0) {
+        // Wait for queue to be not full, then take one lock for as much of the run as fits
+        notFull.wait(lock, [&]{ return stopped || q.size() < capacity; });
+        if (stopped) return;
+        const std::size_t n = std::min(count, capacity - q.size());
+        q.insert(q.end(), commands, commands + n);
+        queued.store(q.size(), std::memory_order_release);
+        commands += n;
+        count -= n;
+        notEmpty.notify_one();
+    }
+}
+
 bool BoundedQueue::pop(Command& out) {
+    spinForWork();
     std::unique_lock<std::mutex> lock(m);
     // Wait for queue to be not empty
     notEmpty.wait(lock, [&]{ return stopped || !q.empty(); });
     if (q.empty()) { return false; }
     out = std::move(q.front());
     q.pop_front();
+    queued.store(q.size(), std::memory_order_relaxed);
     notFull.notify_one();
     return true;
 }
 
+std::size_t BoundedQueue::popBulk(Command* out, const std::size_t maxCommands) {
+    spinForWork();
+    std::unique_lock<std::mutex> lock(m);
+    // Wait for queue to be not empty
+    notEmpty.wait(lock, [&]{ return stopped || !q.empty(); });
+    const std::size_t n = std::min(maxCommands, q.size());
+    std::move(q.begin(), q.begin() + static_cast<std::ptrdiff_t>(n), out);
+    q.erase(q.begin(), q.begin() + static_cast<std::ptrdiff_t>(n));
+    queued.store(q.size(), std::memory_order_relaxed);
+    if (n > 0) { notFull.notify_all(); }
+    return n;
+}
+
 bool BoundedQueue::isEmpty() const {
+    std::lock_guard<std::mutex> lock(m);
     return q.empty();
 }
 
+std::size_t BoundedQueue::size() const {
+    std::lock_guard<std::mutex> lock(m);
+    return q.size();
+}
+
 void BoundedQueue::stop() {
     std::lock_guard<std::mutex> lock(m);
     stopped = true;
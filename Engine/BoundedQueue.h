@@ -1,5 +1,7 @@
 #pragma once
 #include "EngineCommand.h"
+#include "Backoff.h"
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 #include <deque>
@@ -11,9 +13,16 @@ class BoundedQueue {
 private:
     size_t capacity;
     std::deque<Command> q;
-    std::mutex m;
+    mutable std::mutex m;
     std::condition_variable notFull, notEmpty;
-    bool stopped;
+    std::atomic<bool> stopped;
+    std::atomic<std::size_t> queued; // mirror of q.size() written under the lock, so the consumer can spin without it
+    WaitStrategy waitStrategy; // how the consumer waits while the queue is empty
+
+    /**
+     * @brief Spin or yield until the queue has commands or is stopped, as the wait strategy allows
+     */
+    void spinForWork() const;
 
 public:
     /**
@@ -22,12 +31,28 @@ public:
      */
     explicit BoundedQueue(size_t capacity);
 
+    /**
+     * @brief Choose how the consumer waits while the queue is empty. SPIN_PARK (the default) spins and yields
+     * briefly before sleeping on the condition variable, the other strategies never sleep. Must be called
+     * before the queue is used.
+     * @param strategy The wait strategy
+     */
+    void setWaitStrategy(WaitStrategy strategy);
+
     /**
      * @brief Enqueue a command (blocking if full)
      * @param command Command to insert
      */
     void push(const Command& command);
 
+    /**
+     * @brief Enqueue a run of commands in one step (blocking while full). Runs longer than the
+     * free space are published in chunks as the consumer frees slots.
+     * @param commands Commands to insert
+     * @param count Number of commands
+     */
+    void pushBulk(const Command* commands, std::size_t count);
+
     /**
      * @brief Dequeue the next command (blocking if empty)
      * @param out Receives the dequeued command
@@ -35,12 +60,26 @@ public:
      */
     bool pop(Command& out);
 
+    /**
+     * @brief Dequeue every available command up to a limit in one step (blocking if empty)
+     * @param out Buffer receiving the dequeued commands
+     * @param maxCommands Maximum number of commands to dequeue
+     * @return Number of commands dequeued, 0 once the queue is stopped and drained
+     */
+    std::size_t popBulk(Command* out, std::size_t maxCommands);
+
     /**
      * @brief Evaluates if the queue is empty
      * @return if the queue is empty
      */
     bool isEmpty() const;
 
+    /**
+     * @brief Retrieves the number of commands waiting in the queue
+     * @return The approximate number of queued commands
+     */
+    std::size_t size() const;
+
     /**
      * @brief Stop the queue and wake all waiting threads
      */
@@ -0,0 +1,33 @@
+#include "CpuAffinity.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+bool pinCurrentThreadToCore(const int core) {
+    if (core < 0) { return false; }
+#if defined(__linux__)
+    if (core >= CPU_SETSIZE) { return false; }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus) == 0;
+#else
+    return false;
+#endif
+}
+
+std::vector<int> usableCores() {
+    std::vector<int> cores;
+#if defined(__linux__)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus) == 0) {
+        for (int core = 0; core < CPU_SETSIZE; core++) {
+            if (CPU_ISSET(core, &cpus)) { cores.push_back(core); }
+        }
+    }
+#endif
+    return cores;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <vector>
+
+/**
+ * @brief Pin the calling thread to a single CPU core so its caches and TLB stay warm
+ *
+ * @param core Index of the core
+ *
+ * @return True if the thread was pinned, false if the core is invalid or not allowed, or pinning is unsupported
+ */
+bool pinCurrentThreadToCore(int core);
+
+/**
+ * @brief Retrieves the cores the calling thread is allowed to run on
+ *
+ * @return The indexes of the cores in ascending order, empty if pinning is unsupported
+ */
+std::vector<int> usableCores();
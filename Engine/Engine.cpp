@@ -1,81 +1,569 @@
 #include "Engine.h"
+#include "CpuAffinity.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string>
 
-Engine::Engine(size_t queueCapacity):
-    queue(queueCapacity),
+template<typename Book, typename Queue>
+BasicEngine<Book, Queue>::BasicEngine(size_t queueCapacity, const BookConfig& bookConfig, const BatchConfig& batchConfig, const std::size_t maxSymbols,
+                                      const bool defaultBook):
     running(false),
     nextSeq(1),
     lastAppliedSeq(0),
-    pending(0)
-{}
+    queue(queueCapacity),
+    bookConfig(bookConfig),
+    maxSymbols(maxSymbols == 0 ? 1 : maxSymbols),
+    books(new std::atomic<Book*>[this->maxSymbols]),
+    dirty(this->maxSymbols, 0),
+    viewDepth(0),
+    views(new std::atomic<BookView*>[this->maxSymbols]),
+    changed(this->maxSymbols, 0),
+    executionReports(nullptr),
+    marketData(nullptr),
+    rejects(nullptr),
+    journal(nullptr),
+    batcher(batchConfig),
+    batchMatching(bookConfig.matchingMode == MatchingMode::BATCH),
+    cpuCore(-1),
+    timing(false),
+    commandCount(0),
+    rejectedCount(0),
+    queueHighWater(0)
+{
+    for (std::size_t i = 0; i < this->maxSymbols; i++) {
+        books[i].store(nullptr, std::memory_order_relaxed);
+        views[i].store(nullptr, std::memory_order_relaxed);
+    }
+    if (defaultBook) { bookFor(0, true); } // single-symbol users never pass a symbol id
+}
+
+template<typename Book, typename Queue>
+BasicEngine<Book, Queue>::~BasicEngine() { stop(); }
+
+template<typename Book, typename Queue>
+Book* BasicEngine<Book, Queue>::bookFor(const SymbolId symbol, const bool create) {
+    if (symbol >= maxSymbols) { return nullptr; }
+    if (Book* book = books[symbol].load(std::memory_order_relaxed)) {
+        return book;
+    }
+    if (!create) { return nullptr; }
+    ownedBooks.push_back(std::make_unique<Book>(bookConfig));
+    Book* book = ownedBooks.back().get();
+    book->setExecutionReportRing(executionReports, symbol);
+    book->setMarketDataPublisher(marketData, symbol);
+    if (viewDepth > 0) {
+        ownedViews.push_back(std::make_unique<BookView>(viewDepth));
+        views[symbol].store(ownedViews.back().get(), std::memory_order_release);
+    }
+    books[symbol].store(book, std::memory_order_release);
+    return book;
+}
+
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::markDirty(const SymbolId symbol) {
+    if (!dirty[symbol]) {
+        dirty[symbol] = 1;
+        dirtySymbols.push_back(symbol);
+    }
+}
+
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::markChanged(const SymbolId symbol) {
+    if (!changed[symbol]) {
+        changed[symbol] = 1;
+        changedSymbols.push_back(symbol);
+    }
+}
 
-Engine::~Engine() { stop(); }
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::publishViews(const SeqNum lastSeqNum) {
+    for (const SymbolId symbol : changedSymbols) {
+        views[symbol].load(std::memory_order_relaxed)->publish(*books[symbol].load(std::memory_order_relaxed), lastSeqNum);
+        changed[symbol] = 0;
+    }
+    changedSymbols.clear();
+}
 
-void Engine::apply(const Command& cmd) {
+template<typename Book, typename Queue>
+RejectReason BasicEngine<Book, Queue>::apply(const Command& cmd) {
+    Book* book = bookFor(cmd.symbol, cmd.type == CommandType::ADD);
+    if (!book) { return RejectReason::UNKNOWN_SYMBOL; }
     switch (cmd.type) {
         case CommandType::ADD: {
-            const OrderPointer order = std::make_shared<Order>(cmd.idNumber, cmd.side, cmd.price, cmd.qty);
-            book.addOrder(order);
-            break;
+            if (cmd.orderType != OrderType::LIMIT) {
+                return book->executeOrder(cmd.idNumber, cmd.side, cmd.price, cmd.qty, cmd.orderType);
+            }
+            book->addOrder(cmd.idNumber, cmd.side, cmd.price, cmd.qty);
+            return RejectReason::NONE;
         }
         case CommandType::MODIFY: {
-            book.modifyOrder(cmd.idNumber, cmd.price, cmd.qty);
-            break;
+            return book->modifyOrder(cmd.idNumber, cmd.price, cmd.qty).reject;
         }
         case CommandType::CANCEL: {
-            book.cancelOrder(cmd.idNumber);
-            break;
+            return book->cancelOrder(cmd.idNumber);
         }
     }
+    return RejectReason::NONE;
+}
+
+template<typename Book, typename Queue>
+std::uint64_t BasicEngine<Book, Queue>::matchDirtyBooks() {
+    std::uint64_t fills = 0;
+    for (const SymbolId symbol : dirtySymbols) {
+        Book& book = *books[symbol].load(std::memory_order_relaxed);
+        const std::uint64_t tradesBefore = book.getCounters().trades;
+        book.matchOrders();
+        fills += book.getCounters().trades - tradesBefore;
+        dirty[symbol] = 0;
+    }
+    dirtySymbols.clear();
+    return fills;
+}
+
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::matchIfNeeded(const SeqNum lastSeqNum) {
+    // Record the match point first so replay uncrosses the books after the same commands
+    if (journal) { journal->appendMatch(lastSeqNum); }
+
+    const std::size_t queueDepth = queue.size(); // the adaptive batching policy sizes the next batch from it
+    const bool timed = timing.load(std::memory_order_relaxed);
+    const std::uint64_t start = (timed || batcher.timesMatches()) ? metricsNow() : 0;
+    const std::uint64_t fills = matchDirtyBooks();
+    const std::uint64_t matchTime = (timed || batcher.timesMatches()) ? metricsNow() - start : 0;
+    publishViews(lastSeqNum); // the books are uncrossed until the next add or modify
+
+    if (!timed && !batcher.timesMatches()) {
+        batcher.onMatch(queueDepth, std::chrono::nanoseconds::zero());
+        return;
+    }
+    batcher.onMatch(queueDepth, std::chrono::nanoseconds(matchTime));
+    if (timed) {
+        metrics.matchTime.record(matchTime);
+        metrics.fillsPerMatch.record(fills);
+    }
 }
 
-void Engine::matchIfNeeded() {
-    book.matchOrders();
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::recordApply(const CommandType type, const std::uint64_t nanos) {
+    switch (type) {
+        case CommandType::ADD: metrics.addTime.record(nanos); break;
+        case CommandType::MODIFY: metrics.modifyTime.record(nanos); break;
+        case CommandType::CANCEL: metrics.cancelTime.record(nanos); break;
+    }
 }
 
-void Engine::run() {
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::run() {
+    std::unique_ptr<Command[]> batch = std::make_unique<Command[]>(DEQUEUE_BATCH);
     while (running.load(std::memory_order_relaxed)) {
-        Command cmd;
-        if (!queue.pop(cmd)) {
+        // Only this thread drains the queue, so it is deepest right before a dequeue. A dequeue that waited
+        // on an empty queue is measured by the batch it returns.
+        const std::size_t queued = queue.size();
+        // Take everything available up to DEQUEUE_BATCH so the queue synchronizes once per batch
+        const std::size_t count = queue.popBulk(batch.get(), DEQUEUE_BATCH);
+        if (count == 0) {
             break;
         }
-        try {
-            apply(cmd);
-            // Match if pending is more than the BATCH threshold or if the queue is empty
-            if (++pending >= BATCH || queue.isEmpty()) {
-                matchIfNeeded();
-                pending = 0;
+        const std::size_t queueDepth = std::max(queued, count);
+        if (queueDepth > queueHighWater.load(std::memory_order_relaxed)) {
+            queueHighWater.store(queueDepth, std::memory_order_relaxed);
+        }
+        if constexpr (sequencesOnDequeue<Queue>) {
+            // The merge order of the lanes is the global order, only the engine thread writes nextSeq
+            SeqNum next = nextSeq.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < count; i++) {
+                batch[i].seqNum = next++;
             }
-            lastAppliedSeq.store(cmd.seqNum, std::memory_order_release);
-        } catch (const std::exception& e) {
-            if (onError) { onError(cmd, e); }
-            lastAppliedSeq.store(cmd.seqNum, std::memory_order_release);
+            nextSeq.store(next, std::memory_order_relaxed);
         }
+        const bool timed = timing.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < count; i++) {
+            const Command& cmd = batch[i];
+            // An immediate order trades against an uncrossed book, so a crossed book gets a regular pass
+            // first, journaled, timed and reported to the batching policy, instead of one hidden in apply
+            if (batchMatching && cmd.type == CommandType::ADD && cmd.orderType != OrderType::LIMIT &&
+                cmd.symbol < maxSymbols && dirty[cmd.symbol]) {
+                matchIfNeeded(cmd.seqNum - 1);
+            }
+            const std::uint64_t dequeued = timed ? metricsNow() : 0;
+            if (timed && cmd.submitTime != 0 && dequeued >= cmd.submitTime) {
+                metrics.queueDelay.record(dequeued - cmd.submitTime);
+            }
 
+            bump(commandCount);
+
+            try {
+                if (journal) { journal->append(cmd); } // write ahead, rejected commands are replayed as rejects
+                const RejectReason reject = apply(cmd);
+                if (reject == RejectReason::NONE) [[likely]] {
+                    if (timed) { recordApply(cmd.type, metricsNow() - dequeued); }
+                    if (batchMatching && cmd.type != CommandType::CANCEL) { markDirty(cmd.symbol); } // only adds and modifies can cross
+                    if (viewDepth > 0) { markChanged(cmd.symbol); }
+                }
+                else {
+                    bump(rejectedCount);
+                    if (rejects) { rejects->push({cmd.seqNum, cmd.symbol, cmd.idNumber, cmd.type, reject}); }
+                }
+            } catch (const std::exception& e) {
+                // Only invariant violations and allocation failures reach this point
+                bump(rejectedCount);
+                if (onError) { onError(cmd, e); }
+            }
+
+            // Match when the batching policy says the batch is complete or the queue is empty, even if
+            // this command was rejected, so earlier commands of the batch are not left uncrossed
+            if (batchMatching) {
+                batcher.onCommand();
+                if (batcher.shouldMatch(i + 1 == count && queue.isEmpty())) {
+                    matchIfNeeded(cmd.seqNum);
+                }
+            }
+        }
+        if (journal) {
+            // Group commit before the batch is reported as processed. A failed sync is reported like a failed
+            // apply, against the last command of the batch, and stays readable as the journal's sync error
+            try {
+                journal->commit();
+            } catch (const std::exception& e) {
+                if (onError) { onError(batch[count - 1], e); }
+            }
+        }
+        if (!batchMatching) { publishViews(batch[count - 1].seqNum); } // books never cross in continuous mode
+        lastAppliedSeq.store(batch[count - 1].seqNum, std::memory_order_release);
+        if constexpr (sequencesOnDequeue<Queue>) { queue.markApplied(); }
     }
 }
 
-void Engine::start() {
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::start() {
     bool expected = false;
     if (!running.compare_exchange_strong(expected, true)) { return; }
-    engineThread = std::thread([this]{ this->run(); });
+    // Views start from the books as constructed, loaded from a snapshot or recovered
+    for (std::size_t symbol = 0; symbol < maxSymbols; symbol++) {
+        if (BookView* view = views[symbol].load(std::memory_order_relaxed)) {
+            view->publish(*books[symbol].load(std::memory_order_relaxed), lastAppliedSeq.load(std::memory_order_relaxed));
+        }
+    }
+    // The thread pins itself before it takes its first command, and start() waits to learn if it could
+    std::promise<bool> pinning;
+    std::future<bool> pinned = pinning.get_future();
+    engineThread = std::thread([this, pinning = std::move(pinning)]() mutable {
+        const bool ok = cpuCore < 0 || pinCurrentThreadToCore(cpuCore);
+        pinning.set_value(ok);
+        if (ok) { this->run(); }
+    });
+    if (!pinned.get()) {
+        engineThread.join();
+        running.store(false);
+        throw std::runtime_error("Engine thread cannot be pinned to core (" + std::to_string(cpuCore) + ")");
+    }
 }
 
-void Engine::stop() {
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::setCpuAffinity(const int core) { cpuCore = core; }
+
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::setWaitStrategy(const WaitStrategy strategy) { queue.setWaitStrategy(strategy); }
+
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::stop() {
     bool expected = true;
     if (!running.compare_exchange_strong(expected, false)) { return; }
     queue.stop();
     if (engineThread.joinable()) { engineThread.join(); }
 }
 
-SeqNum Engine::submit(Command cmd) {
-    cmd.seqNum = nextSeq.fetch_add(1, std::memory_order_relaxed);
-    queue.push(cmd);
-    return cmd.seqNum;
+template<typename Book, typename Queue>
+SeqNum BasicEngine<Book, Queue>::submit(Command cmd) {
+    if constexpr (sequencesOnDequeue<Queue>) {
+        return submit(LaneQueue::DEFAULT_PRODUCER, cmd);
+    }
+    else {
+        cmd.seqNum = nextSeq.fetch_add(1, std::memory_order_relaxed);
+        cmd.submitTime = timing.load(std::memory_order_relaxed) ? metricsNow() : 0;
+        queue.push(cmd);
+        return cmd.seqNum;
+    }
+}
+
+template<typename Book, typename Queue>
+SeqNum BasicEngine<Book, Queue>::submitBatch(const std::span<const Command> commands) {
+    if constexpr (sequencesOnDequeue<Queue>) {
+        return submitBatch(LaneQueue::DEFAULT_PRODUCER, commands);
+    }
+    else {
+        if (commands.empty()) { return lastSubmitted(); }
+        // Reserve the whole sequence range in one step
+        const SeqNum first = nextSeq.fetch_add(commands.size(), std::memory_order_relaxed);
+        const std::uint64_t submitTime = timing.load(std::memory_order_relaxed) ? metricsNow() : 0;
+
+        // Stamp and publish the batch in chunks so large batches need no allocation
+        Command chunk[SUBMIT_CHUNK];
+        for (std::size_t offset = 0; offset < commands.size(); offset += SUBMIT_CHUNK) {
+            const std::size_t n = std::min(SUBMIT_CHUNK, commands.size() - offset);
+            for (std::size_t i = 0; i < n; i++) {
+                chunk[i] = commands[offset + i];
+                chunk[i].seqNum = first + offset + i;
+                chunk[i].submitTime = submitTime;
+            }
+            queue.pushBulk(chunk, n);
+        }
+        return first + commands.size() - 1;
+    }
+}
+
+template<typename Book, typename Queue>
+ProducerId BasicEngine<Book, Queue>::registerProducer() requires sequencesOnDequeue<Queue> {
+    return queue.registerProducer();
+}
+
+template<typename Book, typename Queue>
+SeqNum BasicEngine<Book, Queue>::submit(const ProducerId producer, Command cmd) requires sequencesOnDequeue<Queue> {
+    cmd.submitTime = timing.load(std::memory_order_relaxed) ? metricsNow() : 0;
+    return queue.push(producer, cmd);
+}
+
+template<typename Book, typename Queue>
+SeqNum BasicEngine<Book, Queue>::submitBatch(const ProducerId producer, const std::span<const Command> commands) requires sequencesOnDequeue<Queue> {
+    const std::uint64_t submitTime = timing.load(std::memory_order_relaxed) ? metricsNow() : 0;
+    Command chunk[SUBMIT_CHUNK];
+    SeqNum position = queue.submitted(producer);
+    for (std::size_t offset = 0; offset < commands.size(); offset += SUBMIT_CHUNK) {
+        const std::size_t n = std::min(SUBMIT_CHUNK, commands.size() - offset);
+        for (std::size_t i = 0; i < n; i++) {
+            chunk[i] = commands[offset + i];
+            chunk[i].submitTime = submitTime;
+        }
+        position = queue.pushBulk(producer, chunk, n);
+    }
+    return position;
+}
+
+template<typename Book, typename Queue>
+SeqNum BasicEngine<Book, Queue>::lastProcessed(const ProducerId producer) const requires sequencesOnDequeue<Queue> {
+    return queue.applied(producer);
+}
+
+template<typename Book, typename Queue>
+const Book& BasicEngine<Book, Queue>::getBook(const SymbolId symbol) const {
+    const Book* book = symbol < maxSymbols ? books[symbol].load(std::memory_order_acquire) : nullptr;
+    if (!book) {
+        throw std::logic_error("Symbol (" + std::to_string(symbol) + ") has no order book");
+    }
+    return *book;
+}
+
+template<typename Book, typename Queue>
+bool BasicEngine<Book, Queue>::hasBook(const SymbolId symbol) const {
+    return symbol < maxSymbols && books[symbol].load(std::memory_order_acquire) != nullptr;
+}
+
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::enableBookViews(const std::size_t depth) {
+    if (viewDepth > 0 || depth == 0) { return; }
+    viewDepth = depth;
+    for (std::size_t symbol = 0; symbol < maxSymbols; symbol++) {
+        if (books[symbol].load(std::memory_order_relaxed)) {
+            ownedViews.push_back(std::make_unique<BookView>(viewDepth));
+            views[symbol].store(ownedViews.back().get(), std::memory_order_release);
+        }
+    }
+}
+
+template<typename Book, typename Queue>
+const BookView& BasicEngine<Book, Queue>::getBookView(const SymbolId symbol) const {
+    const BookView* view = symbol < maxSymbols ? views[symbol].load(std::memory_order_acquire) : nullptr;
+    if (!view) {
+        throw std::logic_error("Symbol (" + std::to_string(symbol) + ") has no book view");
+    }
+    return *view;
+}
+
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::setExecutionReportRing(ExecutionReportRing* ring) {
+    executionReports = ring;
+    for (std::size_t symbol = 0; symbol < maxSymbols; symbol++) {
+        if (Book* book = books[symbol].load(std::memory_order_relaxed)) {
+            book->setExecutionReportRing(ring, static_cast<std::uint32_t>(symbol));
+        }
+    }
+}
+
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::setMarketDataPublisher(MarketDataPublisher* publisher) {
+    marketData = publisher;
+    for (std::size_t symbol = 0; symbol < maxSymbols; symbol++) {
+        if (Book* book = books[symbol].load(std::memory_order_relaxed)) {
+            book->setMarketDataPublisher(publisher, static_cast<std::uint32_t>(symbol));
+        }
+    }
+}
+
+template<typename Book, typename Queue>
+SeqNum BasicEngine<Book, Queue>::lastProcessed() const { return lastAppliedSeq.load(); }
+
+template<typename Book, typename Queue>
+SeqNum BasicEngine<Book, Queue>::lastSubmitted() const { return nextSeq.load() - 1; }
+
+template<typename Book, typename Queue>
+BatchStats BasicEngine<Book, Queue>::batchStats() const { return batcher.stats(); }
+
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::enableMetrics(const bool enabled) { timing.store(enabled, std::memory_order_relaxed); }
+
+template<typename Book, typename Queue>
+const EngineMetrics& BasicEngine<Book, Queue>::getMetrics() const { return metrics; }
+
+template<typename Book, typename Queue>
+EngineCounters BasicEngine<Book, Queue>::getCounters() const {
+    EngineCounters counters = {
+        commandCount.load(std::memory_order_relaxed),
+        rejectedCount.load(std::memory_order_relaxed),
+        0,
+        0,
+        0,
+        queueHighWater.load(std::memory_order_relaxed)
+    };
+    for (std::size_t i = 0; i < maxSymbols; i++) {
+        if (const Book* book = books[i].load(std::memory_order_acquire)) {
+            const BookCounters bookCounters = book->getCounters();
+            counters.levelsCreated += bookCounters.levelsCreated;
+            counters.levelsDestroyed += bookCounters.levelsDestroyed;
+            counters.trades += bookCounters.trades;
+        }
+    }
+    return counters;
+}
+
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::setJournal(Journal* journal) { this->journal = journal; }
+
+template<typename Book, typename Queue>
+std::size_t BasicEngine<Book, Queue>::recover() {
+    if (!journal || running.load()) { return 0; }
+    std::size_t commands = 0;
+    const SeqNum snapshotSeqNum = lastAppliedSeq.load(); // records up to a loaded snapshot are already reflected
+    SeqNum lastSeqNum = snapshotSeqNum;
+    journal->replay([&](const JournalRecord& record) {
+        if (record.seqNum <= snapshotSeqNum) { return; }
+        if (record.recordType == JournalRecordType::MATCH) {
+            matchDirtyBooks();
+            return;
+        }
+        const Command cmd = record.toCommand();
+        if (apply(cmd) == RejectReason::NONE && batchMatching && cmd.type != CommandType::CANCEL) {
+            markDirty(cmd.symbol);
+        }
+        lastSeqNum = cmd.seqNum;
+        commands++;
+    });
+    // Books touched after the last match point stay dirty and are uncrossed by the next live pass
+    nextSeq.store(lastSeqNum + 1);
+    lastAppliedSeq.store(lastSeqNum);
+    return commands;
+}
+
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::saveSnapshot(const std::string& path) const {
+    if (running.load()) {
+        throw std::logic_error("Snapshot can only be taken while the engine is stopped");
+    }
+    std::size_t bytes = sizeof(SnapshotHeader);
+    std::uint32_t bookCount = 0;
+    for (std::size_t symbol = 0; symbol < maxSymbols; symbol++) {
+        if (const Book* book = books[symbol].load(std::memory_order_relaxed)) {
+            bytes += sizeof(SnapshotSection) + book->snapshotSize();
+            bookCount++;
+        }
+    }
+
+    // Write next to the snapshot and rename it into place, so a crash or a full disk never leaves
+    // a partial file where the last good snapshot was
+    const std::string tmpPath = path + ".tmp";
+    try {
+        MappedFile file(tmpPath, bytes);
+        std::uint8_t* out = file.data() + sizeof(SnapshotHeader);
+        for (std::size_t symbol = 0; symbol < maxSymbols; symbol++) {
+            if (const Book* book = books[symbol].load(std::memory_order_relaxed)) {
+                const SnapshotSection section = {static_cast<std::uint32_t>(symbol), 0, book->snapshotSize()};
+                std::memcpy(out, &section, sizeof(section));
+                out = book->writeSnapshot(out + sizeof(section));
+            }
+        }
+        SnapshotHeader header = {SNAPSHOT_MAGIC, SNAPSHOT_VERSION, bookCount, lastAppliedSeq.load(), bytes, 0};
+        const std::uint64_t headerHash = snapshotChecksum(reinterpret_cast<const std::uint8_t*>(&header), offsetof(SnapshotHeader, checksum));
+        header.checksum = snapshotChecksum(file.data() + sizeof(header), bytes - sizeof(header), headerHash);
+        std::memcpy(file.data(), &header, sizeof(header));
+        file.sync();
+    } catch (...) {
+        std::remove(tmpPath.c_str());
+        throw;
+    }
+    replaceFile(tmpPath, path);
 }
 
-const OrderBook& Engine::getBook() const { return book; }
+template<typename Book, typename Queue>
+SeqNum BasicEngine<Book, Queue>::loadSnapshot(const std::string& path) {
+    if (running.load()) {
+        throw std::logic_error("Snapshot can only be loaded before the engine is started");
+    }
+    const MappedFile file(path);
+    const std::uint8_t* in = file.data();
+    const std::uint8_t* end = in + file.size();
+
+    SnapshotHeader header{};
+    if (file.size() < sizeof(header)) {
+        throw std::runtime_error("Snapshot ('" + path + "') is truncated");
+    }
+    std::memcpy(&header, in, sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION) {
+        throw std::runtime_error("Snapshot ('" + path + "') is not a snapshot of this version");
+    }
+    if (header.bytes != file.size()) {
+        throw std::runtime_error("Snapshot ('" + path + "') is truncated");
+    }
+    const std::uint64_t headerHash = snapshotChecksum(in, offsetof(SnapshotHeader, checksum));
+    if (snapshotChecksum(in + sizeof(header), file.size() - sizeof(header), headerHash) != header.checksum) {
+        throw std::runtime_error("Snapshot ('" + path + "') is corrupt");
+    }
+    in += sizeof(header);
+
+    for (std::uint32_t i = 0; i < header.bookCount; i++) {
+        SnapshotSection section{};
+        if (end - in < static_cast<std::ptrdiff_t>(sizeof(section))) {
+            throw std::runtime_error("Snapshot ('" + path + "') is truncated");
+        }
+        std::memcpy(&section, in, sizeof(section));
+        in += sizeof(section);
+        Book* book = bookFor(section.symbol, true);
+        if (!book || static_cast<std::size_t>(end - in) < section.bytes) {
+            throw std::runtime_error("Snapshot ('" + path + "') has a malformed book section");
+        }
+        in = book->loadSnapshot(in, in + section.bytes);
+        if (batchMatching) { markDirty(section.symbol); } // uncrossed by the next pass, like on the live engine
+    }
+
+    nextSeq.store(header.lastSeqNum + 1);
+    lastAppliedSeq.store(header.lastSeqNum);
+    return header.lastSeqNum;
+}
 
-SeqNum Engine::lastProcessed() const { return lastAppliedSeq.load(); }
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::setRejectRing(RejectRing* ring) { rejects = ring; }
 
-void Engine::set_error_handler(ErrorHandler f) { onError = std::move(f); }
+template<typename Book, typename Queue>
+void BasicEngine<Book, Queue>::set_error_handler(ErrorHandler f) { onError = std::move(f); }
 
+template class BasicEngine<OrderBook, BoundedQueue>;
+template class BasicEngine<OrderBook, SpscRingQueue>;
+template class BasicEngine<OrderBook, MpscRingQueue>;
+template class BasicEngine<LadderOrderBook, BoundedQueue>;
+template class BasicEngine<LadderOrderBook, SpscRingQueue>;
+template class BasicEngine<LadderOrderBook, MpscRingQueue>;
+template class BasicEngine<OrderBook, LaneQueue>;
+template class BasicEngine<LadderOrderBook, LaneQueue>;
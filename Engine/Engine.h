@@ -1,39 +1,136 @@
 #pragma once
 #include "EngineCommand.h"
+#include "BatchController.h"
+#include "BookView.h"
+#include "EngineMetrics.h"
+#include "RejectEvent.h"
+#include "Journal.h"
 #include "BoundedQueue.h"
+#include "SpscRingQueue.h"
+#include "MpscRingQueue.h"
+#include "LaneQueue.h"
 #include "Order_Book/OrderBook.h"
 #include <atomic>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
 #include <thread>
+#include <vector>
 
 using ErrorHandler = std::function<void(const Command&, const std::exception&)>;
 
 /**
  * @brief Matching engine that processes commands in a worker thread
+ *
+ * @tparam Book The order book type (OrderBook or LadderOrderBook)
+ * @tparam Queue The ingress queue type (BoundedQueue, SpscRingQueue for a single submitting thread, MpscRingQueue,
+ * or LaneQueue for registered producers that the engine sequences on dequeue)
  */
-class Engine {
+template<typename Book, typename Queue = BoundedQueue>
+class BasicEngine {
 private:
-    std::atomic<bool> running;
+    static constexpr std::size_t DEQUEUE_BATCH = 256; // commands taken from the queue per dequeue
+    static constexpr std::size_t SUBMIT_CHUNK = 256; // commands stamped and published per bulk push
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    // Each hot atomic sits on its own line, so producers bumping nextSeq and waiters polling
+    // lastAppliedSeq never invalidate the line the engine thread reads running from
+    alignas(CACHE_LINE) std::atomic<bool> running;
     std::thread engineThread;
 
-    std::atomic<SeqNum> nextSeq;
-    std::atomic<SeqNum> lastAppliedSeq;
-    BoundedQueue queue;
-    OrderBook book;
-    static constexpr int BATCH = 30000;
-    int pending;
+    alignas(CACHE_LINE) std::atomic<SeqNum> nextSeq; // written by producers, or by the engine thread with LaneQueue
+    alignas(CACHE_LINE) std::atomic<SeqNum> lastAppliedSeq; // written by the engine thread
+    alignas(CACHE_LINE) Queue queue;
+    BookConfig bookConfig;
+    std::size_t maxSymbols;
+    std::unique_ptr<std::atomic<Book*>[]> books; // indexed by symbol id, published by the engine thread
+    std::vector<std::unique_ptr<Book>> ownedBooks;
+    std::vector<SymbolId> dirtySymbols; // books touched since the last match pass
+    std::vector<std::uint8_t> dirty;
+    std::size_t viewDepth; // levels per side in the book views, 0 when views are disabled
+    std::unique_ptr<std::atomic<BookView*>[]> views; // indexed by symbol id, published with their book
+    std::vector<std::unique_ptr<BookView>> ownedViews;
+    std::vector<SymbolId> changedSymbols; // books changed since their view was last published
+    std::vector<std::uint8_t> changed;
+    ExecutionReportRing* executionReports;
+    MarketDataPublisher* marketData; // optional book event stream, nullptr when disabled
+    RejectRing* rejects; // optional reject channel, nullptr when disabled
+    Journal* journal; // optional write-ahead journal, nullptr when disabled
+    BatchController batcher;
+    bool batchMatching; // false when the book matches orders on arrival
+    int cpuCore;
 
     ErrorHandler onError;
 
+    std::atomic<bool> timing; // record latency histograms
+    EngineMetrics metrics;
+    std::atomic<std::uint64_t> commandCount;
+    std::atomic<std::uint64_t> rejectedCount;
+    std::atomic<std::size_t> queueHighWater;
+
+    /**
+     * @brief Increments a counter that only the engine thread writes, without a locked instruction
+     * @param counter Counter to increment
+     * @return The incremented value
+     */
+    static std::uint64_t bump(std::atomic<std::uint64_t>& counter) {
+        const std::uint64_t value = counter.load(std::memory_order_relaxed) + 1;
+        counter.store(value, std::memory_order_relaxed);
+        return value;
+    }
+
+    /**
+     * @brief Retrieve the book of a symbol, creating it if requested
+     * @param symbol Symbol id of the book
+     * @param create If a missing book should be created
+     * @return Pointer to the book, or nullptr if it does not exist or the symbol is outside the table
+     */
+    Book* bookFor(SymbolId symbol, bool create);
+
+    /**
+     * @brief Remember that a book may have crossed since the last match pass
+     * @param symbol Symbol id of the book
+     */
+    void markDirty(SymbolId symbol);
+
     /**
-     * @brief Apply a single command to the order book
+     * @brief Remember that the view of a book is stale
+     * @param symbol Symbol id of the book
+     */
+    void markChanged(SymbolId symbol);
+
+    /**
+     * @brief Publish the view of every book changed since the last publish
+     * @param lastSeqNum Sequence number of the last command applied to the books
+     */
+    void publishViews(SeqNum lastSeqNum);
+
+    /**
+     * @brief Record the apply time of a command in the histogram of its type
+     * @param type Type of the applied command
+     * @param nanos Time spent in apply
+     */
+    void recordApply(CommandType type, std::uint64_t nanos);
+
+    /**
+     * @brief Apply a single command to the order book of its symbol
      * @param cmd Command to apply
+     * @return NONE if the command was applied, otherwise the reason it was rejected
+     */
+    RejectReason apply(const Command& cmd);
+
+    /**
+     * @brief Run the matcher on every book touched since the last pass
+     * @return Number of fills of the pass
      */
-    void apply(const Command& cmd);
+    std::uint64_t matchDirtyBooks();
 
     /**
-     * @brief Run the matcher if the batch threshold has been reached.
+     * @brief Run the matcher on every book touched since the last pass and report the pass to the batch controller
+     * @param lastSeqNum Sequence number of the last command applied before the pass
      */
-    void matchIfNeeded();
+    void matchIfNeeded(SeqNum lastSeqNum);
 
 
     /**
@@ -45,16 +142,38 @@ public:
     /**
      * @brief Construct the engine
      * @param queueCapacity Capacity of the internal command queue
+     * @param bookConfig Configuration of the internal order book
+     * @param batchConfig Policy deciding when the matcher runs in batch matching mode
+     * @param maxSymbols Number of symbol ids the engine can hold books for
+     * @param defaultBook Create the book of symbol 0 up front, false to create it on its first ADD like any other book
      */
-    explicit Engine(size_t queueCapacity = 1 << 16);
+    explicit BasicEngine(size_t queueCapacity = 1 << 16, const BookConfig& bookConfig = {}, const BatchConfig& batchConfig = {}, std::size_t maxSymbols = 1 << 12,
+                         bool defaultBook = true);
 
     /**
      * @brief Destroy the engine, stopping the worker thread if running
      */
-    ~Engine();
+    ~BasicEngine();
 
     /**
-     * @brief Start the worker thread
+     * @brief Pin the worker thread to a core. The thread pins itself before it takes its first command. Must be called before start().
+     * @param core Index of the core, or a negative value to leave the thread unpinned
+     */
+    void setCpuAffinity(int core);
+
+    /**
+     * @brief Choose how the worker thread waits while the queue is empty. BUSY_SPIN gives the lowest wake-up
+     * latency and burns its core, best with setCpuAffinity on an isolated core. SPIN_YIELD gives the core up
+     * to other threads once the wait gets long. SPIN_PARK also sleeps in the kernel after that, at the cost of
+     * a wake-up on the next command. The default is SPIN_PARK for BoundedQueue and SPIN_YIELD for the rings.
+     * Must be called before start().
+     * @param strategy The wait strategy
+     */
+    void setWaitStrategy(WaitStrategy strategy);
+
+    /**
+     * @brief Start the worker thread. Throws std::runtime_error, leaving the engine stopped, if the thread cannot be pinned
+     * to the core set with setCpuAffinity.
      */
     void start();
 
@@ -64,17 +183,85 @@ public:
     void stop();
 
     /**
-     * @brief Submit a command to the engine
+     * @brief Submit a command to the engine. With LaneQueue the command goes to the default producer's lane.
      * @param cmd Command to execute
-     * @return Sequence number assigned to the command
+     * @return Sequence number assigned to the command, or with LaneQueue its position in the default producer's stream
      */
     SeqNum submit(Command cmd);
 
     /**
-     * @brief Get a const reference to the internal order book
+     * @brief Submit a run of commands, reserving a contiguous sequence range in one step and
+     * publishing them to the queue in bulk
+     * @param commands Commands to execute, in order
+     * @return Sequence number assigned to the last command, or the last submitted one if the run is empty
+     */
+    SeqNum submitBatch(std::span<const Command> commands);
+
+    /**
+     * @brief Give a new producer thread its own ingress lane (safe from any thread, LaneQueue only).
+     * The engine merges the lanes fairly and assigns sequence numbers as it dequeues, so producers
+     * share no counter and no lock.
+     * @return The id of the producer, to submit with from a single thread
+     */
+    ProducerId registerProducer() requires sequencesOnDequeue<Queue>;
+
+    /**
+     * @brief Submit a command on the lane of a producer (LaneQueue only)
+     * @param producer Id of the producer, only ever submitting from one thread
+     * @param cmd Command to execute
+     * @return Position of the command in the producer's stream, starting at 1
+     */
+    SeqNum submit(ProducerId producer, Command cmd) requires sequencesOnDequeue<Queue>;
+
+    /**
+     * @brief Submit a run of commands on the lane of a producer in bulk (LaneQueue only)
+     * @param producer Id of the producer, only ever submitting from one thread
+     * @param commands Commands to execute, in order
+     * @return Position of the last command in the producer's stream
+     */
+    SeqNum submitBatch(ProducerId producer, std::span<const Command> commands) requires sequencesOnDequeue<Queue>;
+
+    /**
+     * @brief Get a const reference to the order book of a symbol. The book of symbol 0 exists from the start
+     * unless the engine was built without it, other books are created by the first ADD for their symbol.
+     * @param symbol Symbol id of the book
      * @return Reference to the order book
      */
-    const OrderBook& getBook() const;
+    const Book& getBook(SymbolId symbol = 0) const;
+
+    /**
+     * @brief Check if the engine holds a book for a symbol
+     * @param symbol Symbol id of the book
+     * @return True if the book exists
+     */
+    bool hasBook(SymbolId symbol) const;
+
+    /**
+     * @brief Keep a view of every book that other threads can read while the engine runs. Views are
+     * published after each match pass in batch matching mode, when the books are uncrossed, and after
+     * each dequeued batch in continuous mode. Must be called before start().
+     * @param depth Number of levels per side in the depth image of each view
+     */
+    void enableBookViews(std::size_t depth = 10);
+
+    /**
+     * @brief Get the view of the book of a symbol (safe from any thread, unlike getBook while running)
+     * @param symbol Symbol id of the book
+     * @return Reference to the view, valid for the lifetime of the engine
+     */
+    const BookView& getBookView(SymbolId symbol = 0) const;
+
+    /**
+     * @brief Stream every fill into a ring drained by a consumer thread. Must be called before start().
+     * @param ring Ring receiving the execution reports of every book, each stamped with its book's symbol, or nullptr to disable the stream
+     */
+    void setExecutionReportRing(ExecutionReportRing* ring);
+
+    /**
+     * @brief Publish the order, trade and level events of every book to a shared-memory ring. Must be called before start().
+     * @param publisher Ring writer stamping each event with its book's symbol, or nullptr to disable publishing
+     */
+    void setMarketDataPublisher(MarketDataPublisher* publisher);
 
     /**
      * @brief Get the sequence number of the last processed command
@@ -83,9 +270,90 @@ public:
     SeqNum lastProcessed() const;
 
     /**
-     * @brief Set a custom error handler for failed commands
+     * @brief Get the position of the last processed command of a producer (LaneQueue only)
+     * @param producer Id of the producer
+     * @return Position in the producer's stream, comparable with what submit returned to it
+     */
+    SeqNum lastProcessed(ProducerId producer) const requires sequencesOnDequeue<Queue>;
+
+    /**
+     * @brief Get the sequence number of the last submitted command. With LaneQueue, numbers are assigned
+     * on dequeue and this is the last dequeued command.
+     * @return Last assigned sequence number
+     */
+    SeqNum lastSubmitted() const;
+
+    /**
+     * @brief Get the batch sizes chosen by the batching policy (safe from any thread)
+     * @return Snapshot of the batch metrics
+     */
+    BatchStats batchStats() const;
+
+    /**
+     * @brief Enable or disable the latency histograms. Must be called before start().
+     * Counters are always maintained.
+     * @param enabled If latencies should be recorded
+     */
+    void enableMetrics(bool enabled);
+
+    /**
+     * @brief Get the latency histograms (safe from any thread)
+     * @return Reference to the histograms
+     */
+    const EngineMetrics& getMetrics() const;
+
+    /**
+     * @brief Get the engine and queue counters and the book counters summed over all symbols (safe from any thread)
+     * @return Snapshot of the counters
+     */
+    EngineCounters getCounters() const;
+
+    /**
+     * @brief Write every command and match pass to a journal before it is applied. Must be called before start().
+     * @param journal Journal receiving the records, or nullptr to disable journaling
+     */
+    void setJournal(Journal* journal);
+
+    /**
+     * @brief Rebuild the books by replaying the attached journal directly on the calling thread,
+     * matching at the recorded match points. Records already reflected by a loaded snapshot are
+     * skipped. Must be called before start(); sequence numbers continue after the last replayed command.
+     * @return Number of replayed commands
+     */
+    std::size_t recover();
+
+    /**
+     * @brief Write the resting state of every book and the last applied sequence number to a binary
+     * snapshot file. Must be called while the engine is stopped.
+     * @param path Path of the snapshot file, replaced atomically if it exists
+     */
+    void saveSnapshot(const std::string& path) const;
+
+    /**
+     * @brief Bulk load a snapshot file through a read-only mapping into a fresh engine. Must be called
+     * before start() and before recover(), which then replays only the journal records after the snapshot.
+     * @param path Path of the snapshot file
+     * @return Sequence number of the last command reflected in the snapshot
+     */
+    SeqNum loadSnapshot(const std::string& path);
+
+    /**
+     * @brief Publish every rejected command as a RejectEvent on a ring drained by a consumer thread.
+     * Must be called before start().
+     * @param ring Ring receiving reject events, or nullptr to disable the channel
+     */
+    void setRejectRing(RejectRing* ring);
+
+    /**
+     * @brief Set a custom error handler for commands that raised an exception. Business rejects are
+     * not exceptions, they are counted and published on the reject ring.
      * @param f Function taking the command and the thrown exception
      */
     void set_error_handler(ErrorHandler f);
 };
 
+using Engine = BasicEngine<OrderBook>;
+using LadderEngine = BasicEngine<LadderOrderBook>;
+using SpscEngine = BasicEngine<OrderBook, SpscRingQueue>;
+using MpscEngine = BasicEngine<OrderBook, MpscRingQueue>;
+using LaneEngine = BasicEngine<OrderBook, LaneQueue>;
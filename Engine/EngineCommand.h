@@ -11,6 +11,7 @@ enum class CommandType {
 };
 
 using SeqNum = uint64_t;
+using SymbolId = std::uint32_t;
 
 /**
  * @brief Represents a command to be sent to the engine
@@ -18,9 +19,13 @@ using SeqNum = uint64_t;
 struct Command {
     CommandType type;
     SeqNum seqNum;
+    SymbolId symbol; // instrument whose book the command targets
 
     IdNumber idNumber;
     Side side;
     Price price;
     Quantity qty;
+    OrderType orderType; // ADD only, LIMIT orders rest while IOC, FOK and MARKET orders are matched on arrival
+
+    std::uint64_t submitTime; // steady clock nanoseconds at submit, 0 unless engine metrics are enabled
 };
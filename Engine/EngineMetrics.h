@@ -0,0 +1,35 @@
+#pragma once
+#include "LatencyHistogram.h"
+#include <chrono>
+
+/**
+ * @brief Latency histograms recorded by the engine thread while metrics are enabled
+ */
+struct EngineMetrics {
+    LatencyHistogram queueDelay; // submit to dequeue
+    LatencyHistogram addTime; // apply of ADD commands
+    LatencyHistogram modifyTime; // apply of MODIFY commands
+    LatencyHistogram cancelTime; // apply of CANCEL commands
+    LatencyHistogram matchTime; // matchOrders pass
+    LatencyHistogram fillsPerMatch; // fills produced by one matchOrders pass
+};
+
+/**
+ * @brief Snapshot of the engine counters
+ */
+struct EngineCounters {
+    std::uint64_t commands; // commands applied, including rejected ones
+    std::uint64_t rejected; // commands rejected with a RejectReason or whose apply threw
+    std::uint64_t levelsCreated;
+    std::uint64_t levelsDestroyed;
+    std::uint64_t trades;
+    std::size_t queueHighWater; // deepest the ingress queue has been, measured at each dequeue
+};
+
+/**
+ * @brief Retrieves the steady clock time used by the engine metrics
+ * @return Nanoseconds since the steady clock epoch
+ */
+inline std::uint64_t metricsNow() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
@@ -0,0 +1,259 @@
+#include "Journal.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::uint64_t JournalRecord::computeChecksum() const {
+    // Hash the field values, which with 32-bit prices and quantities are the bytes of every field before the
+    // checksum. Wider builds mix in the high halves, so the padding those layouts have is never covered.
+    const std::uint64_t words[6] = {
+        seqNum,
+        idNumber,
+        symbol | static_cast<std::uint64_t>(price) << 32,
+        static_cast<std::uint32_t>(qty) | static_cast<std::uint64_t>(recordType) << 32 | static_cast<std::uint64_t>(type) << 40 |
+            static_cast<std::uint64_t>(side) << 48 | static_cast<std::uint64_t>(orderType) << 56,
+        static_cast<std::uint64_t>(price) >> 32,
+        static_cast<std::uint64_t>(qty) >> 32
+    };
+    const std::size_t wordCount = sizeof(WirePrice) + sizeof(WireQuantity) > 8 ? 6 : 4;
+    std::uint64_t hash = 0x9E3779B97F4A7C15;
+    for (std::size_t i = 0; i < wordCount; i++) {
+        hash = (hash ^ words[i]) * 0xFF51AFD7ED558CCD;
+        hash ^= hash >> 32;
+    }
+    return hash;
+}
+
+Command JournalRecord::toCommand() const {
+    Command cmd{};
+    cmd.type = static_cast<CommandType>(type);
+    cmd.seqNum = seqNum;
+    cmd.symbol = symbol;
+    cmd.idNumber = idNumber;
+    cmd.side = static_cast<Side>(side);
+    cmd.price = price;
+    cmd.qty = qty;
+    cmd.orderType = static_cast<OrderType>(orderType);
+    return cmd;
+}
+
+/**
+ * @brief On-disk header in front of the records
+ */
+struct JournalHeader {
+    std::uint64_t magic;
+    std::uint32_t recordSize;
+    std::uint32_t version;
+};
+
+Journal::Journal(const JournalConfig& config):
+    config(config),
+    fd(-1),
+    base(nullptr),
+    capacity(0),
+    records(0),
+    syncedRecords(0),
+    syncCount(0),
+    syncError(0),
+    stopping(false)
+{
+    fd = ::open(config.path.c_str(), O_RDWR | O_CREAT | (config.truncate ? O_TRUNC : 0), 0644);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Journal ('" + config.path + "') cannot be opened");
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) != 0) {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "Journal ('" + config.path + "') cannot be inspected");
+    }
+
+    const auto existing = static_cast<std::size_t>(info.st_size);
+    const std::size_t existingCapacity = existing > HEADER_SIZE ? (existing - HEADER_SIZE) / sizeof(JournalRecord) : 0;
+    map(std::max<std::size_t>({config.capacity, existingCapacity, 1}));
+
+    auto* header = reinterpret_cast<JournalHeader*>(base);
+    if (existing >= HEADER_SIZE) {
+        if (header->magic != MAGIC || header->recordSize != sizeof(JournalRecord)) {
+            unmap();
+            ::close(fd);
+            throw std::runtime_error("Journal ('" + config.path + "') is not a journal of this format");
+        }
+        // Resume appending after the last valid record
+        records.store(replay([](const JournalRecord&) {}), std::memory_order_relaxed);
+        syncedRecords = records.load(std::memory_order_relaxed);
+        discardTail();
+    }
+    else {
+        *header = {MAGIC, sizeof(JournalRecord), 1};
+    }
+
+    if (config.syncPolicy == SyncPolicy::INTERVAL) {
+        syncer = std::thread([this] {
+            std::unique_lock<std::mutex> lock(mapLock);
+            while (!stopping) {
+                syncerWake.wait_for(lock, this->config.syncInterval, [this] { return stopping; });
+                try {
+                    syncLocked(records.load(std::memory_order_acquire));
+                } catch (const std::system_error&) {
+                    return; // kept as the sync error, later syncs cannot make the lost records durable
+                }
+            }
+        });
+    }
+}
+
+Journal::~Journal() {
+    {
+        std::lock_guard<std::mutex> lock(mapLock);
+        stopping = true;
+    }
+    syncerWake.notify_all();
+    if (syncer.joinable()) { syncer.join(); }
+    try {
+        sync();
+    } catch (const std::system_error&) {
+        // Kept as the sync error, a destructor must not throw
+    }
+    unmap();
+    ::close(fd);
+}
+
+void Journal::map(const std::size_t newCapacity) {
+    const std::size_t bytes = HEADER_SIZE + newCapacity * sizeof(JournalRecord);
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        throw std::system_error(errno, std::generic_category(), "Journal ('" + config.path + "') cannot be resized");
+    }
+    int flags = MAP_SHARED;
+#if defined(__linux__)
+    // Reserve the blocks and fault the pages in now so appends never wait on the file system
+    ::posix_fallocate(fd, 0, static_cast<off_t>(bytes));
+    flags |= MAP_POPULATE;
+#endif
+    void* mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, fd, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "Journal ('" + config.path + "') cannot be mapped");
+    }
+    base = static_cast<std::uint8_t*>(mapping);
+    capacity = newCapacity;
+}
+
+void Journal::unmap() {
+    if (base) {
+        ::munmap(base, HEADER_SIZE + capacity * sizeof(JournalRecord));
+        base = nullptr;
+    }
+}
+
+void Journal::grow() {
+    std::lock_guard<std::mutex> lock(mapLock);
+    const std::size_t newCapacity = capacity * 2;
+    unmap();
+    map(newCapacity);
+}
+
+void Journal::discardTail() {
+    // Find the last record that is not all zero bytes, everything from the resume point up to it is stale
+    static const JournalRecord zero{};
+    const std::size_t first = records.load(std::memory_order_relaxed);
+    std::size_t end = capacity;
+    while (end > first && std::memcmp(slot(end - 1), &zero, sizeof(JournalRecord)) == 0) {
+        end--;
+    }
+    if (end == first) { return; }
+
+    std::memset(slot(first), 0, (end - first) * sizeof(JournalRecord));
+    // Make the discard durable before anything is appended, or a crash could bring the stale records back
+    static const auto pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t from = (HEADER_SIZE + first * sizeof(JournalRecord)) & ~(pageSize - 1);
+    const std::size_t to = HEADER_SIZE + end * sizeof(JournalRecord);
+    if (::msync(base + from, to - from, MS_SYNC) != 0) {
+        const int error = errno;
+        unmap();
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "Journal ('" + config.path + "') cannot discard its stale tail");
+    }
+}
+
+JournalRecord* Journal::slot(const std::size_t index) const {
+    return reinterpret_cast<JournalRecord*>(base + HEADER_SIZE) + index;
+}
+
+void Journal::write(JournalRecord record) {
+    const std::size_t index = records.load(std::memory_order_relaxed);
+    if (index == capacity) [[unlikely]] {
+        grow();
+    }
+    record.checksum = record.computeChecksum();
+    *slot(index) = record;
+    records.store(index + 1, std::memory_order_release);
+}
+
+void Journal::append(const Command& cmd) {
+    write({cmd.seqNum, cmd.idNumber, cmd.symbol, cmd.price, cmd.qty, JournalRecordType::COMMAND,
+           static_cast<std::uint8_t>(cmd.type), static_cast<std::uint8_t>(cmd.side), static_cast<std::uint8_t>(cmd.orderType), 0});
+}
+
+void Journal::appendMatch(const SeqNum lastSeqNum) {
+    write({lastSeqNum, 0, 0, 0, 0, JournalRecordType::MATCH, 0, 0, 0, 0});
+}
+
+void Journal::commit() {
+    if (config.syncPolicy != SyncPolicy::PER_BATCH) { return; }
+    std::lock_guard<std::mutex> lock(mapLock);
+    syncLocked(records.load(std::memory_order_relaxed));
+}
+
+void Journal::sync() {
+    std::lock_guard<std::mutex> lock(mapLock);
+    syncLocked(records.load(std::memory_order_acquire));
+}
+
+void Journal::syncLocked(const std::size_t upTo) {
+    if (upTo <= syncedRecords || !base) { return; }
+    // msync needs a page aligned start, so round the first unsynced byte down to its page
+    static const auto pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t first = (HEADER_SIZE + syncedRecords * sizeof(JournalRecord)) & ~(pageSize - 1);
+    const std::size_t last = HEADER_SIZE + upTo * sizeof(JournalRecord);
+    // A failed sync means acknowledged commands may be lost, which the engine cannot recover from
+    if (::msync(base + first, last - first, MS_SYNC) != 0) {
+        const int error = errno;
+        int expected = 0;
+        syncError.compare_exchange_strong(expected, error, std::memory_order_relaxed);
+        throw std::system_error(error, std::generic_category(), "Journal ('" + config.path + "') cannot be synced");
+    }
+    syncedRecords = upTo;
+    syncCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::size_t Journal::replay(const std::function<void(const JournalRecord&)>& onRecord) const {
+    std::size_t index = 0;
+    SeqNum lastSeqNum = 0; // last command, which a match record repeats
+    while (index < capacity) {
+        const JournalRecord& record = *slot(index);
+        if (record.seqNum == 0 || record.checksum != record.computeChecksum()) { break; }
+        // Commands are journaled in sequence, a gap means the record was left over by another session
+        if (lastSeqNum != 0) {
+            const SeqNum expected = record.recordType == JournalRecordType::MATCH ? lastSeqNum : lastSeqNum + 1;
+            if (record.seqNum != expected) { break; }
+        }
+        onRecord(record);
+        if (record.recordType == JournalRecordType::COMMAND) { lastSeqNum = record.seqNum; }
+        index++;
+    }
+    return index;
+}
+
+std::size_t Journal::size() const { return records.load(std::memory_order_acquire); }
+
+std::uint64_t Journal::getSyncCount() const { return syncCount.load(std::memory_order_relaxed); }
+
+std::error_code Journal::getSyncError() const {
+    const int error = syncError.load(std::memory_order_relaxed);
+    return error == 0 ? std::error_code() : std::error_code(error, std::generic_category());
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include "EngineCommand.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+
+/**
+ * @brief When appended journal records are forced to stable storage
+ */
+enum class SyncPolicy {
+    NONE, // never sync explicitly, records survive a process crash but not an OS crash
+    PER_BATCH, // group commit, sync once per batch the engine dequeues before publishing it as processed
+    INTERVAL // a background thread syncs everything appended every syncInterval
+};
+
+/**
+ * @brief Configuration of the write-ahead journal
+ */
+struct JournalConfig {
+    std::string path;
+    std::size_t capacity = 1 << 20; // records preallocated up front, the file doubles when full
+    SyncPolicy syncPolicy = SyncPolicy::NONE;
+    std::chrono::milliseconds syncInterval = std::chrono::milliseconds(5); // INTERVAL period
+    bool truncate = false; // discard existing records instead of appending after them
+};
+
+/**
+ * @brief All kinds of journal records
+ */
+enum class JournalRecordType : std::uint8_t {
+    COMMAND, // a sequenced command, applied or rejected
+    MATCH // the engine ran a batch match pass after the preceding commands
+};
+
+/**
+ * @brief Fixed-size journal record. The checksum covers the other fields, so a record torn by a
+ * crash ends the journal instead of being replayed.
+ */
+struct JournalRecord {
+    SeqNum seqNum; // 0 marks the unused, zero-filled tail of the file
+    IdNumber idNumber;
+    SymbolId symbol;
+    WirePrice price;
+    WireQuantity qty;
+    JournalRecordType recordType;
+    std::uint8_t type; // CommandType
+    std::uint8_t side; // Side
+    std::uint8_t orderType; // OrderType, LIMIT in journals written before order types existed
+    std::uint64_t checksum;
+
+    /**
+     * @brief Computes the checksum of every field but the checksum itself
+     * @return The checksum
+     */
+    std::uint64_t computeChecksum() const;
+
+    /**
+     * @brief Rebuilds the command of a COMMAND record
+     * @return The command with its original sequence number
+     */
+    Command toCommand() const;
+};
+
+static_assert(sizeof(JournalRecord) == 40 || sizeof(WirePrice) + sizeof(WireQuantity) > 8, "journal records must keep a fixed on-disk layout");
+
+/**
+ * @brief Append-only binary journal of sequenced commands in a preallocated, memory-mapped file.
+ * Appends are a copy into the mapping on the engine thread and never enter the kernel; the
+ * sync policy decides when the mapping is flushed to disk.
+ */
+class Journal {
+private:
+    static constexpr std::uint64_t MAGIC = 0x314C4E524A424F4C; // "LOBJRNL1"
+    static constexpr std::size_t HEADER_SIZE = 64;
+
+    JournalConfig config;
+    int fd;
+    std::uint8_t* base; // start of the mapping
+    std::size_t capacity; // records the file can hold
+    std::atomic<std::size_t> records; // records appended, including replayed ones
+    std::size_t syncedRecords; // records known to be on disk
+    std::atomic<std::uint64_t> syncCount;
+    std::atomic<int> syncError; // errno of the first failed sync, 0 while every sync succeeded
+
+    // INTERVAL syncer, also guards the mapping against being remapped while it syncs
+    std::mutex mapLock;
+    std::condition_variable syncerWake;
+    bool stopping;
+    std::thread syncer;
+
+    /**
+     * @brief Maps the file, growing it to a capacity
+     * @param newCapacity Number of records the file must hold
+     */
+    void map(std::size_t newCapacity);
+    /**
+     * @brief Unmaps the file
+     */
+    void unmap();
+    /**
+     * @brief Doubles the capacity of a full journal
+     */
+    void grow();
+    /**
+     * @brief Zeroes and syncs the records an earlier session left after the last valid one,
+     * so records appended from now on are never followed by stale ones
+     */
+    void discardTail();
+    /**
+     * @brief Retrieves a record slot
+     * @param index Index of the record
+     * @return Pointer to the record in the mapping
+     */
+    JournalRecord* slot(std::size_t index) const;
+    /**
+     * @brief Writes a record at the end of the journal
+     * @param record Record to write, without its checksum
+     */
+    void write(JournalRecord record);
+    /**
+     * @brief Flushes the mapping up to a number of records (mapLock held). A failure is kept as the sync error and thrown.
+     * @param upTo Number of records to flush
+     */
+    void syncLocked(std::size_t upTo);
+
+public:
+    /**
+     * @brief Opens or creates a journal file. Existing records are kept unless the config truncates them.
+     * @param config Path, capacity and sync policy
+     */
+    explicit Journal(const JournalConfig& config);
+
+    /**
+     * @brief Syncs all records, stops the syncer and unmaps the file. A failed final sync is kept as the sync error, not thrown.
+     */
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    /**
+     * @brief Appends a sequenced command (engine thread only)
+     * @param cmd Command to append
+     */
+    void append(const Command& cmd);
+
+    /**
+     * @brief Appends a match pass marker so replay matches at the same points (engine thread only)
+     * @param lastSeqNum Sequence number of the last command before the pass
+     */
+    void appendMatch(SeqNum lastSeqNum);
+
+    /**
+     * @brief Group commit point the engine calls after every dequeued batch. Syncs under the PER_BATCH policy.
+     * Throws std::system_error if the sync fails.
+     */
+    void commit();
+
+    /**
+     * @brief Forces every appended record to disk. Throws std::system_error if the sync fails.
+     */
+    void sync();
+
+    /**
+     * @brief Visits every valid record in order, stopping at the unused tail, a torn record or a gap in the sequence numbers
+     * @param onRecord Function called with each record
+     * @return Number of records visited
+     */
+    std::size_t replay(const std::function<void(const JournalRecord&)>& onRecord) const;
+
+    /**
+     * @brief Retrieves the number of records in the journal
+     * @return The number of records
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Retrieves the number of explicit syncs performed
+     * @return The number of syncs
+     */
+    std::uint64_t getSyncCount() const;
+
+    /**
+     * @brief Retrieves the first sync failure, which is sticky: records appended before it may not be on disk
+     * @return The error of the failed sync, or an empty error code if every sync succeeded
+     */
+    std::error_code getSyncError() const;
+};
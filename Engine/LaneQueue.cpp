@@ -0,0 +1,133 @@
+#include "LaneQueue.h"
+#include <algorithm>
+#include <stdexcept>
+
+LaneQueue::LaneQueue(size_t capacity):
+    capacity(capacity),
+    laneCount(0),
+    stopped(false),
+    waitStrategy(WaitStrategy::SPIN_YIELD),
+    nextLane(0)
+{
+    poppedLanes.reserve(MAX_LANES);
+    registerProducer(); // DEFAULT_PRODUCER
+}
+
+void LaneQueue::setWaitStrategy(const WaitStrategy strategy) {
+    waitStrategy = strategy;
+}
+
+ProducerId LaneQueue::registerProducer() {
+    std::lock_guard<std::mutex> lock(registration);
+    const std::size_t index = laneCount.load(std::memory_order_relaxed);
+    if (index == MAX_LANES) {
+        throw std::length_error("Every ingress lane is taken");
+    }
+    lanes[index] = std::make_unique<Lane>(capacity);
+    laneCount.store(index + 1, std::memory_order_release); // the consumer only reads lanes below the count
+    return static_cast<ProducerId>(index);
+}
+
+std::uint64_t LaneQueue::push(const ProducerId producer, const Command& command) {
+    Lane& lane = *lanes[producer];
+    Backoff backoff;
+    while (!lane.ring.tryPush(command)) {
+        if (stopped.load(std::memory_order_relaxed)) { return lane.submitted; }
+        backoff.pause();
+    }
+    if (waitStrategy == WaitStrategy::SPIN_PARK) { consumerParking.wake(); }
+    return ++lane.submitted;
+}
+
+std::uint64_t LaneQueue::pushBulk(const ProducerId producer, const Command* commands, const std::size_t count) {
+    Lane& lane = *lanes[producer];
+    Backoff backoff;
+    for (std::size_t i = 0; i < count;) {
+        if (!lane.ring.tryPush(commands[i])) {
+            if (stopped.load(std::memory_order_relaxed)) { break; }
+            if (waitStrategy == WaitStrategy::SPIN_PARK) { consumerParking.wake(); }
+            backoff.pause();
+            continue;
+        }
+        lane.submitted++;
+        i++;
+        backoff.reset();
+    }
+    if (waitStrategy == WaitStrategy::SPIN_PARK) { consumerParking.wake(); }
+    return lane.submitted;
+}
+
+bool LaneQueue::anyReady(const std::size_t lanesNow) const {
+    for (std::size_t i = 0; i < lanesNow; i++) {
+        if (!lanes[i]->ring.isEmpty()) { return true; }
+    }
+    return false;
+}
+
+std::size_t LaneQueue::popBulk(Command* out, const std::size_t maxCommands) {
+    Backoff backoff(waitStrategy);
+    while (true) {
+        const std::size_t lanesNow = laneCount.load(std::memory_order_acquire);
+        const std::size_t share = std::max<std::size_t>(maxCommands / lanesNow, 1);
+        std::size_t n = 0;
+
+        // Rounds over the lanes until the buffer is full or a whole round finds nothing
+        for (bool progress = true; progress && n < maxCommands;) {
+            progress = false;
+            for (std::size_t k = 0; k < lanesNow && n < maxCommands; k++) {
+                const std::size_t index = (nextLane + k) % lanesNow;
+                Lane& lane = *lanes[index];
+                const std::size_t taken = lane.ring.popBulk(out + n, std::min(share, maxCommands - n));
+                if (taken == 0) { continue; }
+                if (lane.popped == lane.applied.load(std::memory_order_relaxed)) {
+                    poppedLanes.push_back(index); // first pop since the last report
+                }
+                lane.popped += taken;
+                n += taken;
+                progress = true;
+            }
+        }
+        nextLane = (nextLane + 1) % lanesNow;
+        if (n > 0) { return n; }
+
+        if (stopped.load(std::memory_order_acquire)) {
+            if (!anyReady(laneCount.load(std::memory_order_acquire))) { return 0; }
+            continue;
+        }
+        if (backoff.pause()) {
+            consumerParking.park([&] {
+                return anyReady(laneCount.load(std::memory_order_acquire)) || stopped.load(std::memory_order_acquire);
+            });
+        }
+    }
+}
+
+void LaneQueue::markApplied() {
+    for (const std::size_t index : poppedLanes) {
+        Lane& lane = *lanes[index];
+        lane.applied.store(lane.popped, std::memory_order_release);
+    }
+    poppedLanes.clear();
+}
+
+std::uint64_t LaneQueue::applied(const ProducerId producer) const {
+    return lanes[producer]->applied.load(std::memory_order_acquire);
+}
+
+bool LaneQueue::isEmpty() const {
+    return !anyReady(laneCount.load(std::memory_order_acquire));
+}
+
+std::size_t LaneQueue::size() const {
+    const std::size_t lanesNow = laneCount.load(std::memory_order_acquire);
+    std::size_t queued = 0;
+    for (std::size_t i = 0; i < lanesNow; i++) {
+        queued += lanes[i]->ring.size();
+    }
+    return queued;
+}
+
+void LaneQueue::stop() {
+    stopped.store(true, std::memory_order_release);
+    consumerParking.wake();
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include "EngineCommand.h"
+#include "Backoff.h"
+#include "SpscRing.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using ProducerId = std::uint32_t;
+
+/**
+ * @brief Represents a multi-producer ingress where every registered producer owns a lock-free SPSC lane,
+ * so producers never write to a shared line. The consumer merges the lanes round robin, which keeps the
+ * order of each producer's commands and stops a busy producer from starving the others. Commands are not
+ * sequenced by the producers: the engine stamps the global sequence number when it dequeues them.
+ */
+class LaneQueue {
+private:
+    static constexpr std::size_t CACHE_LINE = 64;
+    static constexpr std::size_t MAX_LANES = 64;
+
+    /**
+     * @brief The ring of one producer and the progress the consumer reports back to it
+     */
+    struct Lane {
+        SpscRing<Command> ring;
+        std::uint64_t submitted = 0; // producer-owned, commands pushed
+        alignas(CACHE_LINE) std::atomic<std::uint64_t> applied{0}; // commands the engine has applied
+        std::uint64_t popped = 0; // consumer-owned, commands dequeued
+
+        explicit Lane(const std::size_t capacity): ring(capacity) {}
+    };
+
+    std::size_t capacity; // per lane
+    std::unique_ptr<Lane> lanes[MAX_LANES];
+    alignas(CACHE_LINE) std::atomic<std::size_t> laneCount; // lanes registered, read by the consumer on every pop
+    std::mutex registration;
+    alignas(CACHE_LINE) ParkingSpot consumerParking; // polled by producers after every publish
+    alignas(CACHE_LINE) std::atomic<bool> stopped;
+    WaitStrategy waitStrategy; // how the consumer waits while every lane is empty
+    std::size_t nextLane; // consumer-owned, lane the next merge starts from
+    std::vector<std::size_t> poppedLanes; // consumer-owned, lanes popped since the last markApplied
+
+    /**
+     * @brief Checks if any lane has a command (consumer only)
+     * @param lanesNow Number of registered lanes
+     * @return if a command is waiting
+     */
+    bool anyReady(std::size_t lanesNow) const;
+
+public:
+    static constexpr ProducerId DEFAULT_PRODUCER = 0; // the lane of push without a producer, registered at construction
+
+    /**
+     * @brief Construct the queue with its default lane
+     * @param capacity Maximum number of commands waiting in each lane, rounded up to a power of two
+     */
+    explicit LaneQueue(size_t capacity);
+
+    /**
+     * @brief Choose how the consumer waits while every lane is empty (SPIN_YIELD by default). Must be called before the queue is used.
+     * @param strategy The wait strategy
+     */
+    void setWaitStrategy(WaitStrategy strategy);
+
+    /**
+     * @brief Give a new producer its own lane (safe from any thread). Throws std::length_error once
+     * every lane is taken.
+     * @return The id of the producer, to push with from a single thread
+     */
+    ProducerId registerProducer();
+
+    /**
+     * @brief Enqueue a command on the lane of a producer (spinning if the lane is full)
+     * @param producer Id of the producer, only ever pushing from one thread
+     * @param command Command to insert
+     * @return Position of the command in the producer's stream, starting at 1
+     */
+    std::uint64_t push(ProducerId producer, const Command& command);
+
+    /**
+     * @brief Enqueue a run of commands on the lane of a producer (spinning while the lane is full)
+     * @param producer Id of the producer, only ever pushing from one thread
+     * @param commands Commands to insert
+     * @param count Number of commands
+     * @return Position of the last command in the producer's stream
+     */
+    std::uint64_t pushBulk(ProducerId producer, const Command* commands, std::size_t count);
+
+    /**
+     * @brief Enqueue a command on the default lane, so a single submitting thread needs no registration
+     * @param command Command to insert
+     */
+    void push(const Command& command) { push(DEFAULT_PRODUCER, command); }
+
+    /**
+     * @brief Enqueue a run of commands on the default lane
+     * @param commands Commands to insert
+     * @param count Number of commands
+     */
+    void pushBulk(const Command* commands, const std::size_t count) { pushBulk(DEFAULT_PRODUCER, commands, count); }
+
+    /**
+     * @brief Dequeue up to a limit of commands from all lanes in one step (blocking if every lane is empty).
+     * Each non-empty lane gives up to an equal share of the limit per round, starting one lane further every call.
+     * @param out Buffer receiving the dequeued commands
+     * @param maxCommands Maximum number of commands to dequeue
+     * @return Number of commands dequeued, 0 once the queue is stopped and drained
+     */
+    std::size_t popBulk(Command* out, std::size_t maxCommands);
+
+    /**
+     * @brief Report every command dequeued so far as applied to its producer (consumer only)
+     */
+    void markApplied();
+
+    /**
+     * @brief Retrieves how many commands a producer has pushed (that producer's thread only)
+     * @param producer Id of the producer
+     * @return Position of the producer's last pushed command
+     */
+    std::uint64_t submitted(const ProducerId producer) const { return lanes[producer]->submitted; }
+
+    /**
+     * @brief Retrieves how many commands of a producer have been applied (safe from any thread)
+     * @param producer Id of the producer
+     * @return Position of the producer's last applied command
+     */
+    std::uint64_t applied(ProducerId producer) const;
+
+    /**
+     * @brief Evaluates if every lane is empty
+     * @return if the queue is empty
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Retrieves the number of commands waiting in all lanes
+     * @return The approximate number of queued commands
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Stop the queue and release all spinning or parked threads
+     */
+    void stop();
+};
+
+/**
+ * @brief If a queue leaves the sequence numbers to the consumer, which stamps them on dequeue
+ */
+template<typename Queue>
+inline constexpr bool sequencesOnDequeue = false;
+
+template<>
+inline constexpr bool sequencesOnDequeue<LaneQueue> = true;
@@ -0,0 +1,60 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <bit>
+
+LatencyHistogram::LatencyHistogram():
+    total(0),
+    maxValue(0)
+{
+    for (auto& c : counts) {
+        c.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::size_t LatencyHistogram::bucketOf(std::uint64_t value) {
+    if (value < SUB_COUNT) { return static_cast<std::size_t>(value); }
+    value = std::min(value, (std::uint64_t{1} << MAX_BITS) - 1);
+    const int msb = 63 - std::countl_zero(value);
+    const int shift = msb - SUB_BITS;
+    return static_cast<std::size_t>((shift + 1) * SUB_COUNT + ((value >> shift) - SUB_COUNT));
+}
+
+std::uint64_t LatencyHistogram::upperBoundOf(const std::size_t bucket) {
+    if (bucket < SUB_COUNT) { return bucket; }
+    const int shift = static_cast<int>(bucket / SUB_COUNT) - 1;
+    const std::uint64_t sub = SUB_COUNT + bucket % SUB_COUNT;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(const std::uint64_t value) {
+    // Single writer, so plain load/store pairs are enough and avoid locked instructions
+    auto& bucket = counts[bucketOf(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    total.store(total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (value > maxValue.load(std::memory_order_relaxed)) {
+        maxValue.store(value, std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t LatencyHistogram::percentile(const double percentile) const {
+    const std::uint64_t n = total.load(std::memory_order_relaxed);
+    if (n == 0) { return 0; }
+
+    const auto rank = static_cast<std::uint64_t>(std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(n));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKETS; i++) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if (seen > rank || seen == n) {
+            return std::min(upperBoundOf(i), max());
+        }
+    }
+    return max();
+}
+
+std::uint64_t LatencyHistogram::count() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::max() const {
+    return maxValue.load(std::memory_order_relaxed);
+}
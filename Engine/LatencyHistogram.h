@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Log-linear (HDR-style) histogram of nanosecond values with about 3% relative precision.
+ * Recording is O(1) with no allocation. It has a single writer; any thread may read it without locks.
+ */
+class LatencyHistogram {
+private:
+    static constexpr int SUB_BITS = 5;
+    static constexpr std::uint64_t SUB_COUNT = std::uint64_t{1} << SUB_BITS; // linear sub-buckets per power of two
+    static constexpr int MAX_BITS = 48; // values are clamped below 2^48 ns (about 3 days)
+    static constexpr std::size_t BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+    std::array<std::atomic<std::uint64_t>, BUCKETS> counts;
+    std::atomic<std::uint64_t> total;
+    std::atomic<std::uint64_t> maxValue;
+
+    /**
+     * @brief Retrieves the bucket of a value
+     * @param value The recorded value
+     * @return The bucket index
+     */
+    static std::size_t bucketOf(std::uint64_t value);
+
+    /**
+     * @brief Retrieves the highest value that falls in a bucket
+     * @param bucket The bucket index
+     * @return The upper bound of the bucket
+     */
+    static std::uint64_t upperBoundOf(std::size_t bucket);
+
+public:
+    /**
+     * @brief Construct an empty histogram
+     */
+    LatencyHistogram();
+
+    /**
+     * @brief Record a value (writer thread only)
+     * @param value The value in nanoseconds
+     */
+    void record(std::uint64_t value);
+
+    /**
+     * @brief Retrieves the value at a percentile
+     * @param percentile The percentile between 0 and 100
+     * @return The upper bound of the bucket holding the percentile, or 0 if empty
+     */
+    std::uint64_t percentile(double percentile) const;
+
+    /**
+     * @brief Retrieves the number of recorded values
+     * @return The number of values
+     */
+    std::uint64_t count() const;
+
+    /**
+     * @brief Retrieves the largest recorded value
+     * @return The exact maximum
+     */
+    std::uint64_t max() const;
+};
@@ -0,0 +1,106 @@
+#include "MappedFile.h"
+#include <cerrno>
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path, const std::size_t bytes):
+    fd(-1),
+    base(nullptr),
+    bytes(bytes),
+    path(path)
+{
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "File ('" + path + "') cannot be created");
+    }
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "File ('" + path + "') cannot be resized");
+    }
+    if (bytes == 0) { return; }
+#if defined(__linux__)
+    // A write to a sparse mapping that finds the disk full is a SIGBUS, so allocate the blocks now
+    if (const int error = ::posix_fallocate(fd, 0, static_cast<off_t>(bytes)); error != 0) {
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "File ('" + path + "') cannot be allocated");
+    }
+#endif
+    void* mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "File ('" + path + "') cannot be mapped");
+    }
+    base = static_cast<std::uint8_t*>(mapping);
+}
+
+MappedFile::MappedFile(const std::string& path, const MapSharing sharing):
+    fd(-1),
+    base(nullptr),
+    bytes(0),
+    path(path)
+{
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "File ('" + path + "') cannot be opened");
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) != 0) {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "File ('" + path + "') cannot be inspected");
+    }
+    bytes = static_cast<std::size_t>(info.st_size);
+    if (bytes == 0) { return; }
+    int flags = (sharing == MapSharing::SHARED) ? MAP_SHARED : MAP_PRIVATE;
+#if defined(__linux__)
+    flags |= MAP_POPULATE; // one sequential read instead of a page fault per page
+#endif
+    void* mapping = ::mmap(nullptr, bytes, PROT_READ, flags, fd, 0);
+    if (mapping == MAP_FAILED) {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "File ('" + path + "') cannot be mapped");
+    }
+    base = static_cast<std::uint8_t*>(mapping);
+}
+
+MappedFile::~MappedFile() {
+    if (base) { ::munmap(base, bytes); }
+    if (fd >= 0) { ::close(fd); }
+}
+
+std::uint8_t* MappedFile::data() const { return base; }
+
+std::size_t MappedFile::size() const { return bytes; }
+
+void MappedFile::sync() {
+    if (base && ::msync(base, bytes, MS_SYNC) != 0) {
+        throw std::system_error(errno, std::generic_category(), "File ('" + path + "') cannot be synced");
+    }
+}
+
+void replaceFile(const std::string& from, const std::string& to) {
+    if (std::rename(from.c_str(), to.c_str()) != 0) {
+        throw std::system_error(errno, std::generic_category(), "File ('" + from + "') cannot replace ('" + to + "')");
+    }
+    // The rename is only durable once the directory entry is on disk
+    const std::filesystem::path parent = std::filesystem::path(to).parent_path();
+    const std::string directory = parent.empty() ? "." : parent.string();
+    const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Directory ('" + directory + "') cannot be opened");
+    }
+    const int result = ::fsync(fd);
+    const int error = errno;
+    ::close(fd);
+    if (result != 0) {
+        throw std::system_error(error, std::generic_category(), "Directory ('" + directory + "') cannot be synced");
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief How a file opened read-only is mapped
+ */
+enum class MapSharing {
+    PRIVATE, // a copy of the file as it is now, faulted in up front (snapshots)
+    SHARED // a live view that sees later writes of other processes to the same file (shared-memory rings)
+};
+
+/**
+ * @brief A whole file mapped into memory, either created writable with a fixed size or opened read-only
+ */
+class MappedFile {
+private:
+    int fd;
+    std::uint8_t* base;
+    std::size_t bytes;
+    std::string path;
+
+public:
+    /**
+     * @brief Creates or truncates a file and maps it writable, reserving its blocks so a full disk fails here
+     * instead of on a write to the mapping
+     * @param path Path of the file
+     * @param bytes Size of the file
+     */
+    MappedFile(const std::string& path, std::size_t bytes);
+
+    /**
+     * @brief Maps an existing file read-only
+     * @param path Path of the file
+     * @param sharing PRIVATE to fault the pages in up front, SHARED to see later writes to the file
+     */
+    explicit MappedFile(const std::string& path, MapSharing sharing = MapSharing::PRIVATE);
+
+    /**
+     * @brief Unmaps and closes the file
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Retrieves the start of the mapping
+     * @return Pointer to the first byte
+     */
+    std::uint8_t* data() const;
+
+    /**
+     * @brief Retrieves the size of the mapping
+     * @return Number of bytes
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Forces the mapping to disk
+     */
+    void sync();
+};
+
+/**
+ * @brief Atomically replaces a file with another, fully written and synced one, then syncs the directory
+ * so the rename survives a crash. Readers see either the old or the new file, never a partial one.
+ * @param from Path of the new file, usually next to the target
+ * @param to Path of the file to replace
+ */
+void replaceFile(const std::string& from, const std::string& to);
@@ -0,0 +1,87 @@
+#include "MarketDataRing.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+static constexpr std::size_t SLOTS_OFFSET = 128; // the header and its published line
+
+MarketDataPublisher::MarketDataPublisher(const std::string& path, const std::size_t capacity):
+    file(path, SLOTS_OFFSET + std::bit_ceil(std::max<std::size_t>(capacity, 2)) * sizeof(MarketDataSlot)),
+    header(nullptr),
+    slots(nullptr),
+    mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+    lastSeq(0)
+{
+    static_assert(sizeof(MarketDataRingHeader) <= SLOTS_OFFSET, "the ring header must fit in front of the slots");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "the ring needs address-free atomics to be shared between processes");
+    // The new file is zero-filled, so every slot starts out empty
+    header = new (file.data()) MarketDataRingHeader{MAGIC, 1, sizeof(MarketDataSlot), mask + 1, {}};
+    header->published.store(0, std::memory_order_release);
+    slots = reinterpret_cast<MarketDataSlot*>(file.data() + SLOTS_OFFSET);
+}
+
+void MarketDataPublisher::publish(BookEvent event) {
+    event.seq = ++lastSeq;
+    MarketDataSlot& slot = slots[(lastSeq - 1) & mask];
+    // Invalidate the slot before overwriting it so a lapped reader cannot accept a half-written event
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.event, &event, sizeof(event));
+    slot.seq.store(lastSeq, std::memory_order_release);
+    header->published.store(lastSeq, std::memory_order_release);
+}
+
+std::uint64_t MarketDataPublisher::getPublished() const { return lastSeq; }
+
+std::size_t MarketDataPublisher::getCapacity() const { return mask + 1; }
+
+MarketDataSubscriber::MarketDataSubscriber(const std::string& path):
+    file(path, MapSharing::SHARED),
+    header(reinterpret_cast<const MarketDataRingHeader*>(file.data())),
+    slots(reinterpret_cast<const MarketDataSlot*>(file.data() + SLOTS_OFFSET)),
+    capacity(0),
+    nextSeq(0),
+    lostEvents(0)
+{
+    if (file.size() < SLOTS_OFFSET || header->magic != MarketDataPublisher::MAGIC || header->slotSize != sizeof(MarketDataSlot) ||
+        file.size() < SLOTS_OFFSET + header->capacity * sizeof(MarketDataSlot)) {
+        throw std::runtime_error("File ('" + path + "') is not a market data ring of this format");
+    }
+    capacity = header->capacity;
+    nextSeq = header->published.load(std::memory_order_acquire) + 1;
+}
+
+void MarketDataSubscriber::skipToOldest() {
+    const std::uint64_t published = header->published.load(std::memory_order_acquire);
+    // The event at the cursor is gone even if the writer has not published its replacement yet
+    const std::uint64_t oldest = std::max(published >= capacity ? published - capacity + 1 : 1, nextSeq + 1);
+    lostEvents += oldest - nextSeq;
+    nextSeq = oldest;
+}
+
+ReadResult MarketDataSubscriber::tryRead(BookEvent& out) {
+    const std::uint64_t published = header->published.load(std::memory_order_acquire);
+    if (nextSeq > published) { return ReadResult::EMPTY; }
+    if (published - nextSeq >= capacity) {
+        skipToOldest();
+        return ReadResult::OVERRUN;
+    }
+
+    const MarketDataSlot& slot = slots[(nextSeq - 1) & (capacity - 1)];
+    if (slot.seq.load(std::memory_order_acquire) != nextSeq) {
+        skipToOldest(); // the writer already reused the slot
+        return ReadResult::OVERRUN;
+    }
+    std::memcpy(&out, &slot.event, sizeof(out));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != nextSeq) {
+        skipToOldest(); // the slot was overwritten while it was copied
+        return ReadResult::OVERRUN;
+    }
+    nextSeq++;
+    return ReadResult::EVENT;
+}
+
+std::uint64_t MarketDataSubscriber::getLostEvents() const { return lostEvents; }
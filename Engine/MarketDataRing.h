@@ -0,0 +1,119 @@
+#pragma once
+#include "MappedFile.h"
+#include "Order_Book/BookEvent.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Shared-memory header in front of the slots of a market data ring
+ */
+struct MarketDataRingHeader {
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t slotSize;
+    std::uint64_t capacity; // power of two
+    alignas(64) std::atomic<std::uint64_t> published; // sequence number of the last published event, on its own line
+};
+
+/**
+ * @brief One cache line of the ring. The slot sequence number doubles as a seqlock: it is 0 while
+ * the writer is copying the event in, and the event's sequence number once the copy is complete.
+ */
+struct alignas(64) MarketDataSlot {
+    std::atomic<std::uint64_t> seq;
+    BookEvent event;
+};
+
+/**
+ * @brief All outcomes of reading the market data ring
+ */
+enum class ReadResult {
+    EVENT, // the next event was read
+    EMPTY, // the reader is caught up with the writer
+    OVERRUN // the writer lapped the reader, which skipped to the oldest event still in the ring
+};
+
+/**
+ * @brief Writer of a single-writer, many-reader broadcast ring of book events in a shared memory file
+ * (for example under /dev/shm). The writer never waits for readers: it overwrites the oldest slot, and a
+ * reader that falls a whole ring behind detects it from the sequence numbers instead of reading torn events.
+ */
+class MarketDataPublisher {
+private:
+    static constexpr std::uint64_t MAGIC = 0x31544144444D424F; // "OBMDDAT1"
+
+    MappedFile file;
+    MarketDataRingHeader* header;
+    MarketDataSlot* slots;
+    std::uint64_t mask;
+    std::uint64_t lastSeq; // sequence number of the last published event
+
+    friend class MarketDataSubscriber;
+
+public:
+    /**
+     * @brief Creates or truncates the ring file and maps it
+     * @param path Path of the shared memory file
+     * @param capacity Number of events the ring holds, rounded up to a power of two
+     */
+    MarketDataPublisher(const std::string& path, std::size_t capacity);
+
+    /**
+     * @brief Stamps the next sequence number on an event and writes it over the oldest slot (matching thread only)
+     * @param event Event to publish
+     */
+    void publish(BookEvent event);
+
+    /**
+     * @brief Retrieves the number of events published
+     * @return The sequence number of the last published event
+     */
+    std::uint64_t getPublished() const;
+
+    /**
+     * @brief Retrieves the number of events the ring holds
+     * @return The capacity
+     */
+    std::size_t getCapacity() const;
+};
+
+/**
+ * @brief Reader of a market data ring, typically in another process. Each subscriber keeps its own
+ * cursor, so any number of them can read the same ring without coordinating with each other or the writer.
+ */
+class MarketDataSubscriber {
+private:
+    MappedFile file;
+    const MarketDataRingHeader* header;
+    const MarketDataSlot* slots;
+    std::uint64_t capacity;
+    std::uint64_t nextSeq; // sequence number of the next event to read
+    std::uint64_t lostEvents;
+
+    /**
+     * @brief Moves the cursor to the oldest event still in the ring after an overrun
+     */
+    void skipToOldest();
+
+public:
+    /**
+     * @brief Maps an existing ring read-only and starts reading at the next event published.
+     * Throws std::runtime_error if the file is not a market data ring.
+     * @param path Path of the shared memory file
+     */
+    explicit MarketDataSubscriber(const std::string& path);
+
+    /**
+     * @brief Reads the next event if there is one
+     * @param out Receives the event
+     * @return EVENT if out was filled, EMPTY if there is nothing new, OVERRUN if events were lost
+     */
+    ReadResult tryRead(BookEvent& out);
+
+    /**
+     * @brief Retrieves the number of events skipped because of overruns
+     * @return The number of lost events
+     */
+    std::uint64_t getLostEvents() const;
+};
@@ -0,0 +1,147 @@
+#include "MpscRingQueue.h"
+#include "Backoff.h"
+#include <bit>
+
+MpscRingQueue::MpscRingQueue(size_t capacity):
+    tail(0),
+    head(0),
+    stopped(false),
+    waitStrategy(WaitStrategy::SPIN_YIELD),
+    capacity(std::bit_ceil(capacity < 2 ? size_t{2} : capacity)),
+    mask(this->capacity - 1),
+    slots(std::make_unique<Slot[]>(this->capacity))
+{
+    for (std::size_t i = 0; i < this->capacity; i++) {
+        slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+void MpscRingQueue::setWaitStrategy(const WaitStrategy strategy) {
+    waitStrategy = strategy;
+}
+
+void MpscRingQueue::push(const Command& command) {
+    std::size_t pos = tail.load(std::memory_order_relaxed);
+    Backoff backoff;
+    while (true) {
+        Slot& slot = slots[pos & mask];
+        const std::size_t seq = slot.seq.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            // Slot is free for this lap, try to claim it
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.command = command;
+                slot.seq.store(pos + 1, std::memory_order_release);
+                if (waitStrategy == WaitStrategy::SPIN_PARK) { consumerParking.wake(); }
+                return;
+            }
+        }
+        else if (diff < 0) {
+            // Queue is full, wait for the consumer to free the slot
+            if (stopped.load(std::memory_order_relaxed)) { return; }
+            backoff.pause();
+            pos = tail.load(std::memory_order_relaxed);
+        }
+        else {
+            // Another producer claimed this slot first
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void MpscRingQueue::pushBulk(const Command* commands, std::size_t count) {
+    std::size_t pos = tail.load(std::memory_order_relaxed);
+    Backoff backoff;
+    while (count > 0) {
+        const std::size_t n = count < capacity ? count : capacity;
+        // The consumer frees slots in order, so the whole run is free once its last slot is
+        const Slot& last = slots[(pos + n - 1) & mask];
+        const std::size_t seq = last.seq.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + n - 1);
+        if (diff == 0) {
+            // Claim the whole run with a single CAS
+            if (tail.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) {
+                for (std::size_t i = 0; i < n; i++) {
+                    Slot& slot = slots[(pos + i) & mask];
+                    slot.command = commands[i];
+                    slot.seq.store(pos + i + 1, std::memory_order_release);
+                }
+                if (waitStrategy == WaitStrategy::SPIN_PARK) { consumerParking.wake(); }
+                pos += n;
+                commands += n;
+                count -= n;
+                backoff.reset();
+            }
+        }
+        else if (diff < 0) {
+            // Not enough free slots, wait for the consumer
+            if (stopped.load(std::memory_order_relaxed)) { return; }
+            backoff.pause();
+            pos = tail.load(std::memory_order_relaxed);
+        }
+        else {
+            // Another producer claimed part of the run first
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool MpscRingQueue::pop(Command& out) {
+    const std::size_t pos = head.load(std::memory_order_relaxed);
+    Slot& slot = slots[pos & mask];
+    Backoff backoff(waitStrategy);
+    while (slot.seq.load(std::memory_order_acquire) != pos + 1) {
+        if (stopped.load(std::memory_order_acquire) && slot.seq.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+        if (backoff.pause()) { waitForWork(pos); }
+    }
+    out = slot.command;
+    slot.seq.store(pos + capacity, std::memory_order_release); // free the slot for the next lap
+    head.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+std::size_t MpscRingQueue::popBulk(Command* out, const std::size_t maxCommands) {
+    const std::size_t pos = head.load(std::memory_order_relaxed);
+    Backoff backoff(waitStrategy);
+    while (slots[pos & mask].seq.load(std::memory_order_acquire) != pos + 1) {
+        if (stopped.load(std::memory_order_acquire) && slots[pos & mask].seq.load(std::memory_order_acquire) != pos + 1) {
+            return 0;
+        }
+        if (backoff.pause()) { waitForWork(pos); }
+    }
+    // Take every consecutive published slot, stopping at the first one still being written
+    std::size_t n = 0;
+    while (n < maxCommands) {
+        Slot& slot = slots[(pos + n) & mask];
+        if (slot.seq.load(std::memory_order_acquire) != pos + n + 1) { break; }
+        out[n] = slot.command;
+        slot.seq.store(pos + n + capacity, std::memory_order_release);
+        n++;
+    }
+    head.store(pos + n, std::memory_order_relaxed);
+    return n;
+}
+
+bool MpscRingQueue::isEmpty() const {
+    const std::size_t pos = head.load(std::memory_order_relaxed);
+    return slots[pos & mask].seq.load(std::memory_order_acquire) != pos + 1;
+}
+
+std::size_t MpscRingQueue::size() const {
+    const std::size_t h = head.load(std::memory_order_relaxed);
+    const std::size_t t = tail.load(std::memory_order_acquire);
+    return t > h ? t - h : 0;
+}
+
+void MpscRingQueue::waitForWork(const std::size_t pos) {
+    consumerParking.park([&] {
+        return slots[pos & mask].seq.load(std::memory_order_acquire) == pos + 1 || stopped.load(std::memory_order_acquire);
+    });
+}
+
+void MpscRingQueue::stop() {
+    stopped.store(true, std::memory_order_release);
+    consumerParking.wake();
+}
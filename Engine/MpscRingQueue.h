@@ -0,0 +1,97 @@
+#pragma once
+#include "EngineCommand.h"
+#include "Backoff.h"
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief Represents a lock-free bounded MPSC ring buffer for engine commands.
+ * Producers claim slots with a CAS on the tail and publish them through a per-slot
+ * sequence number, so any number of threads may push while one thread pops.
+ */
+class MpscRingQueue {
+private:
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    /**
+     * @brief A command slot tagged with the ring position it is ready for
+     */
+    struct Slot {
+        std::atomic<std::size_t> seq;
+        Command command;
+    };
+
+    alignas(CACHE_LINE) std::atomic<std::size_t> tail; // shared by producers
+    alignas(CACHE_LINE) std::atomic<std::size_t> head; // owned by the consumer
+    alignas(CACHE_LINE) ParkingSpot consumerParking; // polled by producers after every publish
+    alignas(CACHE_LINE) std::atomic<bool> stopped;
+    WaitStrategy waitStrategy; // how the consumer waits while the queue is empty
+    std::size_t capacity; // power of two
+    std::size_t mask;
+    std::unique_ptr<Slot[]> slots;
+
+    /**
+     * @brief Park the consumer until a producer publishes the slot at a position or the queue is stopped
+     * @param pos Position of the next command to pop
+     */
+    void waitForWork(std::size_t pos);
+
+public:
+    /**
+     * @brief Construct a ring queue
+     * @param capacity Maximum capacity of commands allowed in the queue at once, rounded up to a power of two
+     */
+    explicit MpscRingQueue(size_t capacity);
+
+    /**
+     * @brief Choose how the consumer waits while the queue is empty (SPIN_YIELD by default). Must be called before the queue is used.
+     * @param strategy The wait strategy
+     */
+    void setWaitStrategy(WaitStrategy strategy);
+
+    /**
+     * @brief Enqueue a command (spinning if full)
+     * @param command Command to insert
+     */
+    void push(const Command& command);
+
+    /**
+     * @brief Enqueue a run of commands in one step (blocking while full). Runs longer than the
+     * free space are published in chunks as the consumer frees slots.
+     * @param commands Commands to insert
+     * @param count Number of commands
+     */
+    void pushBulk(const Command* commands, std::size_t count);
+
+    /**
+     * @brief Dequeue the next command (spinning if empty)
+     * @param out Receives the dequeued command
+     * @return if a command was successfully popped
+     */
+    bool pop(Command& out);
+
+    /**
+     * @brief Dequeue every available command up to a limit in one step (blocking if empty)
+     * @param out Buffer receiving the dequeued commands
+     * @param maxCommands Maximum number of commands to dequeue
+     * @return Number of commands dequeued, 0 once the queue is stopped and drained
+     */
+    std::size_t popBulk(Command* out, std::size_t maxCommands);
+
+    /**
+     * @brief Evaluates if the queue is empty
+     * @return if the queue is empty
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Retrieves the number of commands waiting in the queue
+     * @return The approximate number of queued commands
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Stop the queue and release all spinning or parked threads
+     */
+    void stop();
+};
@@ -0,0 +1,17 @@
+#pragma once
+#include "EngineCommand.h"
+#include "SpscRing.h"
+#include "Order_Book/RejectReason.h"
+
+/**
+ * @brief Represents a command the engine refused, published on the reject channel
+ */
+struct RejectEvent {
+    SeqNum seqNum; // sequence number of the rejected command
+    SymbolId symbol;
+    IdNumber idNumber;
+    CommandType type;
+    RejectReason reason;
+};
+
+using RejectRing = SpscRing<RejectEvent>;
@@ -0,0 +1,85 @@
+#include "ShardedEngine.h"
+#include "Backoff.h"
+#include <algorithm>
+
+template<typename EngineType>
+ShardedEngine<EngineType>::ShardedEngine(const ShardConfig& config) {
+    const std::size_t count = std::max<std::size_t>(config.shards, 1);
+    shards.reserve(count);
+    for (std::size_t i = 0; i < count; i++) {
+        // Symbol 0 lives on one shard only, so every shard creates its books on demand
+        shards.push_back(std::make_unique<EngineType>(config.queueCapacity, config.bookConfig, config.batchConfig, config.maxSymbols, false));
+        if (!config.cores.empty()) {
+            shards.back()->setCpuAffinity(config.cores[i % config.cores.size()]);
+        }
+        shards.back()->enableBookViews(config.viewDepth);
+        if (config.waitStrategy) {
+            shards.back()->setWaitStrategy(*config.waitStrategy);
+        }
+    }
+}
+
+template<typename EngineType>
+ShardedEngine<EngineType>::~ShardedEngine() { stop(); }
+
+template<typename EngineType>
+void ShardedEngine<EngineType>::start() {
+    try {
+        for (auto& shard : shards) { shard->start(); }
+    } catch (...) {
+        stop();
+        throw;
+    }
+}
+
+template<typename EngineType>
+void ShardedEngine<EngineType>::stop() {
+    for (auto& shard : shards) { shard->stop(); }
+}
+
+template<typename EngineType>
+void ShardedEngine<EngineType>::flush() const {
+    for (const auto& shard : shards) {
+        const SeqNum target = shard->lastSubmitted();
+        Backoff backoff;
+        while (shard->lastProcessed() < target) {
+            backoff.pause();
+        }
+    }
+}
+
+template<typename EngineType>
+SeqNum ShardedEngine<EngineType>::submit(const Command& cmd) {
+    return shards[shardOf(cmd.symbol)]->submit(cmd);
+}
+
+template<typename EngineType>
+std::size_t ShardedEngine<EngineType>::shardOf(const SymbolId symbol) const {
+    return symbol % shards.size();
+}
+
+template<typename EngineType>
+std::size_t ShardedEngine<EngineType>::getNumberOfShards() const { return shards.size(); }
+
+template<typename EngineType>
+EngineType& ShardedEngine<EngineType>::getShard(const std::size_t index) { return *shards[index]; }
+
+template<typename EngineType>
+EngineCounters ShardedEngine<EngineType>::getCounters() const {
+    EngineCounters total = {};
+    for (const auto& shard : shards) {
+        const EngineCounters counters = shard->getCounters();
+        total.commands += counters.commands;
+        total.rejected += counters.rejected;
+        total.levelsCreated += counters.levelsCreated;
+        total.levelsDestroyed += counters.levelsDestroyed;
+        total.trades += counters.trades;
+        total.queueHighWater = std::max(total.queueHighWater, counters.queueHighWater);
+    }
+    return total;
+}
+
+template class ShardedEngine<Engine>;
+template class ShardedEngine<LadderEngine>;
+template class ShardedEngine<SpscEngine>;
+template class ShardedEngine<MpscEngine>;
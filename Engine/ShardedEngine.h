@@ -0,0 +1,108 @@
+#pragma once
+#include "Engine.h"
+#include <memory>
+#include <optional>
+#include <vector>
+
+/**
+ * @brief Configuration of a sharded engine
+ */
+struct ShardConfig {
+    std::size_t shards = 1; // number of engine shards, each with its own thread, queue and books
+    std::vector<int> cores; // core of shard i is cores[i % cores.size()], empty to leave threads unpinned
+    std::size_t queueCapacity = 1 << 16; // ingress queue capacity per shard
+    std::size_t maxSymbols = 1 << 12; // symbol ids must be below this value
+    std::size_t viewDepth = 0; // levels per side in the book views, 0 to disable them
+    std::optional<WaitStrategy> waitStrategy; // how shard threads wait for commands, unset for the default of the queue
+    BookConfig bookConfig;
+    BatchConfig batchConfig;
+};
+
+/**
+ * @brief Front-end that routes commands by symbol id to independent engine shards. Every symbol lives
+ * on exactly one shard, so books never share a thread and shards scale without coordination.
+ * Sequence numbers are assigned per shard.
+ *
+ * @tparam EngineType The engine used for every shard (e.g. SpscEngine for a single submitting thread)
+ */
+template<typename EngineType>
+class ShardedEngine {
+private:
+    std::vector<std::unique_ptr<EngineType>> shards;
+
+public:
+    /**
+     * @brief Construct the shards without starting them
+     * @param config Number of shards, their cores and the configuration of every shard
+     */
+    explicit ShardedEngine(const ShardConfig& config = {});
+
+    /**
+     * @brief Stop all shards
+     */
+    ~ShardedEngine();
+
+    /**
+     * @brief Start the worker thread of every shard. Throws std::runtime_error, leaving every shard stopped,
+     * if a thread cannot be pinned to its core.
+     */
+    void start();
+
+    /**
+     * @brief Stop every shard and join its thread
+     */
+    void stop();
+
+    /**
+     * @brief Wait until every shard has applied all commands submitted before the call
+     */
+    void flush() const;
+
+    /**
+     * @brief Submit a command to the shard owning its symbol
+     * @param cmd Command to execute
+     * @return Sequence number assigned by the shard
+     */
+    SeqNum submit(const Command& cmd);
+
+    /**
+     * @brief Get the shard index owning a symbol
+     * @param symbol Symbol id
+     * @return Index of the shard
+     */
+    std::size_t shardOf(SymbolId symbol) const;
+
+    /**
+     * @brief Get the number of shards
+     * @return The number of shards
+     */
+    std::size_t getNumberOfShards() const;
+
+    /**
+     * @brief Get a shard
+     * @param index Index of the shard
+     * @return Reference to the shard engine
+     */
+    EngineType& getShard(std::size_t index);
+
+    /**
+     * @brief Get a const reference to the order book of a symbol
+     * @param symbol Symbol id of the book
+     * @return Reference to the order book
+     */
+    const auto& getBook(const SymbolId symbol) const { return shards[shardOf(symbol)]->getBook(symbol); }
+
+    /**
+     * @brief Get the view of the book of a symbol (safe from any thread)
+     * @param symbol Symbol id of the book
+     * @return Reference to the view
+     */
+    const BookView& getBookView(const SymbolId symbol) const { return shards[shardOf(symbol)]->getBookView(symbol); }
+
+    /**
+     * @brief Get the counters summed over all shards (safe from any thread). The queue high-water
+     * mark is the deepest of any shard.
+     * @return Snapshot of the counters
+     */
+    EngineCounters getCounters() const;
+};
@@ -0,0 +1,146 @@
+#pragma once
+#include "Backoff.h"
+#include <atomic>
+#include <bit>
+#include <memory>
+
+/**
+ * @brief Preallocated lock-free single-producer single-consumer ring of trivially copyable events.
+ * The producer never allocates; when the ring is full it spins until the consumer catches up.
+ *
+ * @tparam T The event type
+ */
+template<typename T>
+class SpscRing {
+private:
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    // Consumer-owned line
+    alignas(CACHE_LINE) std::atomic<std::size_t> head;
+    std::size_t cachedTail;
+
+    // Producer-owned line
+    alignas(CACHE_LINE) std::atomic<std::size_t> tail;
+    std::size_t cachedHead;
+
+    alignas(CACHE_LINE) std::size_t capacity; // power of two
+    std::size_t mask;
+    std::unique_ptr<T[]> slots;
+
+public:
+    /**
+     * @brief Construct a ring
+     * @param capacity Number of events the ring can hold, rounded up to a power of two
+     */
+    explicit SpscRing(std::size_t capacity);
+
+    /**
+     * @brief Append an event if there is room (producer only)
+     * @param event Event to append
+     * @return if the event was appended
+     */
+    bool tryPush(const T& event);
+
+    /**
+     * @brief Append an event, spinning while the ring is full (producer only)
+     * @param event Event to append
+     */
+    void push(const T& event);
+
+    /**
+     * @brief Remove the oldest event if there is one (consumer only)
+     * @param out Receives the event
+     * @return if an event was removed
+     */
+    bool tryPop(T& out);
+
+    /**
+     * @brief Remove up to a number of events in one step (consumer only)
+     * @param out Buffer receiving the events
+     * @param maxEvents Maximum number of events to remove
+     * @return Number of events removed
+     */
+    std::size_t popBulk(T* out, std::size_t maxEvents);
+
+    /**
+     * @brief Evaluates if the ring is empty
+     * @return if the ring is empty
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Retrieves the number of events in the ring
+     * @return The approximate number of events
+     */
+    std::size_t size() const;
+};
+
+template<typename T>
+SpscRing<T>::SpscRing(const std::size_t capacity):
+    head(0),
+    cachedTail(0),
+    tail(0),
+    cachedHead(0),
+    capacity(std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity)),
+    mask(this->capacity - 1),
+    slots(std::make_unique<T[]>(this->capacity))
+{}
+
+template<typename T>
+bool SpscRing<T>::tryPush(const T& event) {
+    const std::size_t t = tail.load(std::memory_order_relaxed);
+    if (t - cachedHead >= capacity) {
+        cachedHead = head.load(std::memory_order_acquire);
+        if (t - cachedHead >= capacity) { return false; }
+    }
+    slots[t & mask] = event;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T>
+void SpscRing<T>::push(const T& event) {
+    Backoff backoff;
+    while (!tryPush(event)) {
+        backoff.pause();
+    }
+}
+
+template<typename T>
+bool SpscRing<T>::tryPop(T& out) {
+    const std::size_t h = head.load(std::memory_order_relaxed);
+    if (h == cachedTail) {
+        cachedTail = tail.load(std::memory_order_acquire);
+        if (h == cachedTail) { return false; }
+    }
+    out = slots[h & mask];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T>
+std::size_t SpscRing<T>::popBulk(T* out, const std::size_t maxEvents) {
+    const std::size_t h = head.load(std::memory_order_relaxed);
+    if (cachedTail - h < maxEvents) {
+        cachedTail = tail.load(std::memory_order_acquire);
+    }
+    const std::size_t available = cachedTail - h;
+    const std::size_t n = available < maxEvents ? available : maxEvents;
+    for (std::size_t i = 0; i < n; i++) {
+        out[i] = slots[(h + i) & mask];
+    }
+    head.store(h + n, std::memory_order_release);
+    return n;
+}
+
+template<typename T>
+bool SpscRing<T>::isEmpty() const {
+    return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+}
+
+template<typename T>
+std::size_t SpscRing<T>::size() const {
+    const std::size_t h = head.load(std::memory_order_relaxed);
+    const std::size_t t = tail.load(std::memory_order_acquire);
+    return t > h ? t - h : 0;
+}
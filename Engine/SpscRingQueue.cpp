@@ -0,0 +1,124 @@
+#include "SpscRingQueue.h"
+#include "Backoff.h"
+#include <bit>
+
+SpscRingQueue::SpscRingQueue(size_t capacity):
+    head(0),
+    cachedTail(0),
+    tail(0),
+    cachedHead(0),
+    stopped(false),
+    waitStrategy(WaitStrategy::SPIN_YIELD),
+    capacity(std::bit_ceil(capacity < 2 ? size_t{2} : capacity)),
+    mask(this->capacity - 1),
+    slots(std::make_unique<Command[]>(this->capacity))
+{}
+
+void SpscRingQueue::setWaitStrategy(const WaitStrategy strategy) {
+    waitStrategy = strategy;
+}
+
+void SpscRingQueue::push(const Command& command) {
+    const std::size_t t = tail.load(std::memory_order_relaxed);
+    // Wait for queue to be not full, only re-reading head when the cached view says full
+    Backoff backoff;
+    while (t - cachedHead >= capacity) {
+        cachedHead = head.load(std::memory_order_acquire);
+        if (t - cachedHead < capacity) { break; }
+        if (stopped.load(std::memory_order_relaxed)) { return; }
+        backoff.pause();
+    }
+    slots[t & mask] = command;
+    tail.store(t + 1, std::memory_order_release);
+    if (waitStrategy == WaitStrategy::SPIN_PARK) { consumerParking.wake(); }
+}
+
+void SpscRingQueue::pushBulk(const Command* commands, std::size_t count) {
+    std::size_t t = tail.load(std::memory_order_relaxed);
+    Backoff backoff;
+    while (count > 0) {
+        // Wait for free space, only re-reading head when the cached view says full
+        if (t - cachedHead >= capacity) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead >= capacity) {
+                if (stopped.load(std::memory_order_relaxed)) { return; }
+                backoff.pause();
+                continue;
+            }
+        }
+        const std::size_t free = capacity - (t - cachedHead);
+        const std::size_t n = count < free ? count : free;
+        for (std::size_t i = 0; i < n; i++) {
+            slots[(t + i) & mask] = commands[i];
+        }
+        t += n;
+        commands += n;
+        count -= n;
+        tail.store(t, std::memory_order_release); // publish the whole chunk at once
+        if (waitStrategy == WaitStrategy::SPIN_PARK) { consumerParking.wake(); }
+        backoff.reset();
+    }
+}
+
+bool SpscRingQueue::pop(Command& out) {
+    const std::size_t h = head.load(std::memory_order_relaxed);
+    // Wait for queue to be not empty, only re-reading tail when the cached view says empty
+    Backoff backoff(waitStrategy);
+    while (h == cachedTail) {
+        cachedTail = tail.load(std::memory_order_acquire);
+        if (h != cachedTail) { break; }
+        if (stopped.load(std::memory_order_acquire)) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) { return false; }
+            break;
+        }
+        if (backoff.pause()) { waitForWork(h); }
+    }
+    out = slots[h & mask];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+std::size_t SpscRingQueue::popBulk(Command* out, const std::size_t maxCommands) {
+    const std::size_t h = head.load(std::memory_order_relaxed);
+    Backoff backoff(waitStrategy);
+    while (h == cachedTail) {
+        cachedTail = tail.load(std::memory_order_acquire);
+        if (h != cachedTail) { break; }
+        if (stopped.load(std::memory_order_acquire)) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) { return 0; }
+            break;
+        }
+        if (backoff.pause()) { waitForWork(h); }
+    }
+    if (cachedTail - h < maxCommands) {
+        cachedTail = tail.load(std::memory_order_acquire); // pick up anything published meanwhile
+    }
+    const std::size_t available = cachedTail - h;
+    const std::size_t n = available < maxCommands ? available : maxCommands;
+    for (std::size_t i = 0; i < n; i++) {
+        out[i] = slots[(h + i) & mask];
+    }
+    head.store(h + n, std::memory_order_release);
+    return n;
+}
+
+bool SpscRingQueue::isEmpty() const {
+    return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+}
+
+std::size_t SpscRingQueue::size() const {
+    const std::size_t h = head.load(std::memory_order_relaxed);
+    const std::size_t t = tail.load(std::memory_order_acquire);
+    return t > h ? t - h : 0;
+}
+
+void SpscRingQueue::waitForWork(const std::size_t h) {
+    consumerParking.park([&] { return tail.load(std::memory_order_acquire) != h || stopped.load(std::memory_order_acquire); });
+}
+
+void SpscRingQueue::stop() {
+    stopped.store(true, std::memory_order_release);
+    consumerParking.wake();
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "Order.h"
+#include <cstdint>
+
+/**
+ * @brief All kinds of incremental book events
+ */
+enum class BookEventType : std::uint8_t {
+    ORDER_ADDED, // an order started resting (L3)
+    ORDER_REDUCED, // a resting order was partially filled, qty is what remains (L3)
+    ORDER_DELETED, // a resting order was canceled, modified away or completely filled (L3)
+    TRADE, // a fill between a resting order and the order that crossed it
+    LEVEL_CHANGED // the aggregates of a price level changed, levelQuantity 0 means the level is gone (L2)
+};
+
+/**
+ * @brief Fixed-size incremental book event, written by the matching thread into the market data ring.
+ * Every order event is followed by the LEVEL_CHANGED event of its level, so L2 consumers can ignore
+ * the order events and L3 consumers can ignore the level events.
+ */
+struct BookEvent {
+    std::uint64_t seq; // ring sequence number, stamped on publish and gap free
+    IdNumber idNumber; // the order, or the maker of a trade, 0 for LEVEL_CHANGED
+    IdNumber contraId; // the taker of a trade, 0 otherwise
+    std::uint64_t levelQuantity; // LEVEL_CHANGED: resting quantity left at the price
+    std::uint32_t symbol;
+    WirePrice price;
+    WireQuantity qty; // ORDER_ADDED: resting quantity, ORDER_REDUCED: remaining quantity, TRADE: filled quantity
+    std::uint32_t levelOrders; // LEVEL_CHANGED: orders left at the price
+    BookEventType type;
+    std::uint8_t side; // Side of the order or level, the maker's side for TRADE
+};
+
+static_assert(sizeof(BookEvent) == 56 || sizeof(WirePrice) + sizeof(WireQuantity) > 8, "book events must keep a fixed shared-memory layout");
@@ -0,0 +1,325 @@
+#include "BookSide.h"
+#include <bit>
+
+template<Side S>
+MapBookSide<S>::MapBookSide(const BookConfig& config) {
+    (void)config;
+}
+
+template<Side S>
+PriceLevel& MapBookSide<S>::getOrCreate(const Price price) {
+    auto [it, inserted] = levels.try_emplace(price);
+    if (inserted) {
+        it->second.price = price;
+    }
+    return it->second;
+}
+
+template<Side S>
+PriceLevel* MapBookSide<S>::find(const Price price) {
+    const auto it = levels.find(price);
+    return it == levels.end() ? nullptr : &it->second;
+}
+
+template<Side S>
+void MapBookSide<S>::erase(const PriceLevel& level) {
+    levels.erase(level.price);
+}
+
+template<Side S>
+PriceLevel* MapBookSide<S>::best() {
+    return levels.empty() ? nullptr : &levels.begin()->second;
+}
+
+template<Side S>
+std::size_t MapBookSide<S>::size() const {
+    return levels.size();
+}
+
+template<Side S>
+std::size_t MapBookSide<S>::memoryUsage() const {
+    return levels.size() * MAP_NODE_BYTES<decltype(levels)>;
+}
+
+template<Side S>
+PriceLevel& MapBookSide<S>::appendLevel(const Price price) {
+    // Levels arrive in priority order, so every insertion belongs at the end of the tree
+    const auto it = levels.emplace_hint(levels.end(), price, PriceLevel{price});
+    return it->second;
+}
+
+template<Side S>
+void MapBookSide<S>::collectLevels(std::vector<const PriceLevel*>& out) const {
+    for (const auto& [price, level] : levels) {
+        out.push_back(&level);
+    }
+}
+
+template<Side S>
+std::size_t MapBookSide<S>::copyDepth(const std::span<DepthLevel> out) const {
+    std::size_t copied = 0;
+    for (auto it = levels.begin(); it != levels.end() && copied < out.size(); ++it) {
+        out[copied++] = {it->first, it->second.quantity, it->second.orderCount};
+    }
+    return copied;
+}
+
+template<Side S>
+std::uint64_t MapBookSide<S>::quantityUpTo(const Price limit, const std::uint64_t needed) const {
+    std::uint64_t available = 0;
+    for (auto it = levels.begin(); it != levels.end() && available < needed && !SideTraits<S>::better(limit, it->first); ++it) {
+        available += it->second.quantity;
+    }
+    return available;
+}
+
+template<Side S>
+LadderBookSide<S>::LadderBookSide(const BookConfig& config):
+    basePrice(config.ladderBasePrice),
+    bestIndex(NO_LEVEL),
+    ladderLevels(0)
+{
+    // Round up to whole words, but stop at the largest price, past which basePrice + index would wrap
+    const std::size_t requested = (config.ladderTicks + 63) & ~static_cast<std::size_t>(63);
+    const auto room = static_cast<std::uint64_t>(std::numeric_limits<Price>::max() - basePrice); // ticks above the base price
+    const std::size_t ticks = room < requested ? static_cast<std::size_t>(room + 1) & ~static_cast<std::size_t>(63) : requested;
+    ladder.resize(ticks);
+    for (std::size_t i = 0; i < ticks; i++) {
+        ladder[i].price = basePrice + static_cast<Price>(i);
+    }
+    occupied.assign(ticks / 64, 0);
+    summary.assign((occupied.size() + 63) / 64, 0);
+}
+
+template<Side S>
+std::int64_t LadderBookSide<S>::indexOf(const Price price) const {
+    if (price < basePrice) { return NO_LEVEL; }
+    const std::size_t offset = price - basePrice;
+    if (offset >= ladder.size()) { return NO_LEVEL; }
+    return static_cast<std::int64_t>(offset);
+}
+
+template<Side S>
+void LadderBookSide<S>::setBit(const std::size_t index) {
+    const std::size_t word = index >> 6;
+    occupied[word] |= std::uint64_t{1} << (index & 63);
+    summary[word >> 6] |= std::uint64_t{1} << (word & 63);
+}
+
+template<Side S>
+void LadderBookSide<S>::clearBit(const std::size_t index) {
+    const std::size_t word = index >> 6;
+    occupied[word] &= ~(std::uint64_t{1} << (index & 63));
+    if (occupied[word] == 0) {
+        summary[word >> 6] &= ~(std::uint64_t{1} << (word & 63));
+    }
+}
+
+template<Side S>
+std::int64_t LadderBookSide<S>::highestAtOrBelow(const std::int64_t index) const {
+    if (index < 0) { return NO_LEVEL; }
+
+    // Check the remainder of the starting word first
+    const std::size_t word = static_cast<std::size_t>(index) >> 6;
+    const std::size_t bit = static_cast<std::size_t>(index) & 63;
+    const std::uint64_t mask = (bit == 63) ? ~std::uint64_t{0} : ((std::uint64_t{1} << (bit + 1)) - 1);
+    if (const std::uint64_t bits = occupied[word] & mask) {
+        return static_cast<std::int64_t>((word << 6) + 63 - std::countl_zero(bits));
+    }
+    if (word == 0) { return NO_LEVEL; }
+
+    // Use the summary to skip empty words
+    const std::size_t prevWord = word - 1;
+    std::size_t summaryWord = prevWord >> 6;
+    const std::size_t summaryBit = prevWord & 63;
+    std::uint64_t words = summary[summaryWord] & ((summaryBit == 63) ? ~std::uint64_t{0} : ((std::uint64_t{1} << (summaryBit + 1)) - 1));
+    while (true) {
+        if (words) {
+            const std::size_t found = (summaryWord << 6) + 63 - std::countl_zero(words);
+            return static_cast<std::int64_t>((found << 6) + 63 - std::countl_zero(occupied[found]));
+        }
+        if (summaryWord == 0) { return NO_LEVEL; }
+        words = summary[--summaryWord];
+    }
+}
+
+template<Side S>
+std::int64_t LadderBookSide<S>::lowestAtOrAbove(const std::int64_t index) const {
+    if (index < 0 || static_cast<std::size_t>(index) >= ladder.size()) { return NO_LEVEL; }
+
+    // Check the remainder of the starting word first
+    const std::size_t word = static_cast<std::size_t>(index) >> 6;
+    const std::size_t bit = static_cast<std::size_t>(index) & 63;
+    if (const std::uint64_t bits = occupied[word] & (~std::uint64_t{0} << bit)) {
+        return static_cast<std::int64_t>((word << 6) + std::countr_zero(bits));
+    }
+    const std::size_t nextWord = word + 1;
+    if (nextWord >= occupied.size()) { return NO_LEVEL; }
+
+    // Use the summary to skip empty words
+    std::size_t summaryWord = nextWord >> 6;
+    std::uint64_t words = summary[summaryWord] & (~std::uint64_t{0} << (nextWord & 63));
+    while (true) {
+        if (words) {
+            const std::size_t found = (summaryWord << 6) + std::countr_zero(words);
+            return static_cast<std::int64_t>((found << 6) + std::countr_zero(occupied[found]));
+        }
+        if (++summaryWord >= summary.size()) { return NO_LEVEL; }
+        words = summary[summaryWord];
+    }
+}
+
+template<Side S>
+PriceLevel& LadderBookSide<S>::getOrCreate(const Price price) {
+    const std::int64_t index = indexOf(price);
+    if (index == NO_LEVEL) {
+        auto [it, inserted] = overflow.try_emplace(price);
+        if (inserted) {
+            it->second.price = price;
+        }
+        return it->second;
+    }
+
+    const std::size_t i = static_cast<std::size_t>(index);
+    if (!(occupied[i >> 6] & (std::uint64_t{1} << (i & 63)))) {
+        setBit(i);
+        ladderLevels++;
+        if (bestIndex == NO_LEVEL || SideTraits<S>::better(price, ladder[bestIndex].price)) {
+            bestIndex = index;
+        }
+    }
+    return ladder[i];
+}
+
+template<Side S>
+PriceLevel* LadderBookSide<S>::find(const Price price) {
+    const std::int64_t index = indexOf(price);
+    if (index == NO_LEVEL) {
+        const auto it = overflow.find(price);
+        return it == overflow.end() ? nullptr : &it->second;
+    }
+
+    const std::size_t i = static_cast<std::size_t>(index);
+    return (occupied[i >> 6] & (std::uint64_t{1} << (i & 63))) ? &ladder[i] : nullptr;
+}
+
+template<Side S>
+void LadderBookSide<S>::erase(const PriceLevel& level) {
+    const std::int64_t index = indexOf(level.price);
+    if (index == NO_LEVEL) {
+        overflow.erase(level.price);
+        return;
+    }
+
+    clearBit(static_cast<std::size_t>(index));
+    ladderLevels--;
+    if (index == bestIndex) {
+        // Scan away from the spread for the next best level
+        bestIndex = (S == Side::BUY) ? highestAtOrBelow(index - 1) : lowestAtOrAbove(index + 1);
+    }
+}
+
+template<Side S>
+PriceLevel* LadderBookSide<S>::best() {
+    PriceLevel* level = (bestIndex == NO_LEVEL) ? nullptr : &ladder[bestIndex];
+    if (!overflow.empty()) {
+        PriceLevel& outside = overflow.begin()->second;
+        if (!level || SideTraits<S>::better(outside.price, level->price)) {
+            return &outside;
+        }
+    }
+    return level;
+}
+
+template<Side S>
+std::size_t LadderBookSide<S>::size() const {
+    return ladderLevels + overflow.size();
+}
+
+template<Side S>
+std::size_t LadderBookSide<S>::memoryUsage() const {
+    return ladder.capacity() * sizeof(PriceLevel) + (occupied.capacity() + summary.capacity()) * sizeof(std::uint64_t) +
+           overflow.size() * MAP_NODE_BYTES<decltype(overflow)>;
+}
+
+template<Side S>
+PriceLevel& LadderBookSide<S>::appendLevel(const Price price) {
+    return getOrCreate(price);
+}
+
+template<Side S>
+void LadderBookSide<S>::collectLevels(std::vector<const PriceLevel*>& out) const {
+    // Overflow levels priced better than the whole ladder come first, the rest after the ladder
+    auto it = overflow.begin();
+    const Price ladderBest = (S == Side::BUY) ? basePrice + static_cast<Price>(ladder.size() - 1) : basePrice;
+    for (; it != overflow.end() && SideTraits<S>::better(it->first, ladderBest); ++it) {
+        out.push_back(&it->second);
+    }
+
+    const std::size_t words = occupied.size();
+    for (std::size_t w = 0; w < words; w++) {
+        const std::size_t word = (S == Side::BUY) ? words - 1 - w : w;
+        std::uint64_t bits = occupied[word];
+        while (bits) {
+            const std::size_t bit = (S == Side::BUY) ? 63 - std::countl_zero(bits) : std::countr_zero(bits);
+            out.push_back(&ladder[(word << 6) + bit]);
+            bits &= ~(std::uint64_t{1} << bit);
+        }
+    }
+
+    for (; it != overflow.end(); ++it) {
+        out.push_back(&it->second);
+    }
+}
+
+template<Side S>
+std::size_t LadderBookSide<S>::copyDepth(const std::span<DepthLevel> out) const {
+    // Merge the ladder, walked away from the spread through the bitmaps, with the overflow levels
+    std::size_t copied = 0;
+    auto it = overflow.begin();
+    std::int64_t index = bestIndex;
+    while (copied < out.size()) {
+        const PriceLevel* level;
+        if (it != overflow.end() && (index == NO_LEVEL || SideTraits<S>::better(it->first, ladder[index].price))) {
+            level = &(it++)->second;
+        }
+        else if (index != NO_LEVEL) {
+            level = &ladder[index];
+            index = (S == Side::BUY) ? highestAtOrBelow(index - 1) : lowestAtOrAbove(index + 1);
+        }
+        else {
+            break;
+        }
+        out[copied++] = {level->price, level->quantity, level->orderCount};
+    }
+    return copied;
+}
+
+template<Side S>
+std::uint64_t LadderBookSide<S>::quantityUpTo(const Price limit, const std::uint64_t needed) const {
+    // Same merge of the ladder and the overflow levels as copyDepth, stopping at the limit
+    std::uint64_t available = 0;
+    auto it = overflow.begin();
+    std::int64_t index = bestIndex;
+    while (available < needed) {
+        const PriceLevel* level;
+        if (it != overflow.end() && (index == NO_LEVEL || SideTraits<S>::better(it->first, ladder[index].price))) {
+            level = &(it++)->second;
+        }
+        else if (index != NO_LEVEL) {
+            level = &ladder[index];
+            index = (S == Side::BUY) ? highestAtOrBelow(index - 1) : lowestAtOrAbove(index + 1);
+        }
+        else {
+            break;
+        }
+        if (SideTraits<S>::better(limit, level->price)) { break; }
+        available += level->quantity;
+    }
+    return available;
+}
+
+template class MapBookSide<Side::BUY>;
+template class MapBookSide<Side::SELL>;
+template class LadderBookSide<Side::BUY>;
+template class LadderBookSide<Side::SELL>;
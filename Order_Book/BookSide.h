@@ -0,0 +1,289 @@
+#pragma once
+#include "Order.h"
+#include "OrderIndex.h"
+#include "PriceLevel.h"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <span>
+#include <vector>
+
+/**
+ * @brief Compile-time description of one side of the book, so per-side code is chosen by the compiler
+ * instead of branching on the side at run time
+ */
+template<Side S>
+struct SideTraits;
+
+template<>
+struct SideTraits<Side::BUY> {
+    using Compare = std::greater<>; // highest bid first
+    static constexpr Side opposite = Side::SELL;
+    static constexpr Price marketLimit = std::numeric_limits<Price>::max(); // a market buy accepts any ask
+    static constexpr bool better(const Price a, const Price b) { return a > b; }
+};
+
+template<>
+struct SideTraits<Side::SELL> {
+    using Compare = std::less<>; // lowest ask first
+    static constexpr Side opposite = Side::BUY;
+    static constexpr Price marketLimit = 0; // a market sell accepts any bid
+    static constexpr bool better(const Price a, const Price b) { return a < b; }
+};
+
+/**
+ * @brief When crossed orders are matched
+ */
+enum class MatchingMode {
+    BATCH, // orders rest on arrival and matchOrders uncrosses the book
+    CONTINUOUS // aggressive orders are matched on arrival and only the remainder rests
+};
+
+/**
+ * @brief Configuration shared by all book side backends
+ */
+struct BookConfig {
+    Price ladderBasePrice = 0; // price of the first tick in the ladder
+    std::size_t ladderTicks = 1 << 16; // number of ticks covered by the ladder
+    std::size_t orderCapacity = 0; // number of resting orders to preallocate
+    OrderIndexMode orderIndex = OrderIndexMode::HASHED; // DIRECT only when ids are dense and assigned counting up
+    MatchingMode matchingMode = MatchingMode::BATCH;
+};
+
+/**
+ * @brief Approximate heap bytes of one std::map node: the value and the red-black header (colour and three links)
+ */
+template<typename Map>
+inline constexpr std::size_t MAP_NODE_BYTES = 4 * sizeof(void*) + sizeof(typename Map::value_type);
+
+/**
+ * @brief Book side that keeps its price levels in a red-black tree ordered by price priority
+ */
+template<Side S>
+class MapBookSide {
+private:
+    std::map<Price, PriceLevel, typename SideTraits<S>::Compare> levels;
+
+public:
+    /**
+     * @brief Constructs an empty book side
+     *
+     * @param config The book configuration (unused by the map backend)
+     */
+    explicit MapBookSide(const BookConfig& config = {});
+
+    /**
+     * @brief Retrieves the level at a price, creating it if it does not exist
+     *
+     * @param price The price of the level
+     *
+     * @return A reference to the price level
+     */
+    PriceLevel& getOrCreate(Price price);
+    /**
+     * @brief Retrieves the level at a price
+     *
+     * @param price The price of the level
+     *
+     * @return A pointer to the price level or nullptr if there is none
+     */
+    PriceLevel* find(Price price);
+    const PriceLevel* find(Price price) const { return const_cast<MapBookSide*>(this)->find(price); }
+    /**
+     * @brief Removes an empty level from the book side
+     *
+     * @param level The level to be removed
+     */
+    void erase(const PriceLevel& level);
+    /**
+     * @brief Retrieves the level with the best price on this side
+     *
+     * @return A pointer to the best level or nullptr if the side is empty
+     */
+    PriceLevel* best();
+    const PriceLevel* best() const { return const_cast<MapBookSide*>(this)->best(); }
+    /**
+     * @brief Retrieves the number of price levels on this side
+     *
+     * @return The number of price levels
+     */
+    std::size_t size() const;
+    /**
+     * @brief Creates a level priced worse than every existing level, used to bulk load levels in price priority
+     *
+     * @param price The price of the level
+     *
+     * @return A reference to the new price level
+     */
+    PriceLevel& appendLevel(Price price);
+    /**
+     * @brief Appends every level of this side to a vector in price priority
+     *
+     * @param out The vector receiving the levels
+     */
+    void collectLevels(std::vector<const PriceLevel*>& out) const;
+    /**
+     * @brief Copies the aggregates of the best levels in price priority, visiting only the levels copied
+     *
+     * @param out The buffer receiving the levels, its size is the number of levels requested
+     *
+     * @return The number of levels copied
+     */
+    std::size_t copyDepth(std::span<DepthLevel> out) const;
+    /**
+     * @brief Sums the aggregate quantity of the levels priced at or better than a limit, in price priority,
+     * stopping as soon as the sum reaches the quantity needed
+     *
+     * @param limit The worst price an incoming order accepts
+     * @param needed The quantity after which the walk stops
+     *
+     * @return The quantity available, capped only by the level at which needed was reached
+     */
+    std::uint64_t quantityUpTo(Price limit, std::uint64_t needed) const;
+    /**
+     * @brief Retrieves the bytes held by the price levels of this side, estimating each tree node as its value and the node header
+     *
+     * @return The number of bytes
+     */
+    std::size_t memoryUsage() const;
+};
+
+/**
+ * @brief Book side that keeps its price levels in a flat array indexed by tick offset from a base price.
+ * A two-level occupancy bitmap finds the best level with a few word scans. Prices outside the ladder
+ * fall back to an ordered overflow map so the book stays correct for any price.
+ */
+template<Side S>
+class LadderBookSide {
+private:
+    static constexpr std::int64_t NO_LEVEL = -1;
+
+    Price basePrice;
+    std::vector<PriceLevel> ladder;
+    std::vector<std::uint64_t> occupied; // one bit per tick
+    std::vector<std::uint64_t> summary; // one bit per non-zero word of occupied
+    std::int64_t bestIndex;
+    std::size_t ladderLevels;
+    std::map<Price, PriceLevel, typename SideTraits<S>::Compare> overflow;
+
+    /**
+     * @brief Retrieves the ladder index of a price
+     *
+     * @param price The price to be looked up
+     *
+     * @return The index of the price or NO_LEVEL if it is outside the ladder
+     */
+    std::int64_t indexOf(Price price) const;
+    /**
+     * @brief Marks a tick as occupied in both bitmap levels
+     *
+     * @param index The ladder index
+     */
+    void setBit(std::size_t index);
+    /**
+     * @brief Marks a tick as free in both bitmap levels
+     *
+     * @param index The ladder index
+     */
+    void clearBit(std::size_t index);
+    /**
+     * @brief Finds the highest occupied tick at or below an index
+     *
+     * @param index The ladder index to start scanning from
+     *
+     * @return The occupied index or NO_LEVEL
+     */
+    std::int64_t highestAtOrBelow(std::int64_t index) const;
+    /**
+     * @brief Finds the lowest occupied tick at or above an index
+     *
+     * @param index The ladder index to start scanning from
+     *
+     * @return The occupied index or NO_LEVEL
+     */
+    std::int64_t lowestAtOrAbove(std::int64_t index) const;
+
+public:
+    /**
+     * @brief Constructs an empty ladder covering the configured tick range
+     *
+     * @param config The book configuration holding the ladder base price and tick count
+     */
+    explicit LadderBookSide(const BookConfig& config = {});
+
+    /**
+     * @brief Retrieves the level at a price, creating it if it does not exist
+     *
+     * @param price The price of the level
+     *
+     * @return A reference to the price level
+     */
+    PriceLevel& getOrCreate(Price price);
+    /**
+     * @brief Retrieves the level at a price
+     *
+     * @param price The price of the level
+     *
+     * @return A pointer to the price level or nullptr if there is none
+     */
+    PriceLevel* find(Price price);
+    const PriceLevel* find(Price price) const { return const_cast<LadderBookSide*>(this)->find(price); }
+    /**
+     * @brief Removes an empty level from the book side
+     *
+     * @param level The level to be removed
+     */
+    void erase(const PriceLevel& level);
+    /**
+     * @brief Retrieves the level with the best price on this side
+     *
+     * @return A pointer to the best level or nullptr if the side is empty
+     */
+    PriceLevel* best();
+    const PriceLevel* best() const { return const_cast<LadderBookSide*>(this)->best(); }
+    /**
+     * @brief Retrieves the number of price levels on this side
+     *
+     * @return The number of price levels
+     */
+    std::size_t size() const;
+    /**
+     * @brief Creates a level priced worse than every existing level, used to bulk load levels in price priority
+     *
+     * @param price The price of the level
+     *
+     * @return A reference to the new price level
+     */
+    PriceLevel& appendLevel(Price price);
+    /**
+     * @brief Appends every level of this side to a vector in price priority
+     *
+     * @param out The vector receiving the levels
+     */
+    void collectLevels(std::vector<const PriceLevel*>& out) const;
+    /**
+     * @brief Copies the aggregates of the best levels in price priority, visiting only the levels copied
+     *
+     * @param out The buffer receiving the levels, its size is the number of levels requested
+     *
+     * @return The number of levels copied
+     */
+    std::size_t copyDepth(std::span<DepthLevel> out) const;
+    /**
+     * @brief Sums the aggregate quantity of the levels priced at or better than a limit, in price priority,
+     * stopping as soon as the sum reaches the quantity needed
+     *
+     * @param limit The worst price an incoming order accepts
+     * @param needed The quantity after which the walk stops
+     *
+     * @return The quantity available, capped only by the level at which needed was reached
+     */
+    std::uint64_t quantityUpTo(Price limit, std::uint64_t needed) const;
+    /**
+     * @brief Retrieves the bytes held by the price levels of this side, the whole ladder and its bitmaps whether occupied or not, plus the overflow tree
+     *
+     * @return The number of bytes
+     */
+    std::size_t memoryUsage() const;
+};
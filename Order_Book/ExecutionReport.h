@@ -0,0 +1,18 @@
+#pragma once
+#include "Order.h"
+#include "Engine/SpscRing.h"
+
+/**
+ * @brief Represents a single fill between a resting (maker) order and the order that crossed it (taker)
+ */
+struct ExecutionReport {
+    IdNumber makerId;
+    IdNumber takerId;
+    std::uint32_t symbol; // symbol of the book that matched, set by the engine
+    Price price; // the maker's price
+    Quantity qty;
+    std::uint64_t seq; // trade sequence number of the symbol's book, gap free per symbol but not across a shared ring
+    std::uint64_t timestamp; // steady clock nanoseconds of the match pass
+};
+
+using ExecutionReportRing = SpscRing<ExecutionReport>;
@@ -1,25 +1,29 @@
 #include "Order.h"
 
-Order::Order(std::uint64_t idNumber, Side side, std::uint32_t price, std::uint32_t quantity): 
+Order::Order(IdNumber idNumber, Side side, Price price, Quantity quantity, std::uint64_t arrival): 
     idNumber(idNumber), 
-    side(side), 
+    arrival(arrival),
+    prev(NULL_HANDLE),
+    next(NULL_HANDLE),
     price(price), 
     initialQuantity(quantity), 
     remainingQuantity(quantity), 
-    status(Status::PENDING) 
+    side(side), 
+    status(Status::PENDING)
 {}
 
 // Getter methods
 std::uint64_t Order::getIDNumber() const { return idNumber; }
 Side Order::getSide() const { return side; }
-std::uint32_t Order::getPrice() const { return price; }
-std::uint32_t Order::getInitialQuantity() const { return initialQuantity; }
-std::uint32_t Order::getRemainingQuantity() const { return remainingQuantity; }
-std::uint32_t Order::getFilledQuantity() const { return getInitialQuantity() - getRemainingQuantity(); }
+Price Order::getPrice() const { return price; }
+Quantity Order::getInitialQuantity() const { return initialQuantity; }
+Quantity Order::getRemainingQuantity() const { return remainingQuantity; }
+Quantity Order::getFilledQuantity() const { return getInitialQuantity() - getRemainingQuantity(); }
 Status Order::getStatus() const { return status; }
+std::uint64_t Order::getArrival() const { return arrival; }
 
-void Order::fill(const std::uint32_t qty) {
-    if (qty > getRemainingQuantity()) {
+void Order::fill(const Quantity qty) {
+    if (qty > getRemainingQuantity()) [[unlikely]] {
         throw std::invalid_argument("Order ('" + std::to_string(idNumber) + "') cannot be filled for more than its current remaining quantity");
     }
 
@@ -31,3 +35,12 @@ void Order::fill(const std::uint32_t qty) {
         status = Status::PARTIALLY_FILLED;
     }
 }
+
+void Order::reduceQuantity(const Quantity newQty) {
+    if (newQty == 0 || newQty > getRemainingQuantity()) [[unlikely]] {
+        throw std::invalid_argument("Order ('" + std::to_string(idNumber) + "') can only be reduced to a quantity between 1 and its remaining quantity");
+    }
+
+    initialQuantity -= remainingQuantity - newQty;
+    remainingQuantity = newQty;
+}
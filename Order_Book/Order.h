@@ -1,10 +1,14 @@
 #pragma once
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 
 /**
  * @brief Both order sides
  */
-enum class Side { 
+enum class Side : std::uint8_t {
     BUY, 
     SELL 
 };
@@ -12,27 +16,71 @@ enum class Side {
 /**
  * @brief All statuses of an order in the book
  */
-enum class Status {
+enum class Status : std::uint8_t {
     PENDING,
     PARTIALLY_FILLED,
     COMPLETELY_FILLED
 };
 
+/**
+ * @brief How an incoming order is executed
+ */
+enum class OrderType : std::uint8_t {
+    LIMIT, // rests in the book until it is filled or canceled
+    IOC, // immediate-or-cancel, fills what it can at its limit on arrival and drops the remainder
+    FOK, // fill-or-kill, fills completely at its limit on arrival or not at all
+    MARKET // fills what it can at any price on arrival and drops the remainder
+};
+
+// Width of prices and quantities in bits (16, 32 or 64), chosen at build time. Narrow types shrink
+// orders and levels when the tick range and lot sizes allow it.
+#ifndef LOB_PRICE_BITS
+#define LOB_PRICE_BITS 32
+#endif
+#ifndef LOB_QUANTITY_BITS
+#define LOB_QUANTITY_BITS 32
+#endif
+
+/**
+ * @brief Unsigned integer type of a bit width
+ */
+template<int Bits>
+struct UnsignedOfWidth;
+
+template<> struct UnsignedOfWidth<16> { using type = std::uint16_t; };
+template<> struct UnsignedOfWidth<32> { using type = std::uint32_t; };
+template<> struct UnsignedOfWidth<64> { using type = std::uint64_t; };
+
 using IdNumber = std::uint64_t;
-using Price = std::uint32_t;
-using Quantity = std::uint32_t;
+using Price = UnsignedOfWidth<LOB_PRICE_BITS>::type;
+using Quantity = UnsignedOfWidth<LOB_QUANTITY_BITS>::type;
+// Price and quantity fields of files and shared-memory records, at least 32 bits so a narrow build
+// writes the same layout as the default one
+using WirePrice = std::conditional_t<(sizeof(Price) > 4), std::uint64_t, std::uint32_t>;
+using WireQuantity = std::conditional_t<(sizeof(Quantity) > 4), std::uint64_t, std::uint32_t>;
+using OrderHandle = std::uint32_t; // stable index of an order slot in the OrderPool
+
+inline constexpr OrderHandle NULL_HANDLE = UINT32_MAX;
 
 /**
  * @brief Represents an order in the market
  */
 class Order {
 private:
+    // Ordered by alignment: the 64-bit fields, the handles, the price and quantities (16, 32 or 64 bits,
+    // which only follow the handles at no cost when they are at most 32 bits wide) and the one-byte side
+    // and status last, so with 16- and 32-bit widths the record has no inner padding
     IdNumber idNumber;
-    Side side;
+    std::uint64_t arrival; // book-assigned arrival counter used to tell makers from takers
+    OrderHandle prev; // intrusive links to the neighbouring orders in the same price level
+    OrderHandle next;
     Price price;
     Quantity initialQuantity;
     Quantity remainingQuantity;
+    Side side;
     Status status;
+
+    friend class OrderPool;
 public:
     /**
      * @brief Constructs a new Order object with given properties
@@ -41,8 +89,9 @@ public:
      * @param side The side of the order
      * @param price The price of the order
      * @param qty The quantity of shares of the order
+     * @param arrival The arrival counter of the order in its book
      */
-    Order(IdNumber id, Side side, Price price, Quantity qty);
+    Order(IdNumber id, Side side, Price price, Quantity qty, std::uint64_t arrival = 0);
 
     /**
      * @brief Retrieves the id number of the order
@@ -86,13 +135,29 @@ public:
      * @return The status of the order
      */
     Status getStatus() const;
+    /**
+     * @brief Retrieves the arrival counter of the order, lower values arrived earlier
+     * 
+     * @return The order's arrival counter
+     */
+    std::uint64_t getArrival() const;
 
     /**
-     * @brief Fills a specified number of shares in the order
+     * @brief Fills a specified number of shares in the order. Filling more than the remaining
+     * quantity is an invariant violation of the matcher and throws std::invalid_argument.
      * 
      * @param qty The number of shares to fill in the order
      */
-    void fill(std::uint32_t qty);
+    void fill(Quantity qty);
+    /**
+     * @brief Lowers the remaining quantity of a resting order without touching its place in the queue.
+     * The initial quantity shrinks by the same amount, so the filled quantity and the status are kept.
+     * A new quantity of 0 or above the remaining quantity throws std::invalid_argument.
+     *
+     * @param newQty The new remaining quantity
+     */
+    void reduceQuantity(Quantity newQty);
 };
 
-using OrderPointer = std::shared_ptr<Order>;
\ No newline at end of file
+static_assert(sizeof(Order) == 40 || sizeof(Price) != 4 || sizeof(Quantity) != 4, "resting orders must stay compact");
+static_assert(sizeof(Order) == 32 || sizeof(Price) != 2 || sizeof(Quantity) != 2, "resting orders must stay compact");
@@ -1,154 +1,468 @@
 #include "OrderBook.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <vector>
 
-void OrderBook::addOrder(const OrderPointer& order) {
-    switch (order->getSide()) {
-        case Side::BUY: {
-            // Check if there is a list of the appropriate price level otherwise add a list
-            if (!bids.contains(order->getPrice())) {
-                PriceLevelPointer newPriceLevel = std::make_shared<PriceLevel>();
-                newPriceLevel->price = order->getPrice();
-                bids.insert(std::make_pair(order->getPrice(), newPriceLevel));
-            }
-            const PriceLevelPointer priceLevel = bids[order->getPrice()];
-            const auto it = priceLevel->orders.insert(priceLevel->orders.end(), order);
-            priceLevel->orderIters[order->getIDNumber()] = it;
-            break;
-        }
-        case Side::SELL: {
-            // Check if there is a list of the appropriate price level otherwise add a list
-            if (!asks.contains(order->getPrice())) {
-                PriceLevelPointer newPriceLevel = std::make_shared<PriceLevel>();
-                newPriceLevel->price = order->getPrice();
-                asks.insert(std::make_pair(order->getPrice(), newPriceLevel));
-            }
-            const PriceLevelPointer priceLevel = asks[order->getPrice()];
-            const auto it = priceLevel->orders.insert(priceLevel->orders.end(), order);
-            priceLevel->orderIters[order->getIDNumber()] = it;
-            break;
-        }
-    }
-    orders[order->getIDNumber()] = order;
+template<template<Side> class SideStore>
+BasicOrderBook<SideStore>::BasicOrderBook(const BookConfig& config):
+    bids(config),
+    asks(config),
+    pool(config.orderCapacity),
+    orders(config.orderIndex, config.orderCapacity),
+    matchingMode(config.matchingMode),
+    nextArrival(0),
+    trades(0),
+    levelsCreated(0),
+    levelsDestroyed(0),
+    executionReports(nullptr),
+    executionReportSymbol(0),
+    marketData(nullptr),
+    marketDataSymbol(0)
+{
+}
+
+template<template<Side> class SideStore>
+std::uint64_t BasicOrderBook<SideStore>::reportTimestamp() const {
+    if (!executionReports) { return 0; }
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
 }
 
-OrderPointer OrderBook::modifyOrder(IdNumber idNumber, Price newPrice, Quantity newQty) {
-    if (!orders.contains(idNumber)) {
-        throw std::logic_error("Order('" + std::to_string(idNumber) + "') does not exist");
+template<template<Side> class SideStore>
+void BasicOrderBook<SideStore>::fillOrders(Order& maker, Order& taker, const Quantity qty, const std::uint64_t timestamp) {
+    maker.fill(qty);
+    taker.fill(qty);
+
+    // Report the fill at the price of the resting order
+    const std::uint64_t tradeSeq = bump(trades);
+    if (executionReports) {
+        executionReports->push({maker.getIDNumber(), taker.getIDNumber(), executionReportSymbol, maker.getPrice(), qty, tradeSeq, timestamp});
     }
-    const OrderPointer tempOrder = orders[idNumber];
-    if (tempOrder->getStatus() != Status::PENDING) {
-        throw std::logic_error("Order('" + std::to_string(idNumber) + "') is not pending so it cannot be modified");
+    if (marketData) {
+        marketData->publish({0, maker.getIDNumber(), taker.getIDNumber(), 0, marketDataSymbol, maker.getPrice(), qty, 0,
+                             BookEventType::TRADE, static_cast<std::uint8_t>(maker.getSide())});
     }
+}
 
-    const OrderPointer order = std::make_shared<Order>(tempOrder->getIDNumber(), tempOrder->getSide(), newPrice, newQty);
-    cancelOrder(idNumber);
-    addOrder(order);
-    return order;
+template<template<Side> class SideStore>
+void BasicOrderBook<SideStore>::publishOrder(const BookEventType type, const Order& order, const PriceLevel& level) {
+    if (!marketData) { return; }
+    const auto side = static_cast<std::uint8_t>(order.getSide());
+    const Quantity qty = (type == BookEventType::ORDER_DELETED) ? 0 : order.getRemainingQuantity();
+    marketData->publish({0, order.getIDNumber(), 0, 0, marketDataSymbol, order.getPrice(), qty, 0, type, side});
+    marketData->publish({0, 0, 0, level.quantity, marketDataSymbol, level.price, 0, level.orderCount, BookEventType::LEVEL_CHANGED, side});
 }
 
-void OrderBook::cancelOrder(const IdNumber idNumber) {
-    if (!orders.contains(idNumber)) {
-        throw std::logic_error("Order ('" + std::to_string(idNumber) + "') does not exist or was completely filled");
+template<template<Side> class SideStore>
+template<Side S>
+void BasicOrderBook<SideStore>::settleFill(PriceLevel*& level, const OrderHandle handle) {
+    Order& order = pool.at(handle);
+    if (order.getRemainingQuantity() > 0) {
+        publishOrder(BookEventType::ORDER_REDUCED, order, *level);
+        return;
     }
-    const OrderPointer order = orders[idNumber];
-    if (order->getStatus() == Status::PARTIALLY_FILLED) {
-        throw std::logic_error("Order ('" + std::to_string(idNumber) + "') cannot be canceled as it is already partially filled");
+    orders.erase(order.getIDNumber());
+    pool.unlink(*level, handle);
+    publishOrder(BookEventType::ORDER_DELETED, order, *level);
+    pool.release(handle);
+
+    if (level->empty()) {
+        levelsOf<S>().erase(*level);
+        bump(levelsDestroyed);
+        level = levelsOf<S>().best();
     }
+}
 
-    const Side side = order->getSide();
+template<template<Side> class SideStore>
+template<Side S>
+void BasicOrderBook<SideStore>::removeOrder(const OrderHandle handle) {
+    const Order& order = pool.at(handle);
+    PriceLevel* priceLevel = levelsOf<S>().find(order.getPrice());
+    pool.unlink(*priceLevel, handle);
+    publishOrder(BookEventType::ORDER_DELETED, order, *priceLevel);
+    if (priceLevel->empty()) {
+        levelsOf<S>().erase(*priceLevel);
+        bump(levelsDestroyed);
+    }
+    pool.release(handle);
+}
+
+template<template<Side> class SideStore>
+template<Side TakerSide>
+void BasicOrderBook<SideStore>::matchIncoming(const OrderHandle takerHandle) {
+    constexpr Side MakerSide = SideTraits<TakerSide>::opposite;
+    Order& taker = pool.at(takerHandle);
+    const Price limit = taker.getPrice();
+    const std::uint64_t timestamp = reportTimestamp();
+
+    // A level crosses the taker unless the taker's limit is better for the maker than the level's price
+    PriceLevel* level = levelsOf<MakerSide>().best();
+    while (level && taker.getRemainingQuantity() > 0 && !SideTraits<MakerSide>::better(limit, level->price)) {
+        const OrderHandle makerHandle = level->head;
+        Order& maker = pool.at(makerHandle);
 
-    if (side == Side::BUY) {
-        const PriceLevelPointer priceLevel = bids[order->getPrice()];
-        priceLevel->orders.erase(priceLevel->orderIters[idNumber]);
-        priceLevel->orderIters.erase(idNumber);
-        orders.erase(idNumber);
+        // Fill orders based on remaining quantity differences
+        const Quantity qty = std::min(maker.getRemainingQuantity(), taker.getRemainingQuantity());
+        fillOrders(maker, taker, qty, timestamp);
+        level->quantity -= qty;
 
-        if (priceLevel->orders.empty()) {
-            bids.erase(priceLevel->price);
+        // Remove the filled maker and move to the next level as needed
+        settleFill<MakerSide>(level, makerHandle);
+    }
+}
+
+template<template<Side> class SideStore>
+void BasicOrderBook<SideStore>::addOrder(const IdNumber idNumber, const Side side, const Price price, const Quantity qty) {
+    if (side == Side::BUY) { addOrder<Side::BUY>(idNumber, price, qty); }
+    else { addOrder<Side::SELL>(idNumber, price, qty); }
+}
+
+template<template<Side> class SideStore>
+template<Side S>
+void BasicOrderBook<SideStore>::addOrder(const IdNumber idNumber, const Price price, const Quantity qty) {
+    const OrderHandle handle = pool.allocate(idNumber, S, price, qty, nextArrival++);
+    if (matchingMode == MatchingMode::CONTINUOUS) {
+        matchIncoming<S>(handle);
+        if (pool.at(handle).getRemainingQuantity() == 0) {
+            pool.release(handle);
+            return;
         }
     }
+    // Get the appropriate price level, creating it if needed
+    PriceLevel& priceLevel = levelsOf<S>().getOrCreate(price);
+    if (priceLevel.empty()) { bump(levelsCreated); }
+    pool.pushBack(priceLevel, handle);
+    publishOrder(BookEventType::ORDER_ADDED, pool.at(handle), priceLevel);
+    orders.insert(idNumber, handle);
+}
 
-    else if (side == Side::SELL) {
-        const PriceLevelPointer priceLevel = asks[order->getPrice()];
-        priceLevel->orders.erase(priceLevel->orderIters[idNumber]);
-        priceLevel->orderIters.erase(idNumber);
-        orders.erase(idNumber);
+template<template<Side> class SideStore>
+RejectReason BasicOrderBook<SideStore>::executeOrder(const IdNumber idNumber, const Side side, const Price price, const Quantity qty, const OrderType type) {
+    return (side == Side::BUY) ? executeOrder<Side::BUY>(idNumber, price, qty, type) : executeOrder<Side::SELL>(idNumber, price, qty, type);
+}
 
-        if (priceLevel->orders.empty()) {
-            asks.erase(priceLevel->price);
+template<template<Side> class SideStore>
+template<Side S>
+RejectReason BasicOrderBook<SideStore>::executeOrder(const IdNumber idNumber, const Price price, const Quantity qty, const OrderType type) {
+    if (matchingMode == MatchingMode::BATCH) {
+        matchOrders();
+    }
+
+    // A market order accepts any price on the opposite side
+    const Price limit = (type != OrderType::MARKET) ? price : SideTraits<S>::marketLimit;
+    if (type == OrderType::FOK) {
+        const std::uint64_t available = levelsOf<SideTraits<S>::opposite>().quantityUpTo(limit, qty);
+        if (available < qty) {
+            return RejectReason::NOT_FILLABLE;
         }
     }
+
+    // The taker borrows a pool slot for the walk and never enters a level or the id index
+    const OrderHandle handle = pool.allocate(idNumber, S, limit, qty, nextArrival++);
+    matchIncoming<S>(handle);
+    pool.release(handle);
+    return RejectReason::NONE;
 }
 
-void OrderBook::matchOrders() {
-    PriceLevelPointer highestBidLevel;
-    PriceLevelPointer lowestAskLevel;
+template<template<Side> class SideStore>
+ModifyResult BasicOrderBook<SideStore>::modifyOrder(IdNumber idNumber, Price newPrice, Quantity newQty) {
+    const OrderHandle handle = orders.find(idNumber);
+    if (handle == NULL_HANDLE) {
+        return {RejectReason::UNKNOWN_ORDER, nullptr};
+    }
+    const Order& order = pool.at(handle);
+    if (order.getStatus() != Status::PENDING) {
+        return {RejectReason::NOT_PENDING, nullptr};
+    }
+    const Order* modified = (order.getSide() == Side::BUY) ? modifyResting<Side::BUY>(handle, newPrice, newQty)
+                                                           : modifyResting<Side::SELL>(handle, newPrice, newQty);
+    return {RejectReason::NONE, modified};
+}
 
-    if (!bids.empty() && !asks.empty()) {
-        highestBidLevel = bids.begin()->second;
-        lowestAskLevel = asks.begin()->second;
+template<template<Side> class SideStore>
+template<Side S>
+const Order* BasicOrderBook<SideStore>::modifyResting(const OrderHandle handle, const Price newPrice, const Quantity newQty) {
+    // A size-down at the same price keeps its queue position, so only the order and its level aggregate change
+    Order& order = pool.at(handle);
+    if (newPrice == order.getPrice() && newQty > 0 && newQty <= order.getRemainingQuantity()) {
+        PriceLevel* priceLevel = levelsOf<S>().find(newPrice);
+        priceLevel->quantity -= order.getRemainingQuantity() - newQty;
+        order.reduceQuantity(newQty);
+        publishOrder(BookEventType::ORDER_REDUCED, order, *priceLevel);
+        return &order;
+    }
+
+    const IdNumber idNumber = order.getIDNumber();
+    removeOrder<S>(handle);
+    orders.erase(idNumber);
+    addOrder<S>(idNumber, newPrice, newQty);
+    return findOrder(idNumber); // nullptr if filled on arrival in continuous mode
+}
+
+template<template<Side> class SideStore>
+RejectReason BasicOrderBook<SideStore>::cancelOrder(const IdNumber idNumber) {
+    const OrderHandle handle = orders.find(idNumber);
+    if (handle == NULL_HANDLE) {
+        return RejectReason::UNKNOWN_ORDER;
+    }
+    const Order& order = pool.at(handle);
+    if (order.getStatus() == Status::PARTIALLY_FILLED) {
+        return RejectReason::PARTIALLY_FILLED;
     }
 
+    if (order.getSide() == Side::BUY) { removeOrder<Side::BUY>(handle); }
+    else { removeOrder<Side::SELL>(handle); }
+    orders.erase(idNumber);
+    return RejectReason::NONE;
+}
+
+template<template<Side> class SideStore>
+void BasicOrderBook<SideStore>::matchOrders() {
+    PriceLevel* highestBidLevel = bids.best();
+    PriceLevel* lowestAskLevel = asks.best();
+    const std::uint64_t timestamp = reportTimestamp();
+
     while (highestBidLevel && lowestAskLevel &&
-           !highestBidLevel->orders.empty() && !lowestAskLevel->orders.empty() &&
            highestBidLevel->price >= lowestAskLevel->price) {
-        const OrderPointer highestBidOrder = highestBidLevel->orders.front();
-        const OrderPointer lowestAskOrder = lowestAskLevel->orders.front();
+        const OrderHandle highestBidHandle = highestBidLevel->head;
+        const OrderHandle lowestAskHandle = lowestAskLevel->head;
+        Order& highestBidOrder = pool.at(highestBidHandle);
+        Order& lowestAskOrder = pool.at(lowestAskHandle);
 
-        // Fill orders based on remaining quantity differences
-        const Quantity qty = std::min(highestBidOrder->getRemainingQuantity(), lowestAskOrder->getRemainingQuantity());
-        highestBidOrder->fill(qty);
-        lowestAskOrder->fill(qty);
-
-        // Remove filled order and update pointers as needed
-        if (highestBidOrder->getRemainingQuantity() == 0) {
-            IdNumber idNumber = highestBidOrder->getIDNumber();
-            highestBidLevel->orders.pop_front();
-            highestBidLevel->orderIters.erase(idNumber);
-            orders.erase(idNumber);
-
-            if (highestBidLevel->orders.empty()) {
-                bids.erase(highestBidLevel->price);
-                if (!bids.empty()) {
-                    highestBidLevel = bids.begin()->second;
-                }
-                else {
-                    highestBidLevel = nullptr;
-                }
-            }
+        // Fill orders based on remaining quantity differences, the order that was resting first is the maker
+        const Quantity qty = std::min(highestBidOrder.getRemainingQuantity(), lowestAskOrder.getRemainingQuantity());
+        if (highestBidOrder.getArrival() < lowestAskOrder.getArrival()) {
+            fillOrders(highestBidOrder, lowestAskOrder, qty, timestamp);
         }
-        if (lowestAskOrder->getRemainingQuantity() == 0) {
-            IdNumber idNumber = lowestAskOrder->getIDNumber();
-            lowestAskLevel->orders.pop_front();
-            lowestAskLevel->orderIters.erase(idNumber);
-            orders.erase(idNumber);
-
-            if (lowestAskLevel->orders.empty()) {
-                asks.erase(lowestAskLevel->price);
-                if (!asks.empty()) {
-                    lowestAskLevel = asks.begin()->second;
-                }
-                else {
-                    lowestAskLevel = nullptr;
-                }
-            }
+        else {
+            fillOrders(lowestAskOrder, highestBidOrder, qty, timestamp);
         }
+        highestBidLevel->quantity -= qty;
+        lowestAskLevel->quantity -= qty;
+
+        // Remove filled orders and move to the next levels as needed
+        settleFill<Side::BUY>(highestBidLevel, highestBidHandle);
+        settleFill<Side::SELL>(lowestAskLevel, lowestAskHandle);
     }
 }
 
-OrderPointer OrderBook::getOrderByID(const IdNumber idNumber) const {
-    if (!orders.contains(idNumber)) {
+template<template<Side> class SideStore>
+BookCounters BasicOrderBook<SideStore>::getCounters() const {
+    return {
+        levelsCreated.load(std::memory_order_relaxed),
+        levelsDestroyed.load(std::memory_order_relaxed),
+        trades.load(std::memory_order_relaxed)
+    };
+}
+
+template<template<Side> class SideStore>
+BookMemoryUsage BasicOrderBook<SideStore>::getMemoryUsage() const {
+    return {pool.memoryUsage(), bids.memoryUsage() + asks.memoryUsage(), orders.memoryUsage()};
+}
+
+template<template<Side> class SideStore>
+MatchingMode BasicOrderBook<SideStore>::getMatchingMode() const {
+    return matchingMode;
+}
+
+template<template<Side> class SideStore>
+void BasicOrderBook<SideStore>::setExecutionReportRing(ExecutionReportRing* ring, const std::uint32_t symbol) {
+    executionReports = ring;
+    executionReportSymbol = symbol;
+}
+
+template<template<Side> class SideStore>
+void BasicOrderBook<SideStore>::setMarketDataPublisher(MarketDataPublisher* publisher, const std::uint32_t symbol) {
+    marketData = publisher;
+    marketDataSymbol = symbol;
+}
+
+template<template<Side> class SideStore>
+const Order* BasicOrderBook<SideStore>::findOrder(const IdNumber idNumber) const {
+    const OrderHandle handle = orders.find(idNumber);
+    return handle == NULL_HANDLE ? nullptr : &pool.at(handle);
+}
+
+template<template<Side> class SideStore>
+const Order& BasicOrderBook<SideStore>::getOrderByID(const IdNumber idNumber) const {
+    const Order* order = findOrder(idNumber);
+    if (!order) {
         throw std::logic_error("Order ('" + std::to_string(idNumber) + "') does not exist");
     }
 
-    return orders.at(idNumber);
+    return *order;
+}
+
+template<template<Side> class SideStore>
+DepthLevel BasicOrderBook<SideStore>::getBestBid() const {
+    const PriceLevel* level = bids.best();
+    return level ? DepthLevel{level->price, level->quantity, level->orderCount} : DepthLevel{};
+}
+
+template<template<Side> class SideStore>
+DepthLevel BasicOrderBook<SideStore>::getBestAsk() const {
+    const PriceLevel* level = asks.best();
+    return level ? DepthLevel{level->price, level->quantity, level->orderCount} : DepthLevel{};
+}
+
+template<template<Side> class SideStore>
+std::optional<std::int64_t> BasicOrderBook<SideStore>::getSpread() const {
+    const PriceLevel* bid = bids.best();
+    const PriceLevel* ask = asks.best();
+    if (!bid || !ask) { return std::nullopt; }
+    return static_cast<std::int64_t>(ask->price) - static_cast<std::int64_t>(bid->price);
 }
 
-std::size_t OrderBook::getNumberOfOrders() const {
+template<template<Side> class SideStore>
+DepthLevel BasicOrderBook<SideStore>::getLevel(const Side side, const Price price) const {
+    const PriceLevel* level = (side == Side::BUY) ? bids.find(price) : asks.find(price);
+    return level ? DepthLevel{level->price, level->quantity, level->orderCount} : DepthLevel{price, 0, 0};
+}
+
+template<template<Side> class SideStore>
+std::size_t BasicOrderBook<SideStore>::getDepth(const Side side, const std::span<DepthLevel> out) const {
+    return (side == Side::BUY) ? bids.copyDepth(out) : asks.copyDepth(out);
+}
+
+template<template<Side> class SideStore>
+std::size_t BasicOrderBook<SideStore>::getNumberOfOrders() const {
     return orders.size();
 }
 
+template<template<Side> class SideStore>
+std::size_t BasicOrderBook<SideStore>::getNumberOfLevels(const Side side) const {
+    return (side == Side::BUY) ? bids.size() : asks.size();
+}
+
+template<template<Side> class SideStore>
+bool BasicOrderBook<SideStore>::contains(const IdNumber idNumber) const {
+    return orders.find(idNumber) != NULL_HANDLE;
+}
+
+template<template<Side> class SideStore>
+std::size_t BasicOrderBook<SideStore>::snapshotSize() const {
+    return sizeof(SnapshotBook) + (bids.size() + asks.size()) * sizeof(SnapshotLevel) + orders.size() * sizeof(SnapshotOrder);
+}
+
+template<template<Side> class SideStore>
+std::uint8_t* BasicOrderBook<SideStore>::writeSnapshot(std::uint8_t* out) const {
+    const SnapshotBook header = {
+        orders.size(),
+        static_cast<std::uint32_t>(bids.size()),
+        static_cast<std::uint32_t>(asks.size()),
+        nextArrival,
+        trades.load(std::memory_order_relaxed),
+        levelsCreated.load(std::memory_order_relaxed),
+        levelsDestroyed.load(std::memory_order_relaxed)
+    };
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+
+    std::vector<const PriceLevel*> levels;
+    levels.reserve(bids.size() + asks.size());
+    bids.collectLevels(levels);
+    asks.collectLevels(levels);
+
+    // Orders of a level are scattered over the pool, so walking one level at a time stalls on a cache
+    // miss per order. Walking several levels in lockstep keeps that many misses in flight at once.
+    constexpr std::size_t LOCKSTEP_LEVELS = 16;
+    std::array<OrderHandle, LOCKSTEP_LEVELS> cursors;
+    std::array<std::vector<SnapshotOrder>, LOCKSTEP_LEVELS> buffers;
+    for (std::size_t first = 0; first < levels.size(); first += LOCKSTEP_LEVELS) {
+        const std::size_t count = std::min(LOCKSTEP_LEVELS, levels.size() - first);
+        for (std::size_t k = 0; k < count; k++) {
+            cursors[k] = levels[first + k]->head;
+            buffers[k].clear();
+        }
+        for (bool active = true; active;) {
+            active = false;
+            for (std::size_t k = 0; k < count; k++) {
+                if (cursors[k] == NULL_HANDLE) { continue; }
+                const Order& order = pool.at(cursors[k]);
+                buffers[k].push_back({
+                    order.getIDNumber(),
+                    order.getArrival() << 8 | static_cast<std::uint64_t>(order.getStatus()),
+                    order.getInitialQuantity(),
+                    order.getRemainingQuantity()
+                });
+                cursors[k] = pool.next(cursors[k]);
+                active = true;
+            }
+        }
+        for (std::size_t k = 0; k < count; k++) {
+            const SnapshotLevel levelRecord = {levels[first + k]->price, static_cast<std::uint32_t>(buffers[k].size())};
+            std::memcpy(out, &levelRecord, sizeof(levelRecord));
+            out += sizeof(levelRecord);
+            std::memcpy(out, buffers[k].data(), buffers[k].size() * sizeof(SnapshotOrder));
+            out += buffers[k].size() * sizeof(SnapshotOrder);
+        }
+    }
+    return out;
+}
+
+template<template<Side> class SideStore>
+template<Side S>
+const std::uint8_t* BasicOrderBook<SideStore>::loadLevels(SideStore<S>& side, const std::uint32_t levelCount, const std::uint8_t* in, const std::uint8_t* end) {
+    for (std::uint32_t i = 0; i < levelCount; i++) {
+        if (end - in < static_cast<std::ptrdiff_t>(sizeof(SnapshotLevel))) {
+            throw std::runtime_error("Snapshot is truncated");
+        }
+        const auto* levelRecord = reinterpret_cast<const SnapshotLevel*>(in);
+        in += sizeof(SnapshotLevel);
+        if (levelRecord->orders == 0 ||
+            static_cast<std::size_t>(end - in) < static_cast<std::size_t>(levelRecord->orders) * sizeof(SnapshotOrder)) {
+            throw std::runtime_error("Snapshot level at price " + std::to_string(levelRecord->price) + " is malformed");
+        }
+
+        PriceLevel& level = side.appendLevel(levelRecord->price);
+        const auto* orderRecord = reinterpret_cast<const SnapshotOrder*>(in);
+        for (std::uint32_t j = 0; j < levelRecord->orders; j++, orderRecord++) {
+            const OrderHandle handle = pool.restore(orderRecord->idNumber, S, levelRecord->price, orderRecord->initialQuantity,
+                                                    orderRecord->remainingQuantity, static_cast<Status>(orderRecord->arrivalAndStatus & 0xFF),
+                                                    orderRecord->arrivalAndStatus >> 8);
+            pool.pushBack(level, handle);
+            orders.insert(orderRecord->idNumber, handle);
+        }
+        in = reinterpret_cast<const std::uint8_t*>(orderRecord);
+    }
+    return in;
+}
+
+template<template<Side> class SideStore>
+const std::uint8_t* BasicOrderBook<SideStore>::loadSnapshot(const std::uint8_t* in, const std::uint8_t* end) {
+    if (!orders.empty()) {
+        throw std::logic_error("Snapshot can only be loaded into an empty book");
+    }
+    if (end - in < static_cast<std::ptrdiff_t>(sizeof(SnapshotBook))) {
+        throw std::runtime_error("Snapshot is truncated");
+    }
+    SnapshotBook header;
+    std::memcpy(&header, in, sizeof(header));
+    in += sizeof(header);
+
+    orders.reserve(header.orders);
+    in = loadLevels(bids, header.bidLevels, in, end);
+    in = loadLevels(asks, header.askLevels, in, end);
+    if (orders.size() != header.orders) {
+        throw std::runtime_error("Snapshot order count does not match its levels");
+    }
 
-bool OrderBook::contains(const IdNumber idNumber) const {
-    return orders.contains(idNumber);;
+    nextArrival = header.nextArrival;
+    trades.store(header.trades, std::memory_order_relaxed);
+    levelsCreated.store(header.levelsCreated, std::memory_order_relaxed);
+    levelsDestroyed.store(header.levelsDestroyed, std::memory_order_relaxed);
+    return in;
 }
 
+template class BasicOrderBook<MapBookSide>;
+template class BasicOrderBook<LadderBookSide>;
+template void BasicOrderBook<MapBookSide>::addOrder<Side::BUY>(IdNumber, Price, Quantity);
+template void BasicOrderBook<MapBookSide>::addOrder<Side::SELL>(IdNumber, Price, Quantity);
+template RejectReason BasicOrderBook<MapBookSide>::executeOrder<Side::BUY>(IdNumber, Price, Quantity, OrderType);
+template RejectReason BasicOrderBook<MapBookSide>::executeOrder<Side::SELL>(IdNumber, Price, Quantity, OrderType);
+template void BasicOrderBook<LadderBookSide>::addOrder<Side::BUY>(IdNumber, Price, Quantity);
+template void BasicOrderBook<LadderBookSide>::addOrder<Side::SELL>(IdNumber, Price, Quantity);
+template RejectReason BasicOrderBook<LadderBookSide>::executeOrder<Side::BUY>(IdNumber, Price, Quantity, OrderType);
+template RejectReason BasicOrderBook<LadderBookSide>::executeOrder<Side::SELL>(IdNumber, Price, Quantity, OrderType);
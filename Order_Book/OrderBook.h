@@ -1,78 +1,382 @@
 #pragma once
 #include "Order.h"
-#include <list>
-#include <map>
-#include <unordered_map>
+#include "OrderPool.h"
+#include "BookSide.h"
+#include "ExecutionReport.h"
+#include "RejectReason.h"
+#include "Snapshot.h"
+#include "Engine/MarketDataRing.h"
+#include <atomic>
+#include <optional>
+#include <span>
 
 /**
- * @brief Represents a price level in the order book which contains all 
- * orders at a specific price according to time priority
+ * @brief Snapshot of the book activity counters
  */
-struct PriceLevel {
-    Price price;
-    std::list<OrderPointer> orders; // FIFO by time priority at a certain price level but implemented as doubly-linked list because ability to iterate is required
-    std::unordered_map<IdNumber, std::list<OrderPointer>::iterator> orderIters;
+struct BookCounters {
+    std::uint64_t levelsCreated;
+    std::uint64_t levelsDestroyed;
+    std::uint64_t trades;
 };
 
-using PriceLevelPointer = std::shared_ptr<PriceLevel>;
+/**
+ * @brief Bytes held by a book, including capacity reserved ahead of use
+ */
+struct BookMemoryUsage {
+    std::size_t orders; // order pool slabs
+    std::size_t levels; // price levels of both sides
+    std::size_t index; // id index
+    std::size_t total() const { return orders + levels + index; }
+};
+
+/**
+ * @brief Outcome of a modify request
+ */
+struct ModifyResult {
+    RejectReason reject; // NONE if the order was reduced or replaced
+    const Order* order; // the modified order, nullptr if rejected or filled on arrival in continuous mode
+};
 
 /**
  * @brief Represents a limit order book for matching buy and sell orders
+ *
+ * @tparam SideStore The book side backend used to store price levels (MapBookSide or LadderBookSide)
  */
-class OrderBook {
+template<template<Side> class SideStore>
+class BasicOrderBook {
 private:
-    std::map<Price, PriceLevelPointer, std::greater<>> bids; // sorted descending
-    std::map<Price, PriceLevelPointer> asks; // sorted ascending
-    std::unordered_map<IdNumber, OrderPointer> orders; // to get orders by id
+    SideStore<Side::BUY> bids; // best (highest) bid first
+    SideStore<Side::SELL> asks; // best (lowest) ask first
+    OrderPool pool; // owns every resting order
+    OrderIndex orders; // to get orders by id
+    MatchingMode matchingMode;
+    std::uint64_t nextArrival; // arrival counter handed to each new order
+    // Activity counters, written by the matching thread and readable from any thread
+    std::atomic<std::uint64_t> trades; // also the sequence number of the last fill
+    std::atomic<std::uint64_t> levelsCreated;
+    std::atomic<std::uint64_t> levelsDestroyed;
+    ExecutionReportRing* executionReports; // optional fill stream, nullptr when disabled
+    std::uint32_t executionReportSymbol; // symbol stamped on execution reports
+    MarketDataPublisher* marketData; // optional book event stream, nullptr when disabled
+    std::uint32_t marketDataSymbol; // symbol stamped on published book events
+
+    /**
+     * @brief Increments a counter that only the matching thread writes, without a locked instruction
+     *
+     * @param counter The counter to increment
+     *
+     * @return The incremented value
+     */
+    static std::uint64_t bump(std::atomic<std::uint64_t>& counter) {
+        const std::uint64_t value = counter.load(std::memory_order_relaxed) + 1;
+        counter.store(value, std::memory_order_relaxed);
+        return value;
+    }
+    /**
+     * @brief Retrieves the levels of one side, chosen at compile time
+     *
+     * @tparam S The side of the book
+     *
+     * @return The bids or the asks
+     */
+    template<Side S>
+    SideStore<S>& levelsOf() {
+        if constexpr (S == Side::BUY) { return bids; }
+        else { return asks; }
+    }
+    template<Side S>
+    const SideStore<S>& levelsOf() const { return const_cast<BasicOrderBook*>(this)->levelsOf<S>(); }
+    /**
+     * @brief Retrieves the timestamp stamped on execution reports
+     *
+     * @return Steady clock nanoseconds, or 0 when reporting is disabled
+     */
+    std::uint64_t reportTimestamp() const;
+    /**
+     * @brief Applies a fill to a maker and a taker order and reports it
+     *
+     * @param maker The resting order
+     * @param taker The order that crossed it
+     * @param qty The filled quantity
+     * @param timestamp The timestamp of the match
+     */
+    void fillOrders(Order& maker, Order& taker, Quantity qty, std::uint64_t timestamp);
+    /**
+     * @brief Publishes an order event followed by the new aggregates of its level, if market data is enabled.
+     * Must be called after the level is updated and before an empty level is erased.
+     *
+     * @param type ORDER_ADDED, ORDER_REDUCED or ORDER_DELETED
+     * @param order The order
+     * @param level The price level of the order
+     */
+    void publishOrder(BookEventType type, const Order& order, const PriceLevel& level);
+    /**
+     * @brief Publishes the result of a fill on a resting order and takes the order out of the book once it is
+     * completely filled, erasing its level if that left it empty
+     *
+     * @tparam S The side of the resting order
+     * @param level The level of the order, moved to the new best level of the side if it was erased
+     * @param handle The handle of the order
+     */
+    template<Side S>
+    void settleFill(PriceLevel*& level, OrderHandle handle);
+    /**
+     * @brief Unlinks a resting order from its level and releases it, erasing the level if that left it empty
+     *
+     * @tparam S The side of the order
+     * @param handle The handle of the order
+     */
+    template<Side S>
+    void removeOrder(OrderHandle handle);
+    /**
+     * @brief Applies a modify to a resting pending order of a known side
+     *
+     * @tparam S The side of the order
+     * @param handle The handle of the order
+     * @param newPrice The price of the order
+     * @param newQty The quantity of the order
+     *
+     * @return The modified order, nullptr if it was filled on arrival in continuous mode
+     */
+    template<Side S>
+    const Order* modifyResting(OrderHandle handle, Price newPrice, Quantity newQty);
+    /**
+     * @brief Matches an incoming order against the opposite side of the book
+     *
+     * @tparam TakerSide The side of the incoming order
+     * @param takerHandle The handle of the incoming order, which is not yet linked into a level
+     */
+    template<Side TakerSide>
+    void matchIncoming(OrderHandle takerHandle);
+    /**
+     * @brief Bulk loads the levels of one side from a snapshot section
+     *
+     * @param side The book side receiving the levels
+     * @param levelCount The number of levels to load
+     * @param in The first level record
+     * @param end The end of the readable buffer
+     *
+     * @return The end of the loaded levels
+     */
+    template<Side S>
+    const std::uint8_t* loadLevels(SideStore<S>& side, std::uint32_t levelCount, const std::uint8_t* in, const std::uint8_t* end);
 
 public:
     /**
-     * @brief Adds an order to the order book and attempts to match it
-     * 
-     * @param order The shared pointer to the order to be added
+     * @brief Constructs an empty order book
+     *
+     * @param config The configuration passed to both book sides and the order pool
      */
-    void addOrder(const OrderPointer& order);
+    explicit BasicOrderBook(const BookConfig& config = {});
+
     /**
-     * @brief Modifies an order with the new properties and places it in back of the order book
+     * @brief Adds an order to the back of its price level in the order book. In continuous
+     * matching mode the order is first matched against the opposite side and only the remainder rests.
+     *
+     * @param idNumber The id number of the order
+     * @param side The side of the order
+     * @param price The price of the order
+     * @param qty The quantity of the order
+     */
+    void addOrder(IdNumber idNumber, Side side, Price price, Quantity qty);
+    /**
+     * @brief Adds an order of a side known at compile time, without branching on the side
+     *
+     * @tparam S The side of the order
+     * @param idNumber The id number of the order
+     * @param price The price of the order
+     * @param qty The quantity of the order
+     */
+    template<Side S>
+    void addOrder(IdNumber idNumber, Price price, Quantity qty);
+    /**
+     * @brief Matches an IOC, FOK or MARKET order against the opposite side on arrival. The order never rests and
+     * any unfilled remainder is dropped. A FOK order first checks the aggregate quantity of the levels within its
+     * limit and is killed without touching any order if they cannot fill it. In BATCH mode the book is uncrossed
+     * first, so resting orders that crossed before this one arrived trade with each other first.
+     *
+     * @param idNumber The id number of the order, used in execution reports and trade events
+     * @param side The side of the order
+     * @param price The limit price of the order, ignored for MARKET orders
+     * @param qty The quantity of the order
+     * @param type The order type, IOC, FOK or MARKET
+     *
+     * @return NONE, or NOT_FILLABLE if a FOK order was killed
+     */
+    RejectReason executeOrder(IdNumber idNumber, Side side, Price price, Quantity qty, OrderType type);
+    /**
+     * @brief Executes an IOC, FOK or MARKET order of a side known at compile time, without branching on the side
+     *
+     * @tparam S The side of the order
+     * @param idNumber The id number of the order, used in execution reports and trade events
+     * @param price The limit price of the order, ignored for MARKET orders
+     * @param qty The quantity of the order
+     * @param type The order type, IOC, FOK or MARKET
+     *
+     * @return NONE, or NOT_FILLABLE if a FOK order was killed
+     */
+    template<Side S>
+    RejectReason executeOrder(IdNumber idNumber, Price price, Quantity qty, OrderType type);
+    /**
+     * @brief Modifies an order with the new properties. Lowering the quantity at the same price keeps the order's
+     * queue position and is applied in place. A price change or a larger quantity places the order at the back of
+     * the level at its new price.
      *
      * @param idNumber The id number of the order
      * @param newPrice The price of the order
      * @param newQty The quantity of the order
      *
-     * @return A shared pointer to the modified order
+     * @return The reject reason (UNKNOWN_ORDER or NOT_PENDING) and a read-only pointer to the modified order
      */
-    OrderPointer modifyOrder(IdNumber idNumber, Price newPrice, Quantity newQty);
+    ModifyResult modifyOrder(IdNumber idNumber, Price newPrice, Quantity newQty);
     /**
      * @brief Cancels the order related to the specified id number
      * 
      * @param idNumber The id number of the order to be canceled
+     *
+     * @return NONE if the order was canceled, otherwise UNKNOWN_ORDER or PARTIALLY_FILLED
      */
-    void cancelOrder(IdNumber idNumber);
+    RejectReason cancelOrder(IdNumber idNumber);
     /**
      * @brief Matches buy and sell orders in the order book according to
      * price-time priority
      */
     void matchOrders();
     /**
-     * @brief Retrieves the order with the given id in the order book
+     * @brief Retrieves the level and trade counters (safe from any thread)
+     *
+     * @return Snapshot of the counters
+     */
+    BookCounters getCounters() const;
+    /**
+     * @brief Retrieves the bytes held by the orders, the price levels and the id index (matching thread only)
+     *
+     * @return The memory used by each part of the book
+     */
+    BookMemoryUsage getMemoryUsage() const;
+    /**
+     * @brief Retrieves the matching mode of the order book
+     *
+     * @return The matching mode
+     */
+    MatchingMode getMatchingMode() const;
+    /**
+     * @brief Streams every fill of matchOrders into a ring drained by another thread.
+     * The ring is written from the matching thread only and must outlive the book.
+     *
+     * @param ring The ring receiving execution reports, or nullptr to disable reporting
+     * @param symbol The symbol stamped on the reports of this book
+     */
+    void setExecutionReportRing(ExecutionReportRing* ring, std::uint32_t symbol = 0);
+    /**
+     * @brief Publishes every order, trade and level change of this book to a shared-memory market data ring.
+     * The ring is written from the matching thread only and must outlive the book.
+     *
+     * @param publisher The ring writer, or nullptr to disable publishing
+     * @param symbol The symbol stamped on the events of this book
+     */
+    void setMarketDataPublisher(MarketDataPublisher* publisher, std::uint32_t symbol = 0);
+    /**
+     * @brief Looks up the order with the given id in the order book
+     *
+     * @param idNumber The id number of the order to be retrieved
+     *
+     * @return A read-only pointer to the order valid until it leaves the book, or nullptr if there is none
+     */
+    const Order* findOrder(IdNumber idNumber) const;
+    /**
+     * @brief Retrieves the order with the given id in the order book. The order must be resting,
+     * use findOrder when it may not be.
      *
      * @param idNumber The id number of the order to be retrieved
      *
-     * @return A shared pointer to the modified order
+     * @return A read-only reference to the order, valid until the order leaves the book
+     */
+    const Order& getOrderByID(IdNumber idNumber) const;
+    /**
+     * @brief Retrieves the best bid in O(1) from the aggregates kept on each level (matching thread only)
+     *
+     * @return The price, resting quantity and order count of the best bid, all 0 if there are no bids
+     */
+    DepthLevel getBestBid() const;
+    /**
+     * @brief Retrieves the best ask in O(1) from the aggregates kept on each level (matching thread only)
+     *
+     * @return The price, resting quantity and order count of the best ask, all 0 if there are no asks
+     */
+    DepthLevel getBestAsk() const;
+    /**
+     * @brief Retrieves the best ask price minus the best bid price (matching thread only)
+     *
+     * @return The spread, negative while a batch mode book is crossed, or std::nullopt if a side is empty
      */
-    OrderPointer getOrderByID(IdNumber idNumber) const;
+    std::optional<std::int64_t> getSpread() const;
+    /**
+     * @brief Retrieves the resting quantity and order count at a price (matching thread only)
+     *
+     * @param side The side of the order book
+     * @param price The price of the level
+     *
+     * @return The aggregates of the level, with quantity 0 if there is no level at that price
+     */
+    DepthLevel getLevel(Side side, Price price) const;
+    /**
+     * @brief Copies the best levels of a side into a caller-provided buffer, best first (matching thread only).
+     * Only the copied levels are visited.
+     *
+     * @param side The side of the order book
+     * @param out The buffer receiving the levels, its size is the number of levels requested
+     *
+     * @return The number of levels copied, less than out.size() if the side has fewer levels
+     */
+    std::size_t getDepth(Side side, std::span<DepthLevel> out) const;
     /**
      * @brief Retrieves the total number of orders in the order book
      *
-     * @return A shared pointer to the modified order
+     * @return The number of resting orders
      */
     std::size_t getNumberOfOrders() const;
+    /**
+     * @brief Retrieves the number of price levels on each side of the order book
+     *
+     * @param side The side of the order book
+     *
+     * @return The number of price levels on that side
+     */
+    std::size_t getNumberOfLevels(Side side) const;
     /**
      * @brief Retrieves if order is in the order book or not
      *
      * @return If the order book contains order
      */
     bool contains(IdNumber idNumber) const;
+    /**
+     * @brief Retrieves the size of the binary snapshot of the resting state
+     *
+     * @return The number of bytes writeSnapshot will write
+     */
+    std::size_t snapshotSize() const;
+    /**
+     * @brief Writes the resting state (levels in price priority, orders in time priority with their
+     * remaining quantity and status, and the book counters) as a binary snapshot section
+     *
+     * @param out The buffer receiving the section, at least snapshotSize() bytes and 8-byte aligned
+     *
+     * @return The end of the written section
+     */
+    std::uint8_t* writeSnapshot(std::uint8_t* out) const;
+    /**
+     * @brief Bulk loads a snapshot section into an empty book in one linear pass, building the
+     * levels, their queues and the id index directly instead of adding orders one by one.
+     * Throws std::runtime_error if the section is truncated or malformed.
+     *
+     * @param in The start of the section, typically inside a mapped snapshot file
+     * @param end The end of the readable buffer
+     *
+     * @return The end of the loaded section
+     */
+    const std::uint8_t* loadSnapshot(const std::uint8_t* in, const std::uint8_t* end);
 };
 
-
+using OrderBook = BasicOrderBook<MapBookSide>; // std::map price levels
+using LadderOrderBook = BasicOrderBook<LadderBookSide>; // tick-indexed flat price ladder
@@ -0,0 +1,92 @@
+#include "OrderIndex.h"
+#include <algorithm>
+#include <bit>
+
+OrderIndex::OrderIndex(const OrderIndexMode mode, const std::size_t capacityHint):
+    mode(mode),
+    mask(0),
+    shift(64),
+    entries(0)
+{
+    reserve(capacityHint);
+}
+
+void OrderIndex::rehash(const std::size_t slotCount) {
+    std::vector<Slot> old(slotCount, Slot{0, NULL_HANDLE});
+    old.swap(slots);
+    mask = slotCount - 1;
+    shift = 64 - std::countr_zero(slotCount);
+    for (const Slot& slot : old) {
+        if (slot.handle == NULL_HANDLE) { continue; }
+        std::size_t i = home(slot.idNumber);
+        while (slots[i].handle != NULL_HANDLE) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+    }
+}
+
+void OrderIndex::reserve(const std::size_t count) {
+    if (mode == OrderIndexMode::DIRECT) {
+        if (count > direct.size()) {
+            direct.resize(count, NULL_HANDLE);
+        }
+        return;
+    }
+    // Keep the load at or below 3/4 so probe runs stay short
+    const std::size_t needed = std::bit_ceil(std::max<std::size_t>(16, count + count / 3 + 1));
+    if (needed > slots.size()) {
+        rehash(needed);
+    }
+}
+
+void OrderIndex::insert(const IdNumber idNumber, const OrderHandle handle) {
+    if (mode == OrderIndexMode::DIRECT) {
+        if (idNumber >= direct.size()) {
+            direct.resize(std::max<std::size_t>(idNumber + 1, direct.size() * 2), NULL_HANDLE);
+        }
+        entries += direct[idNumber] == NULL_HANDLE;
+        direct[idNumber] = handle;
+        return;
+    }
+    if ((entries + 1) * 4 > slots.size() * 3) {
+        rehash(slots.size() * 2);
+    }
+    std::size_t i = home(idNumber);
+    while (slots[i].handle != NULL_HANDLE) {
+        if (slots[i].idNumber == idNumber) {
+            slots[i].handle = handle;
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+    slots[i] = {idNumber, handle};
+    entries++;
+}
+
+bool OrderIndex::erase(const IdNumber idNumber) {
+    if (mode == OrderIndexMode::DIRECT) {
+        if (idNumber >= direct.size() || direct[idNumber] == NULL_HANDLE) { return false; }
+        direct[idNumber] = NULL_HANDLE;
+        entries--;
+        return true;
+    }
+    std::size_t hole = home(idNumber);
+    while (slots[hole].handle == NULL_HANDLE || slots[hole].idNumber != idNumber) {
+        if (slots[hole].handle == NULL_HANDLE) { return false; }
+        hole = (hole + 1) & mask;
+    }
+
+    // Backward shift: pull every later entry of the run whose home is at or before the hole into it,
+    // so a lookup never has to probe past an empty slot to find its entry
+    for (std::size_t j = (hole + 1) & mask; slots[j].handle != NULL_HANDLE; j = (j + 1) & mask) {
+        const std::size_t distanceFromHome = (j - home(slots[j].idNumber)) & mask;
+        if (distanceFromHome >= ((j - hole) & mask)) {
+            slots[hole] = slots[j];
+            hole = j;
+        }
+    }
+    slots[hole].handle = NULL_HANDLE;
+    entries--;
+    return true;
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include "Order.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief How a book maps order ids to pool handles
+ */
+enum class OrderIndexMode {
+    HASHED, // open-addressing hash table, for any ids
+    DIRECT // flat array indexed by the id itself, for venues that assign dense ids counting up from 0
+};
+
+/**
+ * @brief Index from order id to pool handle. The hashed mode is a linear probing table of 16-byte slots
+ * holding the id and the handle inline, so a lookup usually touches a single cache line. Deletion shifts
+ * the following entries of the probe run back instead of leaving tombstones, so probe runs never degrade
+ * under churn. The direct mode stores only the handle at the position of the id.
+ */
+class OrderIndex {
+private:
+    /**
+     * @brief One entry of the hashed table, empty when the handle is NULL_HANDLE
+     */
+    struct Slot {
+        IdNumber idNumber;
+        OrderHandle handle;
+    };
+
+    OrderIndexMode mode;
+    std::vector<Slot> slots; // HASHED, the size is a power of two
+    std::vector<OrderHandle> direct; // DIRECT
+    std::size_t mask;
+    int shift; // 64 minus the number of index bits
+    std::size_t entries;
+
+    /**
+     * @brief Retrieves the home slot of an id, using Fibonacci hashing so consecutive ids spread over the table
+     *
+     * @param idNumber The id
+     *
+     * @return The home slot index
+     */
+    std::size_t home(const IdNumber idNumber) const {
+        return static_cast<std::size_t>((idNumber * 0x9E3779B97F4A7C15) >> shift);
+    }
+    /**
+     * @brief Reallocates the hashed table with a new number of slots and reinserts every entry
+     *
+     * @param slotCount The new number of slots, a power of two
+     */
+    void rehash(std::size_t slotCount);
+
+public:
+    /**
+     * @brief Constructs an empty index
+     *
+     * @param mode The indexing mode
+     * @param capacityHint The number of orders to preallocate room for
+     */
+    explicit OrderIndex(OrderIndexMode mode = OrderIndexMode::HASHED, std::size_t capacityHint = 0);
+
+    /**
+     * @brief Looks up the handle of an order
+     *
+     * @param idNumber The id of the order
+     *
+     * @return The handle, or NULL_HANDLE if the id is not indexed
+     */
+    OrderHandle find(const IdNumber idNumber) const {
+        if (mode == OrderIndexMode::DIRECT) {
+            return idNumber < direct.size() ? direct[idNumber] : NULL_HANDLE;
+        }
+        for (std::size_t i = home(idNumber);; i = (i + 1) & mask) {
+            const Slot& slot = slots[i];
+            if (slot.handle == NULL_HANDLE || slot.idNumber == idNumber) {
+                return slot.handle;
+            }
+        }
+    }
+    /**
+     * @brief Indexes an order, replacing the handle if the id is already indexed
+     *
+     * @param idNumber The id of the order
+     * @param handle The handle of the order
+     */
+    void insert(IdNumber idNumber, OrderHandle handle);
+    /**
+     * @brief Removes an id from the index
+     *
+     * @param idNumber The id to remove
+     *
+     * @return If the id was indexed
+     */
+    bool erase(IdNumber idNumber);
+    /**
+     * @brief Makes room for a number of entries without further reallocation
+     *
+     * @param count The number of entries
+     */
+    void reserve(std::size_t count);
+    /**
+     * @brief Retrieves the number of indexed orders
+     *
+     * @return The number of entries
+     */
+    std::size_t size() const { return entries; }
+    /**
+     * @brief Retrieves the bytes held by the table, including free slots
+     *
+     * @return The number of bytes
+     */
+    std::size_t memoryUsage() const { return slots.capacity() * sizeof(Slot) + direct.capacity() * sizeof(OrderHandle); }
+    /**
+     * @brief Checks if no order is indexed
+     *
+     * @return If the index is empty
+     */
+    bool empty() const { return entries == 0; }
+    /**
+     * @brief Retrieves the indexing mode
+     *
+     * @return The mode
+     */
+    OrderIndexMode getMode() const { return mode; }
+};
@@ -0,0 +1,95 @@
+#include "OrderPool.h"
+
+OrderPool::OrderPool(const std::size_t capacityHint):
+    freeHead(NULL_HANDLE),
+    currentBlock(0),
+    liveOrders(0)
+{
+    blocks.reserve((capacityHint + BLOCK_SIZE - 1) / BLOCK_SIZE + 1);
+    do {
+        addBlock();
+    } while (blocks.size() * BLOCK_SIZE < capacityHint);
+}
+
+void OrderPool::addBlock() {
+    blocks.emplace_back();
+    blocks.back().reserve(BLOCK_SIZE);
+}
+
+OrderHandle OrderPool::allocate(const IdNumber id, const Side side, const Price price, const Quantity qty, const std::uint64_t arrival) {
+    liveOrders++;
+
+    // Reuse a freed slot if there is one
+    if (freeHead != NULL_HANDLE) {
+        const OrderHandle handle = freeHead;
+        Order& order = at(handle);
+        freeHead = order.next;
+        order = Order(id, side, price, qty, arrival);
+        return handle;
+    }
+
+    // Otherwise construct in place at the end of the block being filled
+    if (blocks[currentBlock].size() == BLOCK_SIZE && ++currentBlock == blocks.size()) {
+        addBlock();
+    }
+    std::vector<Order>& block = blocks[currentBlock];
+    const auto handle = static_cast<OrderHandle>((currentBlock << BLOCK_BITS) | block.size());
+    block.emplace_back(id, side, price, qty, arrival);
+    return handle;
+}
+
+OrderHandle OrderPool::restore(const IdNumber id, const Side side, const Price price, const Quantity initialQty,
+                               const Quantity remainingQty, const Status status, const std::uint64_t arrival) {
+    const OrderHandle handle = allocate(id, side, price, initialQty, arrival);
+    Order& order = at(handle);
+    order.remainingQuantity = remainingQty;
+    order.status = status;
+    return handle;
+}
+
+void OrderPool::release(const OrderHandle handle) {
+    at(handle).next = freeHead;
+    freeHead = handle;
+    liveOrders--;
+}
+
+void OrderPool::pushBack(PriceLevel& level, const OrderHandle handle) {
+    Order& order = at(handle);
+    order.prev = level.tail;
+    order.next = NULL_HANDLE;
+    if (level.tail != NULL_HANDLE) {
+        at(level.tail).next = handle;
+    }
+    else {
+        level.head = handle;
+    }
+    level.tail = handle;
+    level.quantity += order.remainingQuantity;
+    level.orderCount++;
+}
+
+void OrderPool::unlink(PriceLevel& level, const OrderHandle handle) {
+    const Order& order = at(handle);
+    if (order.prev != NULL_HANDLE) {
+        at(order.prev).next = order.next;
+    }
+    else {
+        level.head = order.next;
+    }
+    if (order.next != NULL_HANDLE) {
+        at(order.next).prev = order.prev;
+    }
+    else {
+        level.tail = order.prev;
+    }
+    level.quantity -= order.remainingQuantity;
+    level.orderCount--;
+}
+
+std::size_t OrderPool::size() const {
+    return liveOrders;
+}
+
+std::size_t OrderPool::memoryUsage() const {
+    return blocks.size() * BLOCK_SIZE * sizeof(Order) + blocks.capacity() * sizeof(std::vector<Order>);
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include "Order.h"
+#include "PriceLevel.h"
+#include <vector>
+
+/**
+ * @brief Slab allocator that owns every resting order of a book. Orders live in fixed-size
+ * blocks so their addresses and handles stay stable, freed slots are recycled through a
+ * free list, and price level queues are threaded through the orders' intrusive links.
+ */
+class OrderPool {
+private:
+    static constexpr std::size_t BLOCK_BITS = 16;
+    static constexpr std::size_t BLOCK_SIZE = std::size_t{1} << BLOCK_BITS;
+
+    std::vector<std::vector<Order>> blocks; // each block is reserved up front and never reallocates
+    OrderHandle freeHead;
+    std::size_t currentBlock; // block that receives never-used slots
+    std::size_t liveOrders;
+
+    /**
+     * @brief Appends a new block of order slots
+     */
+    void addBlock();
+
+public:
+    /**
+     * @brief Constructs a pool with room for at least the given number of orders
+     *
+     * @param capacityHint The number of orders to preallocate
+     */
+    explicit OrderPool(std::size_t capacityHint = 0);
+
+    /**
+     * @brief Allocates and constructs an order
+     *
+     * @param id The numbered id of the order
+     * @param side The side of the order
+     * @param price The price of the order
+     * @param qty The quantity of shares of the order
+     * @param arrival The arrival counter of the order in its book
+     *
+     * @return The handle of the new order
+     */
+    OrderHandle allocate(IdNumber id, Side side, Price price, Quantity qty, std::uint64_t arrival = 0);
+    /**
+     * @brief Allocates an order restored from a snapshot with its fill state
+     *
+     * @param id The numbered id of the order
+     * @param side The side of the order
+     * @param price The price of the order
+     * @param initialQty The quantity the order was entered with
+     * @param remainingQty The quantity still open
+     * @param status The status of the order
+     * @param arrival The arrival counter of the order in its book
+     *
+     * @return The handle of the restored order
+     */
+    OrderHandle restore(IdNumber id, Side side, Price price, Quantity initialQty, Quantity remainingQty, Status status, std::uint64_t arrival);
+    /**
+     * @brief Returns an order slot to the free list
+     *
+     * @param handle The handle of the order to be released
+     */
+    void release(OrderHandle handle);
+    /**
+     * @brief Retrieves the order stored at a handle
+     *
+     * @param handle The handle of the order
+     *
+     * @return A reference to the order
+     */
+    Order& at(OrderHandle handle) { return blocks[handle >> BLOCK_BITS][handle & (BLOCK_SIZE - 1)]; }
+    const Order& at(OrderHandle handle) const { return blocks[handle >> BLOCK_BITS][handle & (BLOCK_SIZE - 1)]; }
+    /**
+     * @brief Retrieves the order behind another in its price level queue
+     *
+     * @param handle The handle of the order
+     *
+     * @return The handle of the next order or NULL_HANDLE if it is the last
+     */
+    OrderHandle next(OrderHandle handle) const { return at(handle).next; }
+    /**
+     * @brief Appends an order to the back of a price level queue and adds its remaining quantity to the level
+     *
+     * @param level The price level
+     * @param handle The handle of the order
+     */
+    void pushBack(PriceLevel& level, OrderHandle handle);
+    /**
+     * @brief Unlinks an order from anywhere in a price level queue and removes its remaining quantity from the level
+     *
+     * @param level The price level
+     * @param handle The handle of the order
+     */
+    void unlink(PriceLevel& level, OrderHandle handle);
+    /**
+     * @brief Retrieves the number of live orders in the pool
+     *
+     * @return The number of live orders
+     */
+    std::size_t size() const;
+    /**
+     * @brief Retrieves the bytes held by the pool, counting every reserved slot whether it is live, free or never used
+     *
+     * @return The number of bytes
+     */
+    std::size_t memoryUsage() const;
+};
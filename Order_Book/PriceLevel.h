@@ -0,0 +1,30 @@
+#pragma once
+#include "Order.h"
+
+/**
+ * @brief Represents a price level in the order book which contains all
+ * orders at a specific price according to time priority
+ */
+struct PriceLevel {
+    Price price = 0;
+    OrderHandle head = NULL_HANDLE; // FIFO by time priority, linked through the orders in the OrderPool
+    OrderHandle tail = NULL_HANDLE;
+    std::uint32_t orderCount = 0; // next to the handles so the 64-bit quantity needs no padding in front
+    std::uint64_t quantity = 0; // remaining quantity of every order in the queue, kept up to date by the book
+
+    /**
+     * @brief Evaluates if the level has no resting orders
+     *
+     * @return If the level is empty
+     */
+    bool empty() const { return head == NULL_HANDLE; }
+};
+
+/**
+ * @brief Aggregated (L2) view of one price level
+ */
+struct DepthLevel {
+    Price price = 0;
+    std::uint64_t quantity = 0; // 0 when the side has no level
+    std::uint32_t orderCount = 0;
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * @brief Business reasons for refusing an operation. They are ordinary outcomes on the hot path,
+ * so they are returned as codes instead of thrown.
+ */
+enum class RejectReason : std::uint8_t {
+    NONE, // the operation was applied
+    UNKNOWN_ORDER, // no resting order has the id, it never existed or was completely filled
+    NOT_PENDING, // the order was already partially filled so it cannot be modified
+    PARTIALLY_FILLED, // the order was already partially filled so it cannot be canceled
+    UNKNOWN_SYMBOL, // the command targets a symbol without an order book
+    NOT_FILLABLE // a fill-or-kill order could not be filled completely on arrival and was killed
+};
+
+/**
+ * @brief Retrieves a readable name of a reject reason
+ *
+ * @param reason The reject reason
+ *
+ * @return The name of the reason
+ */
+inline const char* toString(const RejectReason reason) {
+    switch (reason) {
+        case RejectReason::NONE: return "NONE";
+        case RejectReason::UNKNOWN_ORDER: return "UNKNOWN_ORDER";
+        case RejectReason::NOT_PENDING: return "NOT_PENDING";
+        case RejectReason::PARTIALLY_FILLED: return "PARTIALLY_FILLED";
+        case RejectReason::UNKNOWN_SYMBOL: return "UNKNOWN_SYMBOL";
+        case RejectReason::NOT_FILLABLE: return "NOT_FILLABLE";
+    }
+    return "UNKNOWN";
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "Order.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Binary snapshot layout. A book section is a SnapshotBook followed by its bid levels and then its
+ * ask levels, each in price priority. Every SnapshotLevel is directly followed by its orders in time
+ * priority. All records are fixed size and 8-byte aligned so a mapped snapshot is read in place.
+ */
+
+inline constexpr std::uint64_t SNAPSHOT_MAGIC = 0x3150414E53424F4C; // "LOBSNAP1"
+// Builds with 64-bit prices or quantities write wider records and flag them in the version
+inline constexpr std::uint32_t SNAPSHOT_VERSION = 2 | (sizeof(WirePrice) > 4 ? 0x100 : 0) | (sizeof(WireQuantity) > 4 ? 0x200 : 0);
+inline constexpr std::uint64_t SNAPSHOT_CHECKSUM_SEED = 0x9E3779B97F4A7C15;
+
+/**
+ * @brief File header of an engine snapshot, followed by bookCount sections
+ */
+struct SnapshotHeader {
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t bookCount;
+    std::uint64_t lastSeqNum; // last command reflected in the snapshot
+    std::uint64_t bytes; // size of the whole file
+    std::uint64_t checksum; // covers the header fields before it and every byte after the header
+};
+
+/**
+ * @brief Folds bytes into a snapshot checksum, eight at a time
+ * @param data First byte
+ * @param bytes Number of bytes
+ * @param hash Checksum of the bytes before, SNAPSHOT_CHECKSUM_SEED to start
+ * @return The checksum including the bytes
+ */
+inline std::uint64_t snapshotChecksum(const std::uint8_t* data, const std::size_t bytes, std::uint64_t hash = SNAPSHOT_CHECKSUM_SEED) {
+    for (std::size_t offset = 0; offset < bytes; offset += 8) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, data + offset, std::min<std::size_t>(8, bytes - offset));
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCD;
+        hash ^= hash >> 32;
+    }
+    return hash;
+}
+
+/**
+ * @brief Prefix of a book section in an engine snapshot
+ */
+struct SnapshotSection {
+    std::uint32_t symbol;
+    std::uint32_t reserved;
+    std::uint64_t bytes; // size of the book section that follows
+};
+
+/**
+ * @brief Header of a book section
+ */
+struct SnapshotBook {
+    std::uint64_t orders;
+    std::uint32_t bidLevels;
+    std::uint32_t askLevels;
+    std::uint64_t nextArrival;
+    std::uint64_t trades;
+    std::uint64_t levelsCreated;
+    std::uint64_t levelsDestroyed;
+};
+
+/**
+ * @brief A price level, followed by its orders
+ */
+struct SnapshotLevel {
+    WirePrice price;
+    std::uint32_t orders;
+};
+
+/**
+ * @brief A resting order
+ */
+struct SnapshotOrder {
+    std::uint64_t idNumber;
+    std::uint64_t arrivalAndStatus; // arrival counter << 8 | Status
+    WireQuantity initialQuantity;
+    WireQuantity remainingQuantity;
+};
@@ -0,0 +1,143 @@
+#include "BulkOrderGenerator.h"
+#include "Xoshiro256.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+void OrderColumns::resize(const std::size_t rows) {
+    action.resize(rows);
+    side.resize(rows);
+    type.resize(rows);
+    price.resize(rows);
+    qty.resize(rows);
+    pick.resize(rows);
+}
+
+BulkOrderGenerator::BulkOrderGenerator(const TransitionMatrix& transitionMatrix, const GeneratorConfig& config):
+    cumulative{},
+    config(config)
+{
+    if (transitionMatrix.size() != 3) {
+        throw std::invalid_argument("Transition matrix must have one row per market state");
+    }
+    for (std::size_t from = 0; from < 3; from++) {
+        const std::vector<double>& row = transitionMatrix[from];
+        if (row.size() != 3) {
+            throw std::invalid_argument("Transition matrix must have one column per market state");
+        }
+        // Normalize so the last bucket always ends at 1 and every uniform lands in some state
+        const double total = row[0] + row[1] + row[2];
+        cumulative[from] = {row[0] / total, (row[0] + row[1]) / total, 1.0};
+    }
+}
+
+/**
+ * @brief Converts a probability to a threshold for comparing against a uniform 32-bit value
+ */
+static std::uint64_t toThreshold(const double probability) {
+    return static_cast<std::uint64_t>(std::clamp(probability, 0.0, 1.0) * 4294967296.0);
+}
+
+void BulkOrderGenerator::generateChunk(OrderColumns& out, const std::size_t chunk) const {
+    const std::size_t first = chunk * CHUNK_SIZE;
+    const std::size_t last = std::min(first + CHUNK_SIZE, out.size());
+    Xoshiro256 rng(config.seed, chunk);
+
+    // Probability of a buy in each market state, in MarketState order
+    const std::uint64_t buyThreshold[3] = {toThreshold(0.5), toThreshold(0.9), toThreshold(0.1)};
+    const double limitRatio = 1.0 - config.marketOrderRatio;
+    const std::uint64_t marketThreshold = toThreshold(config.marketOrderRatio);
+    const std::uint64_t iocThreshold = toThreshold(config.marketOrderRatio + limitRatio * config.iocRatio);
+    const std::uint64_t fokThreshold = toThreshold(config.marketOrderRatio + limitRatio * (config.iocRatio + config.fokRatio));
+    const std::uint64_t addThreshold = toThreshold(config.addRatio);
+    const std::uint64_t cancelThreshold = toThreshold(config.addRatio + config.cancelRatio);
+    const double priceExponent = -1.0 / config.priceAlpha;
+    const double sizeExponent = -1.0 / config.sizeAlpha;
+    const double reference = config.referencePrice;
+    // Clamp into the configured widths, but no higher than 32 bits: 2^64 - 1 has no exact double and converting
+    // a double at or above 2^64 is undefined
+    constexpr double MAX_PRICE = std::min<double>(std::numeric_limits<Price>::max(), 4294967295.0);
+    constexpr double MAX_QUANTITY = std::min<double>(std::numeric_limits<Quantity>::max(), 4294967295.0);
+
+    double transitionU[BLOCK_SIZE];
+    double priceU[BLOCK_SIZE];
+    double sizeU[BLOCK_SIZE];
+    std::uint32_t sideBits[BLOCK_SIZE];
+    std::uint32_t typeBits[BLOCK_SIZE];
+    std::uint32_t actionBits[BLOCK_SIZE];
+    std::uint8_t states[BLOCK_SIZE];
+    double offsets[BLOCK_SIZE];
+
+    std::uint8_t state = static_cast<std::uint8_t>(MarketState::NEUTRAL);
+    for (std::size_t begin = first; begin < last; begin += BLOCK_SIZE) {
+        const std::size_t n = std::min(BLOCK_SIZE, last - begin);
+
+        // Draw every uniform of the block first, splitting 64-bit draws where 32 bits are enough
+        for (std::size_t i = 0; i < n; i++) {
+            transitionU[i] = rng.nextDouble();
+            priceU[i] = rng.nextDouble();
+            sizeU[i] = rng.nextDouble();
+            const std::uint64_t bits = rng();
+            sideBits[i] = static_cast<std::uint32_t>(bits >> 32);
+            typeBits[i] = static_cast<std::uint32_t>(bits);
+            const std::uint64_t moreBits = rng();
+            actionBits[i] = static_cast<std::uint32_t>(moreBits >> 32);
+            out.pick[begin + i] = static_cast<std::uint32_t>(moreBits);
+        }
+
+        // The Markov chain is the only sequential transform, one table row lookup and two compares per step
+        for (std::size_t i = 0; i < n; i++) {
+            const std::array<double, 3>& row = cumulative[state];
+            state = static_cast<std::uint8_t>((transitionU[i] >= row[0]) + (transitionU[i] >= row[1]));
+            states[i] = state;
+        }
+
+        for (std::size_t i = 0; i < n; i++) {
+            out.side[begin + i] = sideBits[i] < buyThreshold[states[i]] ? Side::BUY : Side::SELL;
+            out.action[begin + i] = actionBits[i] < addThreshold ? CommandType::ADD
+                                  : actionBits[i] < cancelThreshold ? CommandType::CANCEL : CommandType::MODIFY;
+            out.type[begin + i] = typeBits[i] < marketThreshold ? OrderType::MARKET
+                                : typeBits[i] < iocThreshold ? OrderType::IOC
+                                : typeBits[i] < fokThreshold ? OrderType::FOK : OrderType::LIMIT;
+        }
+
+        // Pareto inverse transform xMin * u^(-1/alpha), written as exp(log(u) * -1/alpha). This file is built with
+        // -ffast-math, which lets GCC call the SIMD log and exp of glibc's libmvec for whole vectors of u
+        for (std::size_t i = 0; i < n; i++) {
+            offsets[i] = std::floor(config.priceXMin * std::exp(std::log(priceU[i]) * priceExponent) + 0.5);
+        }
+        for (std::size_t i = 0; i < n; i++) {
+            const double limit = out.side[begin + i] == Side::BUY ? reference - offsets[i] : reference + offsets[i];
+            const double price = typeBits[i] < marketThreshold ? reference : limit;
+            out.price[begin + i] = static_cast<Price>(std::clamp(price, 1.0, MAX_PRICE)); // keep the price positive
+        }
+        for (std::size_t i = 0; i < n; i++) {
+            const double size = std::floor(config.sizeXMin * std::exp(std::log(sizeU[i]) * sizeExponent) + 0.5);
+            out.qty[begin + i] = static_cast<Quantity>(std::min(size, MAX_QUANTITY));
+        }
+    }
+}
+
+void BulkOrderGenerator::generate(OrderColumns& out, const std::size_t rows, const std::size_t threads) const {
+    out.resize(rows);
+    const std::size_t chunks = (rows + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    const std::size_t workers = std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(chunks, 1));
+
+    // Chunks are dealt round robin, the calling thread takes its share too
+    const auto work = [&](const std::size_t worker) {
+        for (std::size_t chunk = worker; chunk < chunks; chunk += workers) {
+            generateChunk(out, chunk);
+        }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (std::size_t worker = 1; worker < workers; worker++) {
+        pool.emplace_back(work, worker);
+    }
+    work(0);
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "MarkovParetoOrderGenerator.h"
+#include "Engine/EngineCommand.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Shape of the flow produced by the bulk generator, with the same defaults as the benchmarks
+ */
+struct GeneratorConfig {
+    std::uint64_t seed = 42; // the same seed always yields the same flow, whatever the number of threads
+    Price referencePrice = 10000; // $100.00
+    double marketOrderRatio = 0.2; // share of MARKET orders, their price column holds the reference price
+    double iocRatio = 0.1; // share of IOC orders among the limit-priced ones
+    double fokRatio = 0.02; // share of FOK orders among the limit-priced ones
+    double priceXMin = 1.0; // Pareto minimum of the tick offset from the reference price
+    double priceAlpha = 2.5;
+    double sizeXMin = 10.0; // Pareto minimum of the order size
+    double sizeAlpha = 1.7;
+    double addRatio = 1.0; // share of ADD rows
+    double cancelRatio = 0.0; // share of CANCEL rows, the remaining rows are MODIFY
+};
+
+/**
+ * @brief Generated flow stored column by column. Row i of every column describes the same command, and the
+ * order type only applies to ADD rows. CANCEL and MODIFY rows do not name an order: the consumer picks the
+ * target among its resting orders of the row's side with the pick column, so the columns can be generated
+ * in parallel.
+ */
+struct OrderColumns {
+    std::vector<CommandType> action;
+    std::vector<Side> side;
+    std::vector<OrderType> type;
+    std::vector<Price> price;
+    std::vector<Quantity> qty;
+    std::vector<std::uint32_t> pick; // uniform random value for choosing the target of a CANCEL or MODIFY
+
+    /**
+     * @brief Resizes every column
+     *
+     * @param rows The number of rows
+     */
+    void resize(std::size_t rows);
+    /**
+     * @brief Retrieves the number of rows
+     *
+     * @return The number of rows
+     */
+    std::size_t size() const { return action.size(); }
+};
+
+/**
+ * @brief Generates the Markov/Pareto flow of OrderGenerator in bulk. The flow is cut into fixed-size chunks,
+ * and each chunk draws from its own xoshiro256++ stream seeded from (seed, chunk index) and restarts the
+ * Markov chain in the neutral state, so chunks can be generated by any number of threads and the output only
+ * depends on the seed. Within a chunk, uniforms are drawn into blocks first and transformed by branch-free
+ * loops the compiler vectorizes, including the log/exp of the Pareto inverse transform.
+ */
+class BulkOrderGenerator {
+private:
+    static constexpr std::size_t CHUNK_SIZE = 1 << 16; // rows per stream, part of the output definition
+    static constexpr std::size_t BLOCK_SIZE = 512; // rows transformed per vectorized pass
+
+    std::array<std::array<double, 3>, 3> cumulative; // cumulative transition probabilities per state
+    GeneratorConfig config;
+
+    /**
+     * @brief Generates one chunk of rows from the stream of the chunk
+     *
+     * @param out The columns, already sized for the whole flow
+     * @param chunk The index of the chunk
+     */
+    void generateChunk(OrderColumns& out, std::size_t chunk) const;
+
+public:
+    /**
+     * @brief Constructs a bulk generator, precomputing the cumulative rows of the transition matrix
+     *
+     * @param transitionMatrix The 3x3 Markov transition matrix indexed by MarketState
+     * @param config The seed and the shape of the flow
+     */
+    explicit BulkOrderGenerator(const TransitionMatrix& transitionMatrix, const GeneratorConfig& config = {});
+
+    /**
+     * @brief Generates a flow into columns, resizing them to the number of rows
+     *
+     * @param out The columns receiving the flow
+     * @param rows The number of rows to generate
+     * @param threads The number of threads generating chunks, which does not change the output
+     */
+    void generate(OrderColumns& out, std::size_t rows, std::size_t threads = 1) const;
+};
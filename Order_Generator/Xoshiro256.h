@@ -0,0 +1,78 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief xoshiro256++ pseudo random number generator. Four words of state and a few shifts and
+ * rotations per draw, several times faster than std::mt19937 with a 2^256 - 1 period. Satisfies
+ * UniformRandomBitGenerator, so it also works with the standard distributions.
+ */
+class Xoshiro256 {
+private:
+    std::uint64_t s[4];
+
+    /**
+     * @brief One step of SplitMix64, used to expand a seed into a well mixed state
+     *
+     * @param x The SplitMix64 state, advanced in place
+     *
+     * @return The next SplitMix64 output
+     */
+    static constexpr std::uint64_t splitMix64(std::uint64_t& x) {
+        std::uint64_t z = (x += 0x9E3779B97F4A7C15);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        return z ^ (z >> 31);
+    }
+
+public:
+    using result_type = std::uint64_t;
+
+    /**
+     * @brief Seeds one stream of a seed. Streams are started at unrelated points of the SplitMix64 sequence
+     * hashed from the seed and the stream index, so the same (seed, stream) pair always yields the same numbers
+     * and different streams can be drawn from concurrently without sharing state.
+     *
+     * @param seed The seed
+     * @param stream The index of the stream
+     */
+    explicit constexpr Xoshiro256(const std::uint64_t seed, const std::uint64_t stream = 0): s{} {
+        std::uint64_t mix = seed;
+        std::uint64_t x = splitMix64(mix);
+        mix = stream ^ 0xD1B54A32D192ED03;
+        x ^= splitMix64(mix);
+        for (std::uint64_t& word : s) {
+            word = splitMix64(x);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    /**
+     * @brief Draws the next 64 random bits
+     *
+     * @return The random bits
+     */
+    constexpr result_type operator()() {
+        const std::uint64_t result = std::rotl(s[0] + s[3], 23) + s[0];
+        const std::uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = std::rotl(s[3], 45);
+        return result;
+    }
+
+    /**
+     * @brief Draws a uniform double in the open interval (0, 1), so it can be passed to log without a zero check
+     *
+     * @return The uniform double
+     */
+    constexpr double nextDouble() {
+        return (static_cast<double>((*this)() >> 11) + 0.5) * 0x1.0p-53;
+    }
+};
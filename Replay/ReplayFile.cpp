@@ -0,0 +1,155 @@
+#include "ReplayFile.h"
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+/**
+ * @brief On-disk header in front of the records of a binary replay file
+ */
+struct ReplayHeader {
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint64_t recordCount;
+    std::uint64_t reserved;
+};
+
+Command ReplayRecord::toCommand() const {
+    Command cmd{};
+    cmd.type = static_cast<CommandType>(type);
+    cmd.symbol = symbol;
+    cmd.idNumber = idNumber;
+    cmd.side = static_cast<Side>(side);
+    cmd.price = price;
+    cmd.qty = qty;
+    cmd.orderType = static_cast<OrderType>(orderType);
+    return cmd;
+}
+
+void writeReplayFile(const std::string& path, const std::span<const ReplayRecord> records) {
+    MappedFile file(path, sizeof(ReplayHeader) + records.size_bytes());
+    const ReplayHeader header = {ReplaySource::MAGIC, 1, sizeof(ReplayRecord), records.size(), 0};
+    std::memcpy(file.data(), &header, sizeof(header));
+    if (!records.empty()) {
+        std::memcpy(file.data() + sizeof(header), records.data(), records.size_bytes());
+    }
+    file.sync();
+}
+
+ReplaySource::ReplaySource(const std::string& path):
+    file(path),
+    binary(false),
+    records(nullptr),
+    recordCount(0),
+    nextRecord(0),
+    cursor(nullptr),
+    end(nullptr),
+    malformedLines(0)
+{
+    ReplayHeader header{};
+    if (file.size() >= sizeof(header)) {
+        std::memcpy(&header, file.data(), sizeof(header));
+    }
+    binary = header.magic == MAGIC;
+    if (binary) {
+        if (header.recordSize != sizeof(ReplayRecord) || file.size() < sizeof(header) + header.recordCount * sizeof(ReplayRecord)) {
+            throw std::runtime_error("Replay file ('" + path + "') is truncated or of another format");
+        }
+        records = reinterpret_cast<const ReplayRecord*>(file.data() + sizeof(header));
+        recordCount = header.recordCount;
+    }
+    rewind();
+}
+
+void ReplaySource::rewind() {
+    nextRecord = 0;
+    cursor = reinterpret_cast<const char*>(file.data());
+    end = cursor + file.size();
+    malformedLines = 0;
+}
+
+bool ReplaySource::next(ReplayRecord& out) {
+    if (!binary) { return nextCsv(out); }
+    if (nextRecord == recordCount) { return false; }
+    out = records[nextRecord++];
+    return true;
+}
+
+/**
+ * @brief Splits the next comma separated field off a line
+ * @param line Remainder of the line, advanced past the field and its comma
+ * @return The field
+ */
+static std::string_view nextField(std::string_view& line) {
+    const std::size_t comma = line.find(',');
+    const std::string_view field = line.substr(0, comma);
+    line.remove_prefix(comma == std::string_view::npos ? line.size() : comma + 1);
+    return field;
+}
+
+/**
+ * @brief Parses an unsigned number filling a whole field
+ * @param field Field to parse, empty fields parse as 0
+ * @param out Receives the number
+ * @return If the field was a number
+ */
+template<typename T>
+static bool parseNumber(const std::string_view field, T& out) {
+    if (field.empty()) { out = 0; return true; }
+    const auto [ptr, error] = std::from_chars(field.data(), field.data() + field.size(), out);
+    return error == std::errc() && ptr == field.data() + field.size();
+}
+
+bool ReplaySource::nextCsv(ReplayRecord& out) {
+    while (cursor < end) {
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<std::size_t>(end - cursor)));
+        const char* lineEnd = newline ? newline : end;
+        std::string_view line(cursor, static_cast<std::size_t>(lineEnd - cursor));
+        cursor = newline ? newline + 1 : end;
+        if (!line.empty() && line.back() == '\r') { line.remove_suffix(1); }
+        if (line.empty() || line.front() < '0' || line.front() > '9') { continue; } // blank line or header
+
+        out = {};
+        const std::string_view timestamp = nextField(line);
+        const std::string_view type = nextField(line);
+        const std::string_view symbol = nextField(line);
+        const std::string_view id = nextField(line);
+        const std::string_view side = nextField(line);
+        const std::string_view price = nextField(line);
+        const std::string_view qty = nextField(line);
+        const std::string_view orderType = nextField(line); // optional, LIMIT when missing
+
+        bool valid = parseNumber(timestamp, out.timestamp) && parseNumber(symbol, out.symbol) && parseNumber(id, out.idNumber) &&
+                     parseNumber(price, out.price) && parseNumber(qty, out.qty) && !type.empty();
+        if (valid) {
+            switch (type.front()) {
+                case 'A': out.type = static_cast<std::uint8_t>(CommandType::ADD); break;
+                case 'M': out.type = static_cast<std::uint8_t>(CommandType::MODIFY); break;
+                case 'C': out.type = static_cast<std::uint8_t>(CommandType::CANCEL); break;
+                default: valid = false;
+            }
+        }
+        if (valid && !orderType.empty()) {
+            switch (orderType.front()) {
+                case 'L': out.orderType = static_cast<std::uint8_t>(OrderType::LIMIT); break;
+                case 'I': out.orderType = static_cast<std::uint8_t>(OrderType::IOC); break;
+                case 'F': out.orderType = static_cast<std::uint8_t>(OrderType::FOK); break;
+                case 'M': out.orderType = static_cast<std::uint8_t>(OrderType::MARKET); break;
+                default: valid = false;
+            }
+        }
+        if (valid && !side.empty()) {
+            if (side.front() == 'B') { out.side = static_cast<std::uint8_t>(Side::BUY); }
+            else if (side.front() == 'S') { out.side = static_cast<std::uint8_t>(Side::SELL); }
+            else { valid = false; }
+        }
+        if (valid) { return true; }
+        malformedLines++;
+    }
+    return false;
+}
+
+bool ReplaySource::isBinary() const { return binary; }
+
+std::size_t ReplaySource::getMalformedLines() const { return malformedLines; }
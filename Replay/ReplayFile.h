@@ -0,0 +1,95 @@
+#pragma once
+#include "Engine/EngineCommand.h"
+#include "Engine/MappedFile.h"
+#include <cstdint>
+#include <span>
+#include <string>
+
+/**
+ * @brief Fixed-size record of a recorded command, the unit of binary replay files
+ */
+struct ReplayRecord {
+    std::uint64_t timestamp; // nanoseconds, any epoch, non-decreasing through the file
+    IdNumber idNumber;
+    SymbolId symbol;
+    WirePrice price;
+    WireQuantity qty;
+    std::uint8_t type; // CommandType
+    std::uint8_t side; // Side
+    std::uint8_t orderType; // OrderType
+    std::uint8_t reserved;
+
+    /**
+     * @brief Builds the command to submit for this record
+     * @return The command, without a sequence number
+     */
+    Command toCommand() const;
+};
+
+static_assert(sizeof(ReplayRecord) == 32 || sizeof(WirePrice) + sizeof(WireQuantity) > 8, "replay records must keep a fixed on-disk layout");
+
+/**
+ * @brief Writes a binary replay file
+ * @param path Path of the file, replaced if it exists
+ * @param records Records in timestamp order
+ */
+void writeReplayFile(const std::string& path, std::span<const ReplayRecord> records);
+
+/**
+ * @brief Recorded command flow read straight out of a memory-mapped file. Binary files are read in place;
+ * CSV files (timestamp,type,symbol,id,side,price,qty[,order_type] per line) are parsed from the mapping without copying
+ * lines or allocating. The format is detected from the file header.
+ */
+class ReplaySource {
+private:
+    static constexpr std::uint64_t MAGIC = 0x31594C5052424F4C; // "LOBRPLY1"
+
+    MappedFile file;
+    bool binary;
+    const ReplayRecord* records; // binary files
+    std::size_t recordCount;
+    std::size_t nextRecord;
+    const char* cursor; // CSV files
+    const char* end;
+    std::size_t malformedLines;
+
+    friend void writeReplayFile(const std::string& path, std::span<const ReplayRecord> records);
+
+    /**
+     * @brief Parses the next well-formed CSV line, skipping the header, blank and malformed lines
+     * @param out Receives the record
+     * @return If a record was parsed before the end of the file
+     */
+    bool nextCsv(ReplayRecord& out);
+
+public:
+    /**
+     * @brief Maps a binary or CSV replay file read-only. Throws std::runtime_error if a binary file is truncated.
+     * @param path Path of the file
+     */
+    explicit ReplaySource(const std::string& path);
+
+    /**
+     * @brief Reads the next record
+     * @param out Receives the record
+     * @return If there was a record left
+     */
+    bool next(ReplayRecord& out);
+
+    /**
+     * @brief Starts reading from the first record again
+     */
+    void rewind();
+
+    /**
+     * @brief Retrieves if the file is a binary replay file
+     * @return True for binary files, false for CSV
+     */
+    bool isBinary() const;
+
+    /**
+     * @brief Retrieves the number of CSV lines skipped because they could not be parsed
+     * @return The number of malformed lines
+     */
+    std::size_t getMalformedLines() const;
+};
@@ -0,0 +1,109 @@
+#include "Replayer.h"
+#include "SyntheticFlow.h"
+#include "Engine/Engine.h"
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Prints the command line usage
+ */
+static void printUsage() {
+    std::cerr << "Usage:\n"
+              << "  Replay <file> [--pace asap|recorded] [--speed N] [--engine mutex|ladder|spsc|mpsc]\n"
+              << "      Replays a binary or CSV (timestamp,type,symbol,id,side,price,qty[,order_type]) command file through the engine\n"
+              << "  Replay --generate <count> <file> [--rate ordersPerSecond]\n"
+              << "      Records a synthetic add/cancel/modify flow to a binary replay file\n";
+}
+
+/**
+ * @brief Records a synthetic flow to a binary replay file
+ * @param count Number of commands
+ * @param path Path of the binary replay file
+ * @param rate Average commands per second
+ */
+static void generate(const std::size_t count, const std::string& path, const double rate) {
+    const std::vector<ReplayRecord> records = generateSyntheticFlow(count, rate);
+    writeReplayFile(path, records);
+    const double span = records.empty() ? 0.0 : static_cast<double>(records.back().timestamp) / 1e9;
+    std::cout << "Recorded " << count << " commands spanning " << span << " seconds to " << path << "\n";
+}
+
+/**
+ * @brief Prints the percentiles of a latency histogram
+ * @param name Label of the histogram
+ * @param histogram Histogram to print
+ */
+static void printHistogram(const char* name, const LatencyHistogram& histogram) {
+    if (histogram.count() == 0) { return; }
+    std::cout << "  " << name << ": p50 " << histogram.percentile(50.0) << ", p99 " << histogram.percentile(99.0)
+              << ", p99.9 " << histogram.percentile(99.9) << ", max " << histogram.max() << " (" << histogram.count() << " samples)\n";
+}
+
+/**
+ * @brief Replays a file through a fresh engine and prints throughput and latency
+ * @param source The recorded commands
+ * @param config The pacing of the run
+ */
+template<typename EngineType>
+static void run(ReplaySource& source, const ReplayConfig& config) {
+    EngineType eng;
+    eng.enableMetrics(true);
+    eng.start();
+    ReplayStats stats;
+    replay(source, eng, config, stats);
+    eng.stop();
+
+    const EngineMetrics& metrics = eng.getMetrics();
+    const EngineCounters counters = eng.getCounters();
+    std::cout << "Replayed " << stats.commands << " commands in " << stats.elapsedSeconds << " seconds, "
+              << stats.commands / stats.elapsedSeconds << " commands/sec\n";
+    if (!source.isBinary()) {
+        std::cout << "  Malformed CSV lines skipped: " << source.getMalformedLines() << "\n";
+    }
+    if (stats.outOfOrder > 0) {
+        std::cout << "  Records out of timestamp order, submitted immediately: " << stats.outOfOrder << "\n";
+    }
+    printHistogram("Pacing lag (ns)", stats.paceLag);
+    printHistogram("Queue delay (ns)", metrics.queueDelay);
+    printHistogram("Add apply (ns)", metrics.addTime);
+    printHistogram("Modify apply (ns)", metrics.modifyTime);
+    printHistogram("Cancel apply (ns)", metrics.cancelTime);
+    printHistogram("Match pass (ns)", metrics.matchTime);
+    std::cout << "  Rejected: " << counters.rejected << ", trades: " << counters.trades << ", queue high-water: " << counters.queueHighWater << "\n";
+}
+
+int main(const int argc, char** argv) {
+    if (argc >= 4 && std::strcmp(argv[1], "--generate") == 0) {
+        double rate = 1e6;
+        if (argc >= 6 && std::strcmp(argv[4], "--rate") == 0) { rate = std::stod(argv[5]); }
+        generate(std::stoull(argv[2]), argv[3], rate);
+        return 0;
+    }
+    if (argc < 2 || argv[1][0] == '-') {
+        printUsage();
+        return 1;
+    }
+
+    ReplayConfig config;
+    std::string engine = "spsc";
+    for (int i = 2; i + 1 < argc; i += 2) {
+        const std::string option = argv[i];
+        const std::string value = argv[i + 1];
+        if (option == "--pace") { config.pacing = (value == "recorded") ? Pacing::RECORDED : Pacing::AS_FAST_AS_POSSIBLE; }
+        else if (option == "--speed") { config.pacing = Pacing::RECORDED; config.speed = std::stod(value); }
+        else if (option == "--engine") { engine = value; }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    ReplaySource source(argv[1]);
+    if (engine == "mutex") { run<Engine>(source, config); }
+    else if (engine == "ladder") { run<LadderEngine>(source, config); }
+    else if (engine == "mpsc") { run<MpscEngine>(source, config); }
+    else { run<SpscEngine>(source, config); }
+    return 0;
+}
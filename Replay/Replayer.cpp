@@ -0,0 +1,59 @@
+#include "Replayer.h"
+#include "Engine/Backoff.h"
+#include "Engine/Engine.h"
+#include <chrono>
+#include <thread>
+
+template<typename EngineType>
+void replay(ReplaySource& source, EngineType& eng, const ReplayConfig& config, ReplayStats& stats) {
+    using Clock = std::chrono::steady_clock;
+    const bool paced = config.pacing == Pacing::RECORDED && config.speed > 0.0;
+
+    stats.commands = 0;
+    stats.outOfOrder = 0;
+    stats.lastSeqNum = 0;
+    const Clock::time_point start = Clock::now();
+    std::uint64_t firstTimestamp = 0;
+    std::uint64_t latestTimestamp = 0;
+
+    ReplayRecord record{};
+    while (source.next(record)) {
+        // A timestamp that goes backwards keeps the schedule at the latest one, so the record is due at once
+        if (stats.commands == 0) { firstTimestamp = latestTimestamp = record.timestamp; }
+        if (record.timestamp < latestTimestamp) {
+            stats.outOfOrder++;
+        }
+        else {
+            latestTimestamp = record.timestamp;
+        }
+        if (paced) {
+            const auto offset = std::chrono::nanoseconds(static_cast<std::int64_t>(
+                static_cast<double>(latestTimestamp - firstTimestamp) / config.speed));
+            const Clock::time_point due = start + offset;
+            // Sleep through long gaps, then spin so the submit lands close to its due time
+            Clock::time_point now = Clock::now();
+            if (due - now > std::chrono::microseconds(200)) {
+                std::this_thread::sleep_until(due - std::chrono::microseconds(100));
+                now = Clock::now();
+            }
+            while (now < due) {
+                cpuRelax();
+                now = Clock::now();
+            }
+            stats.paceLag.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count()));
+        }
+        stats.lastSeqNum = eng.submit(record.toCommand());
+        stats.commands++;
+    }
+
+    Backoff backoff;
+    while (eng.lastProcessed() < stats.lastSeqNum) {
+        backoff.pause();
+    }
+    stats.elapsedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+template void replay<Engine>(ReplaySource&, Engine&, const ReplayConfig&, ReplayStats&);
+template void replay<LadderEngine>(ReplaySource&, LadderEngine&, const ReplayConfig&, ReplayStats&);
+template void replay<SpscEngine>(ReplaySource&, SpscEngine&, const ReplayConfig&, ReplayStats&);
+template void replay<MpscEngine>(ReplaySource&, MpscEngine&, const ReplayConfig&, ReplayStats&);
@@ -0,0 +1,44 @@
+#pragma once
+#include "ReplayFile.h"
+#include "Engine/LatencyHistogram.h"
+#include <cstdint>
+
+/**
+ * @brief How recorded commands are spaced out when they are submitted
+ */
+enum class Pacing {
+    AS_FAST_AS_POSSIBLE, // submit back to back, the queue's back-pressure is the only limit
+    RECORDED // keep the recorded gaps between timestamps, divided by ReplayConfig::speed
+};
+
+/**
+ * @brief Configuration of a replay run
+ */
+struct ReplayConfig {
+    Pacing pacing = Pacing::AS_FAST_AS_POSSIBLE;
+    double speed = 1.0; // RECORDED: 1 replays at the original rate, 10 at ten times the original rate
+};
+
+/**
+ * @brief Outcome of a replay run
+ */
+struct ReplayStats {
+    std::uint64_t commands; // commands submitted
+    std::uint64_t outOfOrder; // records timestamped before an earlier record, submitted without waiting
+    SeqNum lastSeqNum; // sequence number of the last submitted command
+    double elapsedSeconds; // from the first submit until the engine applied the last command
+    LatencyHistogram paceLag; // RECORDED: how late each submit was against its schedule (ns)
+};
+
+/**
+ * @brief Streams every record of a replay source through Engine::submit with the configured pacing and
+ * waits until the engine has applied the last command. The engine must be running.
+ *
+ * @tparam EngineType The engine type (Engine, LadderEngine, SpscEngine or MpscEngine)
+ * @param source The recorded commands
+ * @param eng The engine receiving the commands
+ * @param config The pacing of the run
+ * @param stats Receives the counts, the elapsed time and the pacing lag
+ */
+template<typename EngineType>
+void replay(ReplaySource& source, EngineType& eng, const ReplayConfig& config, ReplayStats& stats);
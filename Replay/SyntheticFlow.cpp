@@ -0,0 +1,52 @@
+#include "SyntheticFlow.h"
+#include "Order_Generator/BulkOrderGenerator.h"
+#include "Order_Generator/Xoshiro256.h"
+#include <cmath>
+#include <thread>
+
+std::vector<ReplayRecord> generateSyntheticFlow(const std::size_t count, const double rate, const std::uint32_t seed) {
+    TransitionMatrix matrix = {
+        {0.80, 0.10, 0.10}, // Neutral
+        {0.10, 0.85, 0.05}, // Buy Pressure
+        {0.10, 0.05, 0.85} // Sell Pressure
+    };
+    const BulkOrderGenerator generator(matrix, {.seed = seed, .addRatio = 0.6, .cancelRatio = 0.2});
+    OrderColumns columns;
+    generator.generate(columns, count, std::thread::hardware_concurrency());
+
+    // Exponential gaps between arrivals come from a stream of their own
+    Xoshiro256 gapRng(seed, UINT64_MAX);
+    const double meanGap = 1e9 / rate;
+
+    // Cancels and modifies target a random resting order of their side, and turn into adds while that side is empty
+    std::vector<IdNumber> active[2];
+    std::vector<ReplayRecord> records(count);
+    double timestamp = 0.0;
+    for (std::size_t i = 0; i < count; i++) {
+        timestamp -= std::log(gapRng.nextDouble()) * meanGap;
+        ReplayRecord& record = records[i];
+        record = {};
+        record.timestamp = static_cast<std::uint64_t>(timestamp);
+        record.type = static_cast<std::uint8_t>(columns.action[i]);
+        record.side = static_cast<std::uint8_t>(columns.side[i]);
+        std::vector<IdNumber>& resting = active[record.side];
+        if (columns.action[i] == CommandType::ADD || resting.empty()) {
+            record.type = static_cast<std::uint8_t>(CommandType::ADD);
+            record.idNumber = i;
+            record.orderType = static_cast<std::uint8_t>(columns.type[i]);
+            if (columns.type[i] == OrderType::LIMIT) { resting.push_back(i); } // the other types never rest
+        }
+        else {
+            const std::size_t index = (static_cast<std::uint64_t>(columns.pick[i]) * resting.size()) >> 32;
+            record.idNumber = resting[index];
+            if (columns.action[i] == CommandType::CANCEL) {
+                resting[index] = resting.back();
+                resting.pop_back();
+                continue;
+            }
+        }
+        record.price = columns.price[i];
+        record.qty = columns.qty[i];
+    }
+    return records;
+}
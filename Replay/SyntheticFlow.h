@@ -0,0 +1,17 @@
+#pragma once
+#include "ReplayFile.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Generates a timestamped add/cancel/modify flow with the same mix as the operations benchmark
+ * (60% adds from the Markov/Pareto generator, 20% cancels and 20% modifies of random resting orders on the side drawn for the row),
+ * with Poisson arrivals. Generating the flow up front keeps generator cost out of timed runs.
+ *
+ * @param count Number of commands
+ * @param rate Average commands per second, used for the timestamps
+ * @param seed Seed of the generator, the same seed always yields the same flow
+ *
+ * @return The commands in timestamp order
+ */
+std::vector<ReplayRecord> generateSyntheticFlow(std::size_t count, double rate = 1e6, std::uint32_t seed = 42);
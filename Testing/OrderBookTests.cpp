@@ -1,13 +1,108 @@
 #include "OrderBookTests.h"
 
-static void waitUntil(Engine& eng, SeqNum target) {
+template<typename EngineType>
+static void waitUntil(EngineType& eng, SeqNum target) {
+    Backoff backoff; // spin briefly before yielding, a yield per poll adds scheduler latency to short waits
     while (eng.lastProcessed() < target) {
-        std::this_thread::yield();
+        backoff.pause();
     }
 }
 
+/**
+ * @brief Pre-generates add orders with the bulk generator so a run only times the engine
+ */
+static std::vector<Command> generateOrders(const std::size_t numOrders, const std::uint64_t seed = 42) {
+    TransitionMatrix matrix = {
+        {0.80, 0.10, 0.10}, // Neutral
+        {0.10, 0.85, 0.05}, // Buy Pressure
+        {0.10, 0.05, 0.85} // Sell Pressure
+    };
+    const BulkOrderGenerator generator(matrix, {.seed = seed});
+    OrderColumns columns;
+    generator.generate(columns, numOrders, std::thread::hardware_concurrency());
+
+    std::vector<Command> commands(numOrders);
+    for (std::size_t i = 0; i < numOrders; i++) {
+        commands[i] = {CommandType::ADD};
+        commands[i].idNumber = i; commands[i].side = columns.side[i]; commands[i].orderType = columns.type[i];
+        commands[i].price = columns.price[i]; commands[i].qty = columns.qty[i];
+    }
+    return commands;
+}
+
+/**
+ * @brief Pre-generates the add/cancel/modify mix of benchmarkFiveMillionOperations so a run only times the engine
+ */
+static std::vector<Command> generateOperations(const std::size_t numOps, const double addRatio = 0.6, const double cancelRatio = 0.2,
+                                               const std::uint64_t seed = 42) {
+    TransitionMatrix matrix = {
+        {0.80, 0.10, 0.10}, // Neutral
+        {0.10, 0.85, 0.05}, // Buy Pressure
+        {0.10, 0.05, 0.85} // Sell Pressure
+    };
+    const BulkOrderGenerator generator(matrix, {.seed = seed, .addRatio = addRatio, .cancelRatio = cancelRatio});
+    OrderColumns columns;
+    generator.generate(columns, numOps, std::thread::hardware_concurrency());
+
+    // Cancels and modifies target a random resting order of their side, and turn into adds while that side is empty
+    std::vector<IdNumber> active[2];
+    std::vector<Command> commands(numOps);
+    for (std::size_t i = 0; i < numOps; i++) {
+        Command& c = commands[i];
+        c = {columns.action[i]};
+        c.side = columns.side[i];
+        std::vector<IdNumber>& resting = active[static_cast<int>(c.side)];
+        if (c.type == CommandType::ADD || resting.empty()) {
+            c.type = CommandType::ADD;
+            c.idNumber = i;
+            c.orderType = columns.type[i];
+            if (c.orderType == OrderType::LIMIT) { resting.push_back(i); } // the other types never rest
+        }
+        else {
+            const std::size_t index = (static_cast<std::uint64_t>(columns.pick[i]) * resting.size()) >> 32;
+            c.idNumber = resting[index];
+            if (c.type == CommandType::CANCEL) {
+                resting[index] = resting.back();
+                resting.pop_back();
+                continue;
+            }
+        }
+        c.price = columns.price[i]; c.qty = columns.qty[i];
+    }
+    return commands;
+}
+
+/**
+ * @brief Prints p50/p99/p99.9/max of every engine histogram and the engine counters
+ */
+static void printLatencyReport(const EngineMetrics& metrics, const EngineCounters& counters) {
+    const std::pair<const char*, const LatencyHistogram*> histograms[] = {
+        {"Queue delay (ns)", &metrics.queueDelay},
+        {"Add apply (ns)", &metrics.addTime},
+        {"Modify apply (ns)", &metrics.modifyTime},
+        {"Cancel apply (ns)", &metrics.cancelTime},
+        {"Match pass (ns)", &metrics.matchTime},
+        {"Fills per match", &metrics.fillsPerMatch}
+    };
+    for (const auto& [name, histogram] : histograms) {
+        if (histogram->count() == 0) { continue; }
+        std::cout << "  " << name << ": p50 " << histogram->percentile(50.0) << ", p99 " << histogram->percentile(99.0)
+                  << ", p99.9 " << histogram->percentile(99.9) << ", max " << histogram->max() << " (" << histogram->count() << " samples)\n";
+    }
+    std::cout << "  Rejected: " << counters.rejected << ", levels created: " << counters.levelsCreated << ", levels destroyed: " << counters.levelsDestroyed
+              << ", trades: " << counters.trades << ", queue high-water: " << counters.queueHighWater << "\n";
+}
+
+/**
+ * @brief Engine whose book matches aggressive orders on arrival
+ */
+struct ContinuousEngine : Engine {
+    ContinuousEngine(): Engine(1 << 16, BookConfig{.matchingMode = MatchingMode::CONTINUOUS}) {}
+};
+
+template<typename EngineType>
 void completeFillTest() {
-    Engine eng;
+    EngineType eng;
     eng.start();
 
     Command c1 = {CommandType::ADD};
@@ -21,7 +116,7 @@ void completeFillTest() {
     waitUntil(eng, lastSeqNum);
     eng.stop();
 
-    const OrderBook& book = eng.getBook();
+    const auto& book = eng.getBook();
 
     assert(!book.contains(1) && "order1 should be removed from the order book");
     assert(!book.contains(2) && "order2 should be removed from the order book");
@@ -29,8 +124,9 @@ void completeFillTest() {
     std::cout << "completeFillTest() passed!\n";
 }
 
+template<typename EngineType>
 void partialFillTest() {
-    Engine eng;
+    EngineType eng;
     eng.start();
 
     Command c1 = {CommandType::ADD};
@@ -44,18 +140,19 @@ void partialFillTest() {
     waitUntil(eng, lastSeqNum);
     eng.stop();
 
-    const OrderBook& book = eng.getBook();
-    OrderPointer order1 = book.getOrderByID(1);
+    const auto& book = eng.getBook();
+    const Order& order1 = book.getOrderByID(1);
 
     assert(book.contains(1) && "order1 should be in the order book");
-    assert(order1->getRemainingQuantity() == 5 && "order1 should have 5 remaining");
+    assert(order1.getRemainingQuantity() == 5 && "order1 should have 5 remaining");
     assert(!book.contains(2) && "order2 should be removed from the order book");
 
     std::cout << "partialFillTest() passed!\n";
 }
 
+template<typename EngineType>
 void multiplePriceLevelTest() {
-    Engine eng;
+    EngineType eng;
     eng.start();
 
     for (int i = 0; i < 100; i++) {
@@ -75,18 +172,19 @@ void multiplePriceLevelTest() {
     waitUntil(eng, lastSeqNum);
     eng.stop();
 
-    const OrderBook& book = eng.getBook();
-    OrderPointer secondHighestPriorityBuyOrder = book.getOrderByID(91);
+    const auto& book = eng.getBook();
+    const Order& secondHighestPriorityBuyOrder = book.getOrderByID(91);
 
     assert(!book.contains(90) && "highestPriorityBuyOrder should be removed from the order book");
-    assert(secondHighestPriorityBuyOrder->getRemainingQuantity() == 5 && "secondHighestPriorityBuyOrder should have 5 remaining");
+    assert(secondHighestPriorityBuyOrder.getRemainingQuantity() == 5 && "secondHighestPriorityBuyOrder should have 5 remaining");
     assert(!book.contains(101) && "sellOrder2 should be removed from the order book");
 
     std::cout << "multiplePriceLevelTest() passed!\n";
 }
 
+template<typename EngineType>
 void timePriorityMatchingTest() {
-    Engine eng;
+    EngineType eng;
     eng.start();
 
     Command c1 = {CommandType::ADD};
@@ -104,19 +202,20 @@ void timePriorityMatchingTest() {
     waitUntil(eng, lastSeqNum);
     eng.stop();
 
-    const OrderBook& book = eng.getBook();
-    OrderPointer order2 = book.getOrderByID(2);
+    const auto& book = eng.getBook();
+    const Order& order2 = book.getOrderByID(2);
 
     assert(!book.contains(1) && "order1 should be removed from the order book");
     assert(book.contains(2) && "order2 should be in the order book");
-    assert(order2->getRemainingQuantity() == 3 && "order2 should have 3 remaining");
+    assert(order2.getRemainingQuantity() == 3 && "order2 should have 3 remaining");
     assert(!book.contains(3) && "order3 should be removed from the order book");
 
     std::cout << "timePriorityMatchingTest() passed!\n";
 }
 
+template<typename EngineType>
 void modifyValidOrderTest() {
-    Engine eng;
+    EngineType eng;
     eng.start();
 
     Command c1 = {CommandType::ADD};
@@ -138,18 +237,150 @@ void modifyValidOrderTest() {
     waitUntil(eng, lastSeqNum);
     eng.stop();
 
-    const OrderBook& book = eng.getBook();
-    OrderPointer modifiedOrder1 = book.getOrderByID(1);
+    const auto& book = eng.getBook();
+    const Order& modifiedOrder1 = book.getOrderByID(1);
 
-    assert(modifiedOrder1->getPrice() == 5000 && "order1 should have a price of 5000");
-    assert(modifiedOrder1->getRemainingQuantity() == 10 && "order1 should have 10 remaining");
+    assert(modifiedOrder1.getPrice() == 5000 && "order1 should have a price of 5000");
+    assert(modifiedOrder1.getRemainingQuantity() == 10 && "order1 should have 10 remaining");
     assert(!book.contains(2) && "order2 should be removed from the order book");
 
     std::cout << "modifyValidOrderTest() passed!\n";
 }
 
+template<typename BookType>
+void modifyReduceTest() {
+    BookType book(BookConfig{.matchingMode = MatchingMode::CONTINUOUS});
+
+    book.addOrder(1, Side::BUY, 10000, 10);
+    book.addOrder(2, Side::BUY, 10000, 10);
+    const Order* reduced = book.modifyOrder(1, 10000, 4).order;
+    assert(reduced == book.findOrder(1) && reduced->getRemainingQuantity() == 4 && reduced->getInitialQuantity() == 4
+           && reduced->getStatus() == Status::PENDING && "a size-down should update the order in place");
+    assert(book.getLevel(Side::BUY, 10000).quantity == 14 && book.getLevel(Side::BUY, 10000).orderCount == 2
+           && "the level aggregate should follow the size-down");
+
+    // order1 kept its place at the front of the level
+    book.addOrder(3, Side::SELL, 10000, 4);
+    assert(!book.contains(1) && book.getOrderByID(2).getRemainingQuantity() == 10 && "the reduced order should keep its time priority");
+
+    // A size-up loses priority, a price change moves the order to its new level
+    book.addOrder(4, Side::BUY, 10000, 5);
+    book.modifyOrder(2, 10000, 15);
+    book.addOrder(5, Side::SELL, 10000, 5);
+    assert(!book.contains(4) && book.getOrderByID(2).getRemainingQuantity() == 15 && "a size-up should requeue the order");
+    book.modifyOrder(2, 9999, 15);
+    assert(book.getLevel(Side::BUY, 10000).quantity == 0 && book.getLevel(Side::BUY, 9999).quantity == 15
+           && "a price change should move the order to its new level");
+
+    // Partially filled orders can no longer be modified
+    book.addOrder(6, Side::SELL, 9999, 5);
+    assert(book.modifyOrder(2, 9999, 5).reject == RejectReason::NOT_PENDING && "a partially filled order should be rejected");
+
+    std::cout << "modifyReduceTest() passed!\n";
+}
+
+template<typename BookType>
+void orderTypesTest() {
+    BookType book({100, 256}); // the ladder covers prices 100 to 355, the bids below fall back to the overflow map
+
+    book.addOrder(1, Side::SELL, 100, 5);
+    book.addOrder(2, Side::SELL, 101, 5);
+    book.addOrder(3, Side::SELL, 105, 5);
+    book.addOrder(4, Side::BUY, 90, 3);
+    book.addOrder(5, Side::BUY, 80, 3);
+
+    assert(book.executeOrder(10, Side::BUY, 101, 12, OrderType::IOC) == RejectReason::NONE && "an IOC order should be accepted");
+    assert(!book.contains(1) && !book.contains(2) && !book.contains(10) && book.getBestAsk().price == 105
+           && "an IOC order should fill up to its limit and drop the remainder");
+
+    assert(book.executeOrder(11, Side::BUY, 105, 6, OrderType::FOK) == RejectReason::NOT_FILLABLE && book.getOrderByID(3).getRemainingQuantity() == 5
+           && "a FOK order without enough liquidity within its limit should be killed without filling");
+    assert(book.executeOrder(12, Side::SELL, 80, 7, OrderType::FOK) == RejectReason::NOT_FILLABLE && book.getBestBid().quantity == 3
+           && "the FOK check should cover the overflow levels");
+    assert(book.executeOrder(13, Side::BUY, 105, 5, OrderType::FOK) == RejectReason::NONE && !book.contains(3) && !book.contains(13)
+           && "a FOK order with enough liquidity should fill completely");
+
+    assert(book.executeOrder(14, Side::SELL, 1000, 4, OrderType::MARKET) == RejectReason::NONE && !book.contains(4)
+           && book.getOrderByID(5).getRemainingQuantity() == 2 && "a market order should ignore its price and sweep the book");
+    assert(book.executeOrder(15, Side::BUY, 0, 4, OrderType::MARKET) == RejectReason::NONE && book.getBestAsk().quantity == 0
+           && !book.contains(15) && "a market order should not rest when the opposite side is empty");
+
+    // A crossed batch book is uncrossed before an IOC order trades, so resting orders that crossed first keep priority
+    book.addOrder(6, Side::BUY, 110, 1);
+    book.addOrder(7, Side::SELL, 109, 1);
+    book.executeOrder(16, Side::SELL, 100, 1, OrderType::IOC);
+    assert(!book.contains(6) && !book.contains(7) && book.getOrderByID(5).getRemainingQuantity() == 2
+           && "the crossed orders should trade with each other before the IOC order arrives");
+    assert(book.getCounters().trades == 6 && "every fill should be counted");
+
+    std::cout << "orderTypesTest() passed!\n";
+}
+
+template<typename BookType>
+void memoryUsageTest() {
+    static_assert((sizeof(Order) == 40 && sizeof(PriceLevel) == 24) || sizeof(Price) != 4 || sizeof(Quantity) != 4,
+                  "orders and levels should have no padding with 32-bit prices and quantities");
+
+    BookType book;
+    const BookMemoryUsage empty = book.getMemoryUsage();
+    assert(empty.orders > 0 && empty.index > 0 && "the first pool block and the minimum table should be counted");
+
+    for (IdNumber id = 0; id < 1000; id++) {
+        book.addOrder(id, Side::BUY, 10000 - static_cast<Price>(id % 100), 10);
+    }
+    const BookMemoryUsage full = book.getMemoryUsage();
+    assert(full.orders >= 1000 * sizeof(Order) && "every order should be counted");
+    assert(full.levels >= 100 * sizeof(PriceLevel) && "every level should be counted");
+    assert(full.index > empty.index && "the index should have grown for 1000 orders");
+    assert(full.total() == full.orders + full.levels + full.index && "the total should add up the parts");
+
+    for (IdNumber id = 0; id < 1000; id++) {
+        book.cancelOrder(id);
+    }
+    const BookMemoryUsage drained = book.getMemoryUsage();
+    assert(drained.orders == full.orders && drained.index == full.index && "slots should stay reserved for reuse");
+    assert(drained.levels == empty.levels && "erased levels should no longer be counted");
+
+    std::cout << "memoryUsageTest() passed!\n";
+}
+
+template<typename BookType>
+void sideEntryPointsTest() {
+    static_assert(SideTraits<Side::BUY>::better(101, 100) && SideTraits<Side::SELL>::better(100, 101) && "each side should prefer its own direction");
+    static_assert(SideTraits<Side::BUY>::opposite == Side::SELL && SideTraits<Side::SELL>::opposite == Side::BUY);
+
+    // The same flow through the run-time and the side-specialized entry points must leave identical books
+    BookType dynamicBook(BookConfig{.matchingMode = MatchingMode::CONTINUOUS});
+    BookType staticBook(BookConfig{.matchingMode = MatchingMode::CONTINUOUS});
+    const std::vector<Command> orders = generateOrders(20000);
+    for (const Command& c : orders) {
+        dynamicBook.addOrder(c.idNumber, c.side, c.price, c.qty);
+        if (c.side == Side::BUY) { staticBook.template addOrder<Side::BUY>(c.idNumber, c.price, c.qty); }
+        else { staticBook.template addOrder<Side::SELL>(c.idNumber, c.price, c.qty); }
+    }
+    assert(dynamicBook.executeOrder(20000, Side::SELL, 0, 50, OrderType::MARKET) == RejectReason::NONE);
+    assert(staticBook.template executeOrder<Side::SELL>(20000, 0, 50, OrderType::MARKET) == RejectReason::NONE);
+
+    assert(dynamicBook.getNumberOfOrders() == staticBook.getNumberOfOrders() && dynamicBook.getCounters().trades == staticBook.getCounters().trades
+           && "both entry points should match the same orders");
+    DepthLevel dynamicDepth[2][5], staticDepth[2][5];
+    for (const Side side : {Side::BUY, Side::SELL}) {
+        const std::size_t levels = dynamicBook.getDepth(side, dynamicDepth[static_cast<int>(side)]);
+        assert(levels == staticBook.getDepth(side, staticDepth[static_cast<int>(side)]) && "both books should have the same depth");
+        for (std::size_t i = 0; i < levels; i++) {
+            const DepthLevel& a = dynamicDepth[static_cast<int>(side)][i];
+            const DepthLevel& b = staticDepth[static_cast<int>(side)][i];
+            assert(a.price == b.price && a.quantity == b.quantity && a.orderCount == b.orderCount && "both books should have the same levels");
+        }
+    }
+    assert(dynamicBook.getSpread() == staticBook.getSpread() && *dynamicBook.getSpread() > 0 && "a continuous book should never be crossed");
+
+    std::cout << "sideEntryPointsTest() passed!\n";
+}
+
+template<typename EngineType>
 void cancelValidOrderTest() {
-    Engine eng;
+    EngineType eng;
     eng.start();
 
     Command c1 = {CommandType::ADD};
@@ -163,137 +394,1122 @@ void cancelValidOrderTest() {
     waitUntil(eng, lastSeqNum);
     eng.stop();
 
-    const OrderBook& book = eng.getBook();
+    const auto& book = eng.getBook();
 
     assert(!book.contains(1) && "order1 should be removed from the order book");
 
     std::cout << "cancelValidOrderTest() passed!\n";
 }
 
-void benchmarkFiveMillionOrders() {
-    using namespace std::chrono;
+void orderPoolTest() {
+    OrderPool pool;
+    PriceLevel level;
 
-    TransitionMatrix matrix = {
-        {0.80, 0.10, 0.10}, // Neutral
-        {0.10, 0.85, 0.05}, // Buy Pressure
-        {0.10, 0.05, 0.85} // Sell Pressure
-    };
+    const OrderHandle first = pool.allocate(1, Side::BUY, 100, 10);
+    const OrderHandle middle = pool.allocate(2, Side::BUY, 100, 20);
+    const OrderHandle last = pool.allocate(3, Side::BUY, 100, 30);
+    pool.pushBack(level, first);
+    pool.pushBack(level, middle);
+    pool.pushBack(level, last);
 
-    std::random_device rd;
-    std::mt19937 rng(rd());
+    pool.unlink(level, middle);
+    pool.release(middle);
+    assert(level.head == first && level.tail == last && "level should keep its first and last orders");
+    assert(pool.size() == 2 && "pool should have 2 live orders");
 
-    OrderGenerator generator(matrix, rng);
-    constexpr int NUM_ORDERS = 5000000;
+    const OrderHandle reused = pool.allocate(4, Side::BUY, 100, 40);
+    assert(reused == middle && "freed slot should be reused");
+    assert(pool.at(reused).getIDNumber() == 4 && pool.at(reused).getRemainingQuantity() == 40 && "reused slot should hold the new order");
+
+    pool.unlink(level, first);
+    pool.unlink(level, last);
+    assert(level.empty() && "level should be empty");
+
+    std::cout << "orderPoolTest() passed!\n";
+}
+
+void orderIndexTest() {
+    for (const OrderIndexMode mode : {OrderIndexMode::HASHED, OrderIndexMode::DIRECT}) {
+        OrderIndex index(mode);
+        std::unordered_map<IdNumber, OrderHandle> reference;
+
+        // Churn past several growths so erases shift entries across long probe runs
+        Xoshiro256 rng(7);
+        const IdNumber idRange = (mode == OrderIndexMode::DIRECT) ? 20000 : ~IdNumber{0};
+        for (OrderHandle handle = 0; handle < 50000; handle++) {
+            const IdNumber idNumber = rng() % idRange;
+            if (rng() % 3 == 0 && !reference.empty()) {
+                const IdNumber victim = reference.begin()->first;
+                assert(index.erase(victim) && "indexed id should be erased");
+                reference.erase(victim);
+            }
+            index.insert(idNumber, handle);
+            reference[idNumber] = handle;
+        }
+        assert(index.size() == reference.size() && "index should hold one entry per distinct id");
+        for (const auto& [idNumber, handle] : reference) {
+            assert(index.find(idNumber) == handle && "every id should map to its latest handle");
+        }
+
+        for (const auto& [idNumber, handle] : reference) {
+            assert(index.erase(idNumber) && "indexed id should be erased");
+            assert(index.find(idNumber) == NULL_HANDLE && "erased id should not be found");
+        }
+        assert(index.empty() && "index should be empty");
+        assert(!index.erase(12345) && "erasing an unknown id should fail");
+        assert(index.find(idRange - 1) == NULL_HANDLE && "unknown id should not be found");
+    }
 
+    // A book with a direct index grows it as ids arrive beyond the capacity hint
+    OrderBook book(BookConfig{.orderCapacity = 4, .orderIndex = OrderIndexMode::DIRECT});
+    for (IdNumber idNumber = 0; idNumber < 100; idNumber++) {
+        book.addOrder(idNumber, Side::BUY, 100, 10);
+    }
+    book.cancelOrder(50);
+    book.addOrder(100, Side::SELL, 100, 25);
+    book.matchOrders();
+    assert(!book.contains(0) && !book.contains(1) && !book.contains(50) && "filled and canceled orders should be removed");
+    assert(book.getOrderByID(2).getRemainingQuantity() == 5 && "order2 should have 5 remaining");
+    assert(book.getNumberOfOrders() == 97 && "97 orders should rest");
+
+    std::cout << "orderIndexTest() passed!\n";
+}
+
+void ladderBestLevelTest() {
+    LadderOrderBook book({100, 256}); // ladder covers prices 100 to 355
+
+    book.addOrder(1, Side::BUY, 50, 10); // below the ladder
+    book.addOrder(2, Side::BUY, 120, 10);
+    book.addOrder(3, Side::BUY, 300, 10);
+    book.addOrder(4, Side::BUY, 400, 10); // above the ladder
+    book.addOrder(5, Side::BUY, 310, 10);
+    book.cancelOrder(5); // best ladder level emptied so the next best must be found by scanning
+
+    assert(book.getNumberOfLevels(Side::BUY) == 4 && "there should be 4 bid levels");
+
+    book.addOrder(6, Side::SELL, 50, 35);
+    book.matchOrders();
+
+    assert(!book.contains(4) && "order4 should be filled first as the best bid outside the ladder");
+    assert(!book.contains(3) && "order3 should be removed from the order book");
+    assert(!book.contains(2) && "order2 should be removed from the order book");
+    assert(book.getOrderByID(1).getRemainingQuantity() == 5 && "order1 should have 5 remaining");
+    assert(!book.contains(6) && "order6 should be removed from the order book");
+    assert(book.getNumberOfLevels(Side::BUY) == 1 && "only the level below the ladder should remain");
+    assert(book.getNumberOfLevels(Side::SELL) == 0 && "there should be no ask levels");
+
+    std::cout << "ladderBestLevelTest() passed!\n";
+}
+
+void continuousMatchingTest() {
+    OrderBook book(BookConfig{.matchingMode = MatchingMode::CONTINUOUS});
+
+    book.addOrder(1, Side::BUY, 10000, 10);
+    book.addOrder(2, Side::SELL, 9900, 4); // crosses and is filled on arrival without matchOrders
+
+    assert(!book.contains(2) && "order2 should be filled on arrival");
+    assert(book.getOrderByID(1).getRemainingQuantity() == 6 && "order1 should have 6 remaining");
+
+    book.addOrder(3, Side::SELL, 9900, 10); // fills order1 and rests the remainder
+    assert(!book.contains(1) && "order1 should be removed from the order book");
+    assert(book.getOrderByID(3).getRemainingQuantity() == 4 && "order3 should rest with 4 remaining");
+    assert(book.getOrderByID(3).getStatus() == Status::PARTIALLY_FILLED && "order3 should be partially filled");
+    assert(book.getNumberOfLevels(Side::BUY) == 0 && "there should be no bid levels");
+
+    book.addOrder(4, Side::BUY, 9800, 5); // does not cross so it rests
+    assert(book.contains(4) && "order4 should rest in the order book");
+
+    std::cout << "continuousMatchingTest() passed!\n";
+}
+
+template<typename BookType>
+void depthTest() {
+    BookType book({100, 256}); // the ladder covers prices 100 to 355
+
+    book.addOrder(1, Side::BUY, 150, 10);
+    book.addOrder(2, Side::BUY, 150, 5);
+    book.addOrder(3, Side::BUY, 120, 7);
+    book.addOrder(4, Side::BUY, 400, 2); // above the ladder
+    book.addOrder(5, Side::BUY, 50, 1); // below the ladder
+    book.addOrder(6, Side::SELL, 500, 3);
+    book.addOrder(7, Side::SELL, 600, 4);
+    book.addOrder(8, Side::SELL, 200, 6);
+
+    assert(book.getBestBid().price == 400 && book.getBestBid().quantity == 2 && "best bid should be order4");
+    assert(book.getSpread() == -200 && "the spread should be negative while the book is crossed");
+
+    book.matchOrders();
+    const DepthLevel bid = book.getBestBid();
+    const DepthLevel ask = book.getBestAsk();
+    assert(bid.price == 150 && bid.quantity == 15 && bid.orderCount == 2 && "best bid should aggregate order1 and order2");
+    assert(ask.price == 200 && ask.quantity == 4 && ask.orderCount == 1 && "best ask should reflect the partial fill");
+    assert(book.getSpread() == 50 && "spread should be 50");
+
+    DepthLevel depth[8];
+    assert(book.getDepth(Side::BUY, depth) == 3 && "there should be 3 bid levels");
+    assert(depth[0].price == 150 && depth[1].price == 120 && depth[2].price == 50 && depth[2].quantity == 1 && "bid levels should be in price priority");
+    assert(book.getDepth(Side::SELL, std::span(depth, 2)) == 2 && "only the requested number of levels should be copied");
+    assert(depth[0].price == 200 && depth[1].price == 500 && depth[1].quantity == 3 && "ask levels should be in price priority");
+
+    book.cancelOrder(2);
+    assert(book.getLevel(Side::BUY, 150).quantity == 10 && book.getLevel(Side::BUY, 150).orderCount == 1 && "cancel should update the level");
+    assert(book.getLevel(Side::BUY, 151).quantity == 0 && "a missing level should have no quantity");
+
+    book.addOrder(9, Side::SELL, 150, 4);
+    book.matchOrders();
+    assert(book.getBestBid().quantity == 6 && book.getBestAsk().price == 200 && "a partial fill should update the level");
+
+    BookType continuous(BookConfig{.ladderBasePrice = 100, .ladderTicks = 256, .matchingMode = MatchingMode::CONTINUOUS});
+    continuous.addOrder(1, Side::BUY, 150, 10);
+    continuous.addOrder(2, Side::SELL, 150, 3); // filled on arrival
+    assert(continuous.getBestBid().quantity == 7 && continuous.getBestAsk().quantity == 0 && "fills on arrival should update the level");
+    assert(!continuous.getSpread() && "there should be no spread with an empty side");
+
+    std::cout << "depthTest() passed!\n";
+}
+
+void batchControllerTest() {
+    BatchController count(BatchConfig{.policy = BatchPolicy::COUNT, .maxBatch = 3});
+    count.onCommand();
+    count.onCommand();
+    assert(!count.shouldMatch(false) && "count policy should wait for a full batch");
+    count.onCommand();
+    assert(count.shouldMatch(false) && "count policy should match a full batch");
+    count.onMatch(5, std::chrono::nanoseconds::zero());
+    count.onCommand();
+    assert(count.shouldMatch(true) && "an empty queue should always trigger a match");
+    count.onMatch(0, std::chrono::nanoseconds::zero());
+
+    const BatchStats stats = count.stats();
+    assert(stats.passes == 2 && stats.commands == 4 && "there should be 2 passes covering 4 commands");
+    assert(stats.minBatch == 1 && stats.maxBatch == 3 && stats.lastBatch == 1 && "batch sizes should be tracked");
+
+    BatchController time(BatchConfig{.policy = BatchPolicy::TIME, .maxDelay = std::chrono::nanoseconds::zero()});
+    for (int i = 0; i < 31; i++) { time.onCommand(); }
+    assert(!time.shouldMatch(false) && "time policy should only read the clock every 32 commands");
+    time.onCommand();
+    assert(time.shouldMatch(false) && "time policy should match once the delay has passed");
+
+    BatchController adaptive(BatchConfig{.policy = BatchPolicy::ADAPTIVE, .maxBatch = 1000, .minBatch = 10});
+    for (int i = 0; i < 10; i++) { adaptive.onCommand(); }
+    assert(adaptive.shouldMatch(false) && "adaptive policy should start at the minimum batch");
+    adaptive.onMatch(500, std::chrono::microseconds(1));
+    assert(adaptive.stats().targetBatch >= 500 && adaptive.stats().targetBatch <= 1000 && "adaptive policy should grow batches to drain a backlog");
+
+    std::cout << "batchControllerTest() passed!\n";
+}
+
+void latencyHistogramTest() {
+    LatencyHistogram histogram;
+    for (std::uint64_t i = 1; i <= 100000; i++) {
+        histogram.record(i);
+    }
+
+    assert(histogram.count() == 100000 && "histogram should hold 100000 samples");
+    assert(histogram.max() == 100000 && "max should be exact");
+    const std::uint64_t p50 = histogram.percentile(50.0);
+    const std::uint64_t p99 = histogram.percentile(99.0);
+    assert(p50 >= 48500 && p50 <= 51500 && "p50 should be within 3% of 50000");
+    assert(p99 >= 96000 && p99 <= 100000 && "p99 should be within 3% of 99000");
+    assert(histogram.percentile(100.0) == 100000 && "p100 should be the max");
+
+    std::cout << "latencyHistogramTest() passed!\n";
+}
+
+void engineCountersTest() {
     Engine eng;
+    eng.enableMetrics(true);
     eng.start();
 
-    const auto start = high_resolution_clock::now();
+    Command c1 = {CommandType::ADD};
+    c1.idNumber = 1; c1.side = Side::BUY; c1.price = 10000; c1.qty = 5;
+    eng.submit(c1);
+
+    Command c2 = {CommandType::ADD};
+    c2.idNumber = 2; c2.side = Side::SELL; c2.price = 9900; c2.qty = 5;
+    waitUntil(eng, eng.submit(c2)); // the queue drains so both orders are matched
+
+    Command c3 = {CommandType::CANCEL};
+    c3.idNumber = 1; // already filled so the cancel is rejected
+    const SeqNum lastSeqNum = eng.submit(c3);
+
+    waitUntil(eng, lastSeqNum);
+    eng.stop();
+
+    const EngineCounters counters = eng.getCounters();
+    const EngineMetrics& metrics = eng.getMetrics();
+
+    assert(counters.commands == 3 && "3 commands should be counted");
+    assert(counters.rejected == 1 && "the cancel should be rejected");
+    assert(counters.levelsCreated == 2 && counters.levelsDestroyed == 2 && "both levels should be created and destroyed");
+    assert(counters.trades == 1 && "there should be 1 trade");
+    assert(counters.queueHighWater >= 1 && "every dequeue should update the queue high-water mark");
+    assert(metrics.queueDelay.count() == 3 && "every command should have a queueing delay");
+    assert(metrics.addTime.count() == 2 && metrics.cancelTime.count() == 0 && "only applied commands should be timed");
+    assert(metrics.matchTime.count() >= 1 && "match passes should be timed");
+
+    std::cout << "engineCountersTest() passed!\n";
+}
+
+void executionReportTest() {
+    ExecutionReportRing reports(16);
+    Engine eng;
+    eng.setExecutionReportRing(&reports);
+    eng.start();
+
+    Command c1 = {CommandType::ADD};
+    c1.idNumber = 1; c1.side = Side::BUY; c1.price = 10000; c1.qty = 5;
+    eng.submit(c1);
+
+    Command c2 = {CommandType::ADD};
+    c2.idNumber = 2; c2.side = Side::BUY; c2.price = 10000; c2.qty = 10;
+    eng.submit(c2);
+
+    Command c3 = {CommandType::ADD};
+    c3.idNumber = 3; c3.side = Side::SELL; c3.price = 9900; c3.qty = 12;
+    eng.submit(c3);
+
+    // A second symbol shares the ring, its fills carry its own symbol and trade sequence
+    Command c4 = {CommandType::ADD};
+    c4.symbol = 5; c4.idNumber = 4; c4.side = Side::SELL; c4.price = 10000; c4.qty = 2;
+    eng.submit(c4);
+
+    Command c5 = {CommandType::ADD};
+    c5.symbol = 5; c5.idNumber = 5; c5.side = Side::BUY; c5.price = 10000; c5.qty = 2;
+    const SeqNum lastSeqNum = eng.submit(c5);
+
+    waitUntil(eng, lastSeqNum);
+    eng.stop();
+
+    ExecutionReport first{}, second{}, third{}, extra{};
+    assert(reports.tryPop(first) && reports.tryPop(second) && reports.tryPop(third) && "there should be three fills");
+    assert(!reports.tryPop(extra) && "there should be no more fills");
+    assert(first.makerId == 1 && first.takerId == 3 && first.price == 10000 && first.qty == 5 && "first fill should be order1 against order3");
+    assert(second.makerId == 2 && second.takerId == 3 && second.price == 10000 && second.qty == 7 && "second fill should be order2 against order3");
+    assert(first.symbol == 0 && second.symbol == 0 && "fills of the default book should carry symbol 0");
+    assert(second.seq == first.seq + 1 && "fills should have consecutive sequence numbers");
+    assert(third.makerId == 4 && third.takerId == 5 && third.symbol == 5 && "the fill of symbol 5 should carry its symbol");
+    assert(third.seq == first.seq && "every book should number its own trades");
+    assert(second.timestamp >= first.timestamp && first.timestamp > 0 && "fills should be timestamped");
+
+    std::cout << "executionReportTest() passed!\n";
+}
+
+template<typename EngineType>
+void waitStrategyTest(const char* name) {
+    for (const WaitStrategy strategy : {WaitStrategy::BUSY_SPIN, WaitStrategy::SPIN_YIELD, WaitStrategy::SPIN_PARK}) {
+        EngineType eng;
+        eng.setWaitStrategy(strategy);
+        eng.start();
+
+        Command c1 = {CommandType::ADD};
+        c1.idNumber = 1; c1.side = Side::BUY; c1.price = 10000; c1.qty = 5;
+        waitUntil(eng, eng.submit(c1));
+
+        // Long enough for a SPIN_PARK engine thread to fall asleep, the next command must wake it
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        Command c2 = {CommandType::ADD};
+        c2.idNumber = 2; c2.side = Side::SELL; c2.price = 10000; c2.qty = 5;
+        waitUntil(eng, eng.submit(c2));
+
+        // Stopping an idle engine must release its thread whatever it is waiting in
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        eng.stop();
+        assert(eng.getCounters().trades == 1 && eng.getBook().getNumberOfOrders() == 0 && "both orders should be applied and matched");
+    }
+
+    std::cout << "waitStrategyTest() passed for " << name << "!\n";
+}
+
+void rejectEventTest() {
+    RejectRing rejects(16);
+    bool errorHandlerCalled = false;
+    Engine eng;
+    eng.setRejectRing(&rejects);
+    eng.set_error_handler([&](const Command&, const std::exception&) { errorHandlerCalled = true; });
+    eng.start();
+
+    Command c1 = {CommandType::CANCEL};
+    c1.idNumber = 42; // never added
+    eng.submit(c1);
+
+    Command c2 = {CommandType::ADD};
+    c2.idNumber = 1; c2.side = Side::BUY; c2.price = 10000; c2.qty = 10;
+    eng.submit(c2);
+
+    Command c3 = {CommandType::ADD};
+    c3.idNumber = 2; c3.side = Side::SELL; c3.price = 10000; c3.qty = 4;
+    waitUntil(eng, eng.submit(c3)); // the queue drains so order1 is partially filled
+
+    Command c4 = {CommandType::CANCEL};
+    c4.idNumber = 1;
+    eng.submit(c4);
+
+    Command c5 = {CommandType::MODIFY};
+    c5.idNumber = 1; c5.price = 10100; c5.qty = 10;
+    eng.submit(c5);
+
+    Command c6 = {CommandType::MODIFY};
+    c6.symbol = 7; c6.idNumber = 1; c6.price = 10100; c6.qty = 10;
+    const SeqNum lastSeqNum = eng.submit(c6);
+
+    waitUntil(eng, lastSeqNum);
+    eng.stop();
+
+    const std::pair<SeqNum, RejectReason> expected[] = {
+        {1, RejectReason::UNKNOWN_ORDER},
+        {4, RejectReason::PARTIALLY_FILLED},
+        {5, RejectReason::NOT_PENDING},
+        {6, RejectReason::UNKNOWN_SYMBOL}
+    };
+    for (const auto& [seqNum, reason] : expected) {
+        RejectEvent event{};
+        assert(rejects.tryPop(event) && "every reject should be published");
+        assert(event.seqNum == seqNum && event.reason == reason && "rejects should carry their command and reason in order");
+    }
+    RejectEvent extra{};
+    assert(!rejects.tryPop(extra) && "accepted commands should not be published");
+    assert(!errorHandlerCalled && "rejects should not raise exceptions");
+    assert(eng.getCounters().rejected == 4 && "every reject should be counted");
+    assert(eng.getBook().getOrderByID(1).getRemainingQuantity() == 6 && "rejected commands should leave order1 unchanged");
+    assert(eng.getBook().findOrder(2) == nullptr && "order2 should be filled");
+
+    std::cout << "rejectEventTest() passed!\n";
+}
+
+void marketDataTest() {
+    const std::string path = (std::filesystem::temp_directory_path() / "lob_market_data_test.bin").string();
+    const auto readAll = [](MarketDataSubscriber& subscriber) {
+        std::vector<BookEvent> events;
+        BookEvent event{};
+        while (subscriber.tryRead(event) == ReadResult::EVENT) {
+            events.push_back(event);
+        }
+        return events;
+    };
+
+    {
+        MarketDataPublisher publisher(path, 64);
+        MarketDataSubscriber subscriber(path); // a separate mapping of the file, as another process would have
+        OrderBook book;
+        book.setMarketDataPublisher(&publisher, 7);
+
+        book.addOrder(1, Side::BUY, 10000, 10);
+        book.addOrder(2, Side::SELL, 10000, 4);
+        book.matchOrders();
+        book.addOrder(3, Side::BUY, 10000, 5);
+        book.cancelOrder(3);
+
+        const std::vector<BookEvent> events = readAll(subscriber);
+        const BookEventType expected[] = {
+            BookEventType::ORDER_ADDED, BookEventType::LEVEL_CHANGED, BookEventType::ORDER_ADDED, BookEventType::LEVEL_CHANGED,
+            BookEventType::TRADE, BookEventType::ORDER_REDUCED, BookEventType::LEVEL_CHANGED, BookEventType::ORDER_DELETED, BookEventType::LEVEL_CHANGED,
+            BookEventType::ORDER_ADDED, BookEventType::LEVEL_CHANGED, BookEventType::ORDER_DELETED, BookEventType::LEVEL_CHANGED
+        };
+        assert(events.size() == std::size(expected) && "every state change should be published");
+        for (std::size_t i = 0; i < events.size(); i++) {
+            assert(events[i].type == expected[i] && events[i].seq == i + 1 && events[i].symbol == 7 && "events should be published in order");
+        }
+        assert(events[4].idNumber == 1 && events[4].contraId == 2 && events[4].qty == 4 && events[4].price == 10000 && "the trade should name maker and taker");
+        assert(events[5].idNumber == 1 && events[5].qty == 6 && events[6].levelQuantity == 6 && "the maker should be reduced to 6");
+        assert(events[8].side == static_cast<std::uint8_t>(Side::SELL) && events[8].levelQuantity == 0 && events[8].levelOrders == 0 && "the ask level should be gone");
+        assert(events[10].levelQuantity == 11 && events[10].levelOrders == 2 && "the bid level should aggregate both orders");
+    }
+    {
+        // A reader that falls a whole ring behind skips to the oldest event still in the ring
+        MarketDataPublisher publisher(path, 8);
+        MarketDataSubscriber subscriber(path);
+        OrderBook book;
+        book.setMarketDataPublisher(&publisher);
+        for (IdNumber id = 0; id < 10; id++) {
+            book.addOrder(id, Side::BUY, 10000 - id, 1); // two events each
+        }
+        BookEvent event{};
+        assert(subscriber.tryRead(event) == ReadResult::OVERRUN && subscriber.getLostEvents() == 12 && "the reader should detect the overrun");
+        const std::vector<BookEvent> events = readAll(subscriber);
+        assert(events.size() == 8 && events.front().seq == 13 && events.back().seq == 20 && "the reader should resume at the oldest event");
+    }
+    {
+        MarketDataPublisher publisher(path, 64);
+        MarketDataSubscriber subscriber(path);
+        Engine eng;
+        eng.setMarketDataPublisher(&publisher);
+        eng.start();
+        Command c = {CommandType::ADD};
+        c.symbol = 3; c.idNumber = 1; c.side = Side::SELL; c.price = 10100; c.qty = 5;
+        waitUntil(eng, eng.submit(c));
+        eng.stop();
+
+        const std::vector<BookEvent> events = readAll(subscriber);
+        assert(events.size() == 2 && events[0].symbol == 3 && events[0].type == BookEventType::ORDER_ADDED && "engine books should publish with their symbol");
+    }
+
+    std::filesystem::remove(path);
+    std::cout << "marketDataTest() passed!\n";
+}
 
+void journalRecoveryTest() {
+    const std::string path = (std::filesystem::temp_directory_path() / "lob_journal_test.bin").string();
+    std::vector<Command> commands;
+    for (int i = 0; i < 200; i++) {
+        Command c = {CommandType::ADD};
+        c.symbol = i % 3; c.idNumber = i + 1; c.side = (i % 2) ? Side::SELL : Side::BUY;
+        c.price = 10000 + (i % 7) - 3; c.qty = 5 + i % 4;
+        commands.push_back(c);
+        if (i % 10 == 9) {
+            Command cancel = {CommandType::CANCEL};
+            cancel.symbol = i % 3; cancel.idNumber = i - 3; // some of these are filled already and get rejected
+            commands.push_back(cancel);
+        }
+    }
+
+    std::vector<std::size_t> ordersBefore;
     SeqNum lastSeqNum = 0;
-    for (int i = 0; i < NUM_ORDERS; i++) {
-        generator.nextState();
-        Side orderSide = generator.pickOrderSide();
-        std::uint32_t orderPrice = generator.generateOrderPrice(10000, orderSide, 1.0, 2.5); // reference price is $100.00
-        std::uint32_t orderSize = generator.generateOrderSize(10.0, 1.7);
+    {
+        Journal journal(JournalConfig{.path = path, .capacity = 64, .truncate = true}); // small enough to grow
+        Engine eng(1 << 16, {}, BatchConfig{.maxBatch = 16});
+        eng.setJournal(&journal);
+        eng.start();
+        for (const Command& c : commands) {
+            lastSeqNum = eng.submit(c);
+        }
+        waitUntil(eng, lastSeqNum);
+        eng.stop();
+        for (SymbolId symbol = 0; symbol < 3; symbol++) {
+            ordersBefore.push_back(eng.getBook(symbol).getNumberOfOrders());
+        }
+        assert(journal.size() > commands.size() && "every command and match pass should be journaled");
+    }
+
+    // A fresh engine rebuilds the same books from the journal
+    Journal journal(JournalConfig{.path = path});
+    Engine eng;
+    eng.setJournal(&journal);
+    assert(eng.recover() == commands.size() && "every journaled command should be replayed");
+    assert(eng.lastProcessed() == lastSeqNum && "recovery should restore the sequence number");
+    for (SymbolId symbol = 0; symbol < 3; symbol++) {
+        assert(eng.getBook(symbol).getNumberOfOrders() == ordersBefore[symbol] && "replay should rebuild every book");
+    }
+
+    eng.start();
+    Command c = {CommandType::ADD};
+    c.idNumber = 1000; c.side = Side::BUY; c.price = 1; c.qty = 1;
+    const SeqNum nextSeqNum = eng.submit(c);
+    waitUntil(eng, nextSeqNum);
+    eng.stop();
+    assert(nextSeqNum == lastSeqNum + 1 && "sequence numbers should continue after recovery");
+    assert(eng.getBook().contains(1000) && "the engine should keep running after recovery");
+
+    std::filesystem::remove(path);
+    std::cout << "journalRecoveryTest() passed!\n";
+}
+
+void journalTornTailTest() {
+    const std::string path = (std::filesystem::temp_directory_path() / "lob_journal_torn_test.bin").string();
+    const auto command = [](const SeqNum seqNum) {
+        Command c{};
+        c.type = CommandType::ADD; c.seqNum = seqNum; c.idNumber = seqNum; c.side = Side::BUY; c.price = 10000; c.qty = 1;
+        return c;
+    };
+    const auto seqNums = [](const Journal& journal) {
+        std::vector<SeqNum> visited;
+        journal.replay([&](const JournalRecord& record) { visited.push_back(record.seqNum); });
+        return visited;
+    };
+
+    constexpr std::size_t CAPACITY = 16;
+    {
+        Journal journal(JournalConfig{.path = path, .capacity = CAPACITY, .truncate = true});
+        for (SeqNum seqNum = 1; seqNum <= 10; seqNum++) { journal.append(command(seqNum)); }
+    }
+    {
+        // Tear the sixth record like a crash in the middle of writing it
+        const std::size_t headerSize = std::filesystem::file_size(path) - CAPACITY * sizeof(JournalRecord);
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(headerSize + 5 * sizeof(JournalRecord) + sizeof(SeqNum)));
+        const char garbage = 0x5A;
+        file.write(&garbage, 1);
+    }
+    {
+        // The next session resumes at the torn record and appends less than the old tail held
+        Journal journal(JournalConfig{.path = path});
+        assert(journal.size() == 5 && "appending should resume at the torn record");
+        journal.append(command(6));
+        journal.append(command(7));
+    }
+    {
+        const Journal journal(JournalConfig{.path = path});
+        assert(seqNums(journal) == std::vector<SeqNum>({1, 2, 3, 4, 5, 6, 7}) && "records of the earlier session should not be replayed");
+    }
+    {
+        // Valid records after a gap in the sequence numbers are not replayed either
+        Journal journal(JournalConfig{.path = path, .capacity = CAPACITY, .truncate = true});
+        journal.append(command(1));
+        journal.append(command(2));
+        journal.appendMatch(2);
+        journal.append(command(4));
+        assert(seqNums(journal) == std::vector<SeqNum>({1, 2, 2}) && "replay should stop at a sequence gap");
+    }
+
+    std::filesystem::remove(path);
+    std::cout << "journalTornTailTest() passed!\n";
+}
 
+template<typename EngineType>
+void snapshotTest() {
+    const std::string path = (std::filesystem::temp_directory_path() / "lob_snapshot_test.bin").string();
+    const std::string journalPath = (std::filesystem::temp_directory_path() / "lob_snapshot_journal_test.bin").string();
+    const auto add = [](const SymbolId symbol, const IdNumber id, const Side side, const Price price, const Quantity qty) {
         Command c = {CommandType::ADD};
-        c.idNumber = i; c.side = orderSide; c.price = orderPrice; c.qty = orderSize;
-        lastSeqNum = eng.submit(c);
+        c.symbol = symbol; c.idNumber = id; c.side = side; c.price = price; c.qty = qty;
+        return c;
+    };
+
+    // A small ladder, so a price just past it fits every price width
+    const BookConfig config{.ladderBasePrice = 9000, .ladderTicks = 2048};
+    const Price outsideLadder = static_cast<Price>(config.ladderBasePrice + config.ladderTicks + 100);
+
+    SeqNum snapshotSeqNum = 0;
+    {
+        Journal journal(JournalConfig{.path = journalPath, .truncate = true});
+        EngineType eng(1 << 16, config);
+        eng.setJournal(&journal);
+        eng.start();
+        eng.submit(add(0, 1, Side::BUY, 10000, 10));
+        eng.submit(add(0, 2, Side::BUY, 10000, 5));
+        eng.submit(add(0, 3, Side::BUY, 9900, 7));
+        eng.submit(add(0, 4, Side::SELL, 10100, 3));
+        eng.submit(add(0, 5, Side::SELL, outsideLadder, 1)); // outside the ladder
+        eng.submit(add(5, 7, Side::BUY, 5000, 1));
+        snapshotSeqNum = eng.submit(add(0, 6, Side::SELL, 10000, 4)); // partially fills order1
+        waitUntil(eng, snapshotSeqNum);
+        eng.stop();
+        eng.saveSnapshot(path);
     }
+    {
+        // Commands after the snapshot only live in the journal
+        Journal journal(JournalConfig{.path = journalPath});
+        EngineType eng(1 << 16, config);
+        eng.setJournal(&journal);
+        eng.loadSnapshot(path);
+        eng.recover();
+        eng.start();
+        waitUntil(eng, eng.submit(add(5, 8, Side::BUY, 5100, 2)));
+        eng.stop();
+    }
+
+    Journal journal(JournalConfig{.path = journalPath});
+    EngineType eng(1 << 16, config);
+    eng.setJournal(&journal);
+    assert(eng.loadSnapshot(path) == snapshotSeqNum && "the snapshot should carry the last applied sequence number");
+    assert(eng.recover() == 1 && "only the command after the snapshot should be replayed");
 
+    const auto& book = eng.getBook();
+    assert(book.getNumberOfOrders() == 5 && book.getNumberOfLevels(Side::BUY) == 2 && book.getNumberOfLevels(Side::SELL) == 2 && "every level and order should be restored");
+    assert(book.getOrderByID(1).getRemainingQuantity() == 6 && book.getOrderByID(1).getStatus() == Status::PARTIALLY_FILLED && "fill state should be restored");
+    assert(book.getOrderByID(5).getPrice() == outsideLadder && "levels outside the ladder should be restored");
+    assert(eng.getBook(5).getNumberOfOrders() == 2 && "every symbol should be restored");
+    assert(eng.getCounters().trades == 1 && "book counters should be restored");
+
+    // Time priority survives: order1 is still ahead of order2
+    eng.start();
+    const SeqNum lastSeqNum = eng.submit(add(0, 9, Side::SELL, 10000, 7));
     waitUntil(eng, lastSeqNum);
     eng.stop();
+    assert(lastSeqNum == snapshotSeqNum + 2 && "sequence numbers should continue after the snapshot and journal");
+    assert(!book.contains(1) && book.getOrderByID(2).getRemainingQuantity() == 4 && "order1 should keep its time priority");
+
+    // A damaged or cut short snapshot is rejected instead of loaded
+    assert(!std::filesystem::exists(path + ".tmp") && "the snapshot should be renamed into place");
+    const auto rejects = [&] {
+        try {
+            EngineType damaged(1 << 16, config);
+            damaged.loadSnapshot(path);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-1, std::ios::end);
+        const char garbage = 0x5A;
+        file.write(&garbage, 1);
+    }
+    assert(rejects() && "a snapshot that fails its checksum should be rejected");
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    assert(rejects() && "a truncated snapshot should be rejected");
 
-    const auto end = high_resolution_clock::now();
-    const double elapsed = duration<double>(end - start).count();
-
-    std::cout << "5 Million Orders Benchmark (Add Only):\n";
-    std::cout << "Processed " << NUM_ORDERS << " orders in " << elapsed << " seconds.\n";
-    std::cout << "Throughput: " << (NUM_ORDERS / elapsed) << " orders/sec\n\n";
+    std::filesystem::remove(path);
+    std::filesystem::remove(journalPath);
+    std::cout << "snapshotTest() passed!\n";
 }
 
-void benchmarkFiveMillionOperations() {
-    using namespace std::chrono;
+void replayTest() {
+    const std::string binaryPath = (std::filesystem::temp_directory_path() / "lob_replay_test.bin").string();
+    const std::string csvPath = (std::filesystem::temp_directory_path() / "lob_replay_test.csv").string();
+
+    const ReplayRecord records[] = {
+        {0, 1, 0, 10000, 10, static_cast<std::uint8_t>(CommandType::ADD), static_cast<std::uint8_t>(Side::BUY)},
+        {10000000, 2, 0, 10100, 5, static_cast<std::uint8_t>(CommandType::ADD), static_cast<std::uint8_t>(Side::SELL)},
+        {20000000, 1, 0, 0, 0, static_cast<std::uint8_t>(CommandType::CANCEL), 0},
+        {25000000, 3, 0, 10100, 2, static_cast<std::uint8_t>(CommandType::ADD), static_cast<std::uint8_t>(Side::BUY), static_cast<std::uint8_t>(OrderType::IOC)}
+    };
+    writeReplayFile(binaryPath, records);
+    {
+        std::ofstream csv(csvPath);
+        csv << "timestamp,type,symbol,id,side,price,qty\n"
+            << "0,ADD,0,1,BUY,10000,10\n"
+            << "10000000,ADD,0,2,SELL,10100,5\n"
+            << "15000000,ADD,0,x,SELL,10100,5\n" // malformed id
+            << "20000000,CANCEL,0,1,,,\r\n"
+            << "25000000,ADD,0,3,BUY,10100,2,IOC\n";
+    }
+
+    for (const std::string& path : {binaryPath, csvPath}) {
+        ReplaySource source(path);
+        assert(source.isBinary() == (path == binaryPath) && "the format should be detected from the header");
+
+        Engine eng;
+        eng.start();
+        ReplayStats stats;
+        replay(source, eng, ReplayConfig{}, stats);
+        eng.stop();
+        assert(stats.commands == 4 && stats.lastSeqNum == 4 && "every record should be submitted");
+        assert(!eng.getBook().contains(1) && !eng.getBook().contains(3) && eng.getBook().getOrderByID(2).getRemainingQuantity() == 3
+               && "the book should reflect the flow, with the IOC order filled against order2 and never resting");
+        assert(source.getMalformedLines() == (path == binaryPath ? 0 : 1) && "malformed CSV lines should be skipped and counted");
+    }
+
+    // Recorded pacing keeps the 25 ms span of the file, divided by the speed
+    for (const double speed : {1.0, 4.0}) {
+        ReplaySource source(binaryPath);
+        Engine eng;
+        eng.start();
+        ReplayStats stats;
+        replay(source, eng, ReplayConfig{.pacing = Pacing::RECORDED, .speed = speed}, stats);
+        eng.stop();
+        assert(stats.elapsedSeconds >= 0.025 / speed && stats.paceLag.count() == 4 && "recorded pacing should keep the gaps between timestamps");
+        assert(stats.outOfOrder == 0 && "the file should be in timestamp order");
+    }
+
+    // A timestamp that goes backwards is submitted immediately and counted
+    {
+        std::ofstream csv(csvPath);
+        csv << "1000,ADD,0,1,BUY,10000,10\n"
+            << "500,ADD,0,2,BUY,10000,5\n";
+    }
+    {
+        ReplaySource source(csvPath);
+        Engine eng;
+        eng.start();
+        ReplayStats stats;
+        replay(source, eng, ReplayConfig{.pacing = Pacing::RECORDED}, stats);
+        eng.stop();
+        assert(stats.commands == 2 && stats.outOfOrder == 1 && "the out of order record should be submitted and counted");
+        assert(stats.elapsedSeconds < 1.0 && stats.paceLag.max() < 1000000000 && "the out of order record should not wait for a wrapped offset");
+    }
+
+    std::filesystem::remove(binaryPath);
+    std::filesystem::remove(csvPath);
+    std::cout << "replayTest() passed!\n";
+}
 
+void bulkGeneratorTest() {
     TransitionMatrix matrix = {
         {0.80, 0.10, 0.10}, // Neutral
         {0.10, 0.85, 0.05}, // Buy Pressure
         {0.10, 0.05, 0.85} // Sell Pressure
     };
-    std::random_device rd;
-    std::mt19937 rng(rd());
-    std::uniform_real_distribution actionDist(0.0, 1.0);
-
-    OrderGenerator generator(matrix, rng);
+    constexpr std::size_t ROWS = 300000; // several chunks and a partial one
+
+    const BulkOrderGenerator generator(matrix, {.seed = 7, .addRatio = 0.6, .cancelRatio = 0.2});
+    OrderColumns single, parallel, reseeded;
+    generator.generate(single, ROWS, 1);
+    generator.generate(parallel, ROWS, 4);
+    BulkOrderGenerator(matrix, {.seed = 8, .addRatio = 0.6, .cancelRatio = 0.2}).generate(reseeded, ROWS);
+    assert(single.size() == ROWS && parallel.size() == ROWS && "every column should hold one value per row");
+    assert(single.action == parallel.action && single.side == parallel.side && single.type == parallel.type && single.price == parallel.price
+           && single.qty == parallel.qty && single.pick == parallel.pick && "the output should not depend on the number of threads");
+    assert(single.price != reseeded.price && "different seeds should yield different flows");
+
+    std::size_t adds = 0, cancels = 0, buys = 0, atReference = 0, iocs = 0;
+    for (std::size_t i = 0; i < ROWS; i++) {
+        adds += single.action[i] == CommandType::ADD;
+        cancels += single.action[i] == CommandType::CANCEL;
+        buys += single.side[i] == Side::BUY;
+        atReference += single.price[i] == 10000;
+        iocs += single.type[i] == OrderType::IOC;
+        assert((single.type[i] == OrderType::MARKET) == (single.price[i] == 10000) && "only market orders should carry the reference price");
+        assert((single.side[i] == Side::BUY ? single.price[i] <= 10000 : single.price[i] >= 10000) && single.price[i] >= 1
+               && "limit prices should sit on their side of the reference price");
+        assert(single.qty[i] >= 10 && "sizes should not fall below the Pareto minimum");
+    }
+    const auto near = [](const std::size_t count, const double share) { return std::abs(static_cast<double>(count) / ROWS - share) < 0.01; };
+    assert(near(adds, 0.6) && near(cancels, 0.2) && "actions should follow the configured mix");
+    assert(near(atReference, 0.2) && near(iocs, 0.8 * 0.1) && "order types should follow the configured mix");
+    assert(std::abs(static_cast<double>(buys) / ROWS - 0.5) < 0.05 && "the symmetric transition matrix should balance buys and sells");
 
-    struct Active { IdNumber idNumber; Side side; };
-    std::vector<Active> active;
-    constexpr int NUM_OPS = 5000000;
-    std::atomic<int> adds = 0, cancels = 0, modifies = 0;
+    std::cout << "bulkGeneratorTest() passed!\n";
+}
 
-    Engine eng;
+template<typename EngineType>
+void submitBatchTest() {
+    EngineType eng;
     eng.start();
 
-    eng.set_error_handler([&](const Command& c, const std::exception& e){
-        (void)e;
-        switch (c.type) {
-            case CommandType::ADD: adds.fetch_sub(1, std::memory_order_relaxed); break;
-            case CommandType::CANCEL: cancels.fetch_sub(1, std::memory_order_relaxed); break;
-            case CommandType::MODIFY: modifies.fetch_sub(1, std::memory_order_relaxed); break;
-        }
-    });
+    // Larger than one submit chunk and one dequeue batch
+    std::vector<Command> commands(600, Command{CommandType::ADD});
+    for (int i = 0; i < 600; i++) {
+        commands[i].idNumber = i + 1; commands[i].side = i < 300 ? Side::BUY : Side::SELL; commands[i].price = 10000; commands[i].qty = 1;
+    }
+    const SeqNum lastBatchSeqNum = eng.submitBatch(commands);
 
-    const auto start = high_resolution_clock::now();
+    Command c = {CommandType::ADD};
+    c.idNumber = 601; c.side = Side::BUY; c.price = 9000; c.qty = 1;
+    const SeqNum lastSeqNum = eng.submit(c);
 
-    SeqNum lastSeqNum = 0;
-    for (int i = 0; i < NUM_OPS; i++) {
-        const double action = actionDist(rng);
-        if (action < 0.6 || active.empty()) {
-            // Add order
-            generator.nextState();
-            Side orderSide = generator.pickOrderSide();
-            std::uint32_t orderPrice = generator.generateOrderPrice(10000, orderSide, 1.0, 2.5); // reference price is $100.00
-            std::uint32_t orderSize = generator.generateOrderSize(10.0, 1.7);
+    waitUntil(eng, lastSeqNum);
+    eng.stop();
 
-            Command c = {CommandType::ADD};
-            c.idNumber = i; c.side = orderSide; c.price = orderPrice; c.qty = orderSize;
-            lastSeqNum = eng.submit(c);
+    const auto& book = eng.getBook();
 
-            active.push_back({c.idNumber, orderSide});
-            adds.fetch_add(1, std::memory_order_relaxed);
-        }
-        else if (action < 0.8 && !active.empty()) {
-            // Cancel random order
-            std::uniform_int_distribution<std::size_t> indexDist(0, active.size() - 1);
-            const std::size_t index = indexDist(rng);
-            const std::uint32_t cancelId = active[index].idNumber;
+    assert(lastBatchSeqNum == 600 && lastSeqNum == 601 && "the batch should reserve a contiguous sequence range");
+    assert(book.getNumberOfOrders() == 1 && book.contains(601) && "every order of the batch should be filled");
+    assert(eng.getCounters().trades == 300 && "there should be 300 trades");
 
-            Command c = {CommandType::CANCEL};
-            c.idNumber = cancelId;
-            lastSeqNum = eng.submit(c);
+    std::cout << "submitBatchTest() passed!\n";
+}
 
-            // O(1) removal
-            active[index] = active.back();
-            active.pop_back();
-            cancels.fetch_add(1, std::memory_order_relaxed);
+template<typename Queue>
+void bulkQueueTest(const char* name) {
+    constexpr std::size_t NUM_COMMANDS = 10000;
+    Queue queue(8);
+
+    std::vector<SeqNum> received;
+    std::thread consumer([&] {
+        Command batch[5];
+        while (received.size() < NUM_COMMANDS) {
+            const std::size_t n = queue.popBulk(batch, 5);
+            for (std::size_t i = 0; i < n; i++) { received.push_back(batch[i].seqNum); }
         }
-        else if (!active.empty()) {
-            // Modify random order
-            std::uniform_int_distribution<std::size_t> indexDist(0, active.size() - 1);
-            const std::size_t index = indexDist(rng);
-            const auto [modifyId, side] = active[index];
+    });
 
-            const std::uint32_t newPrice = generator.generateOrderPrice(10000, side, 1.0, 2.5);
-            const std::uint32_t newSize = generator.generateOrderSize(10.0, 1.7);
+    // Runs longer than the capacity are published in chunks
+    std::vector<Command> commands(NUM_COMMANDS, Command{CommandType::ADD});
+    for (std::size_t i = 0; i < NUM_COMMANDS; i++) { commands[i].seqNum = i + 1; }
+    for (std::size_t offset = 0; offset < NUM_COMMANDS; offset += 20) {
+        queue.pushBulk(commands.data() + offset, 20);
+    }
+    consumer.join();
 
-            Command c = {CommandType::MODIFY};
-            c.idNumber = modifyId; c.price = newPrice; c.qty = newSize;
-            lastSeqNum = eng.submit(c);
+    for (std::size_t i = 0; i < NUM_COMMANDS; i++) {
+        assert(received[i] == i + 1 && "bulk operations should preserve order");
+    }
+    assert(queue.isEmpty() && "the queue should be drained");
+
+    queue.stop();
+    Command out[4];
+    assert(queue.popBulk(out, 4) == 0 && "a stopped, drained queue should return no commands");
+
+    std::cout << "bulkQueueTest() passed for " << name << "!\n";
+}
 
-            modifies.fetch_add(1, std::memory_order_relaxed);
+template<typename EngineType>
+void bookViewTest() {
+    constexpr std::size_t DEPTH = 5;
+    const std::vector<Command> commands = generateOrders(200000);
+
+    EngineType eng;
+    eng.enableBookViews(DEPTH);
+    eng.start();
+    const BookView& view = eng.getBookView();
+    assert(view.readTopOfBook().seqNum == 0 && view.readTopOfBook().bid.quantity == 0 && "the view should start from the empty book");
+
+    // Read while the engine matches, every view must be uncrossed, ordered and never go back in time
+    std::atomic<bool> reading = true;
+    std::uint64_t reads = 0;
+    std::thread reader([&] {
+        DepthLevel bids[DEPTH];
+        DepthLevel asks[DEPTH];
+        SeqNum lastTop = 0;
+        SeqNum lastDepth = 0;
+        while (reading.load(std::memory_order_acquire)) {
+            const TopOfBook top = view.readTopOfBook();
+            assert(top.seqNum >= lastTop && "top of book should never go back in time");
+            assert((top.bid.quantity == 0 || top.ask.quantity == 0 || top.bid.price < top.ask.price) && "top of book should not be crossed");
+            lastTop = top.seqNum;
+
+            const DepthView depth = view.readDepth(bids, asks);
+            assert(depth.seqNum >= lastDepth && "depth should never go back in time");
+            for (std::size_t i = 1; i < depth.bidLevels; i++) {
+                assert(bids[i].price < bids[i - 1].price && bids[i].quantity > 0 && "bid levels should be in price priority");
+            }
+            for (std::size_t i = 1; i < depth.askLevels; i++) {
+                assert(asks[i].price > asks[i - 1].price && asks[i].quantity > 0 && "ask levels should be in price priority");
+            }
+            assert((depth.bidLevels == 0 || depth.askLevels == 0 || bids[0].price < asks[0].price) && "depth should not be crossed");
+            lastDepth = depth.seqNum;
+            reads++;
         }
-    }
+    });
+
+    eng.submitBatch(commands);
+    Command c = {CommandType::ADD};
+    c.symbol = 3; c.idNumber = 1; c.side = Side::BUY; c.price = 10000; c.qty = 7;
+    const SeqNum lastSeqNum = eng.submit(c);
+    waitUntil(eng, lastSeqNum);
+    reading.store(false, std::memory_order_release);
+    reader.join();
+    eng.stop();
+
+    // Once the engine is idle the views match the books
+    const TopOfBook top = view.readTopOfBook();
+    const DepthLevel bestBid = eng.getBook().getBestBid();
+    const DepthLevel bestAsk = eng.getBook().getBestAsk();
+    assert(top.seqNum > 0 && top.seqNum <= lastSeqNum && "the view should be tagged with a command at or after the last change to its book");
+    assert(top.bid.price == bestBid.price && top.bid.quantity == bestBid.quantity && top.ask.price == bestAsk.price && top.ask.quantity == bestAsk.quantity
+           && "the top of book should match the book");
+    DepthLevel bids[DEPTH];
+    DepthLevel asks[DEPTH];
+    DepthLevel expected[DEPTH];
+    const DepthView depth = view.readDepth(bids, asks);
+    assert(depth.seqNum == top.seqNum && depth.bidLevels == eng.getBook().getDepth(Side::BUY, expected) && "depth should match the book");
+    for (std::size_t i = 0; i < depth.bidLevels; i++) {
+        assert(bids[i].price == expected[i].price && bids[i].quantity == expected[i].quantity && bids[i].orderCount == expected[i].orderCount
+               && "bid levels should match the book");
+    }
+
+    const TopOfBook other = eng.getBookView(3).readTopOfBook();
+    assert(other.seqNum == lastSeqNum && other.bid.price == 10000 && other.bid.quantity == 7 && other.ask.quantity == 0
+           && "a book created by an add should get its own view");
+
+    assert(reads > 0 && "the reader should have read while the engine ran");
+
+    std::cout << "bookViewTest() passed!\n";
+}
+
+void multiSymbolEngineTest() {
+    Engine eng;
+    eng.start();
+
+    Command c1 = {CommandType::ADD};
+    c1.symbol = 1; c1.idNumber = 1; c1.side = Side::BUY; c1.price = 10000; c1.qty = 5;
+    eng.submit(c1);
+
+    Command c2 = {CommandType::ADD};
+    c2.symbol = 2; c2.idNumber = 2; c2.side = Side::SELL; c2.price = 9900; c2.qty = 5;
+    eng.submit(c2);
+
+    Command c3 = {CommandType::ADD};
+    c3.symbol = 2; c3.idNumber = 3; c3.side = Side::BUY; c3.price = 9900; c3.qty = 2;
+    eng.submit(c3);
+
+    Command c4 = {CommandType::CANCEL};
+    c4.symbol = 3; c4.idNumber = 1; // symbol 3 has no book so the cancel is rejected
+    const SeqNum lastSeqNum = eng.submit(c4);
+
+    waitUntil(eng, lastSeqNum);
+    eng.stop();
+
+    assert(eng.getBook(1).contains(1) && "order1 should rest in the book of symbol 1");
+    assert(eng.getBook(2).getOrderByID(2).getRemainingQuantity() == 3 && "order2 should only match order3 of the same symbol");
+    assert(!eng.getBook(2).contains(3) && "order3 should be filled");
+    assert(eng.getBook().getNumberOfOrders() == 0 && "the book of symbol 0 should be untouched");
+    assert(!eng.hasBook(3) && "commands other than adds should not create books");
+    assert(eng.getCounters().trades == 1 && eng.getCounters().rejected == 1 && "counters should be summed over all books");
+
+    std::cout << "multiSymbolEngineTest() passed!\n";
+}
+
+void shardedEngineTest() {
+    // Pin to the first and last usable core, which are the same one on a single-core machine
+    const std::vector<int> cores = usableCores();
+    ShardedEngine<SpscEngine> eng(ShardConfig{.shards = 2, .cores = cores.empty() ? std::vector<int>{} : std::vector<int>{cores.front(), cores.back()}});
+    assert(!eng.getShard(0).hasBook(0) && !eng.getShard(1).hasBook(0) && "shards should only create books on demand");
+    eng.start();
+
+    for (SymbolId symbol = 0; symbol < 4; symbol++) {
+        Command buy = {CommandType::ADD};
+        buy.symbol = symbol; buy.idNumber = 1; buy.side = Side::BUY; buy.price = 10000; buy.qty = 10;
+        eng.submit(buy);
+
+        Command sell = {CommandType::ADD};
+        sell.symbol = symbol; sell.idNumber = 2; sell.side = Side::SELL; sell.price = 10000; sell.qty = symbol + 1;
+        eng.submit(sell);
+    }
+    eng.flush();
+
+    assert(eng.shardOf(1) != eng.shardOf(2) && "adjacent symbols should be on different shards");
+    assert(eng.getShard(0).lastProcessed() == 4 && eng.getShard(1).lastProcessed() == 4 && "sequence numbers should be per shard");
+    for (SymbolId symbol = 0; symbol < 4; symbol++) {
+        assert(eng.getBook(symbol).getOrderByID(1).getRemainingQuantity() == 9 - symbol && "every symbol should be matched in its own book");
+    }
+    assert(eng.getCounters().trades == 4 && eng.getCounters().commands == 8 && "counters should be summed over all shards");
+    assert(eng.getShard(eng.shardOf(0)).hasBook(0) && !eng.getShard(1 - eng.shardOf(0)).hasBook(0) && "only the owning shard should hold symbol 0");
+    eng.stop();
+
+    std::cout << "shardedEngineTest() passed!\n";
+}
+
+void cpuAffinityTest() {
+    Engine eng;
+    eng.setCpuAffinity(1 << 20); // no machine has this core
+    bool threw = false;
+    try {
+        eng.start();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && "start should fail when the worker thread cannot be pinned");
+
+    // The engine is left stopped and starts once its core can be used
+    const std::vector<int> cores = usableCores();
+    eng.setCpuAffinity(cores.empty() ? -1 : cores.back());
+    eng.start();
+    Command c = {CommandType::ADD};
+    c.idNumber = 1; c.side = Side::BUY; c.price = 10000; c.qty = 5;
+    waitUntil(eng, eng.submit(c));
+    eng.stop();
+    assert(eng.getBook().contains(1) && "the pinned engine should apply commands");
+
+    std::cout << "cpuAffinityTest() passed!\n";
+}
+
+void producerLanesTest() {
+    // Fair merge: with every lane backed up, each lane gives an equal share of a pop
+    LaneQueue queue(64);
+    const ProducerId second = queue.registerProducer();
+    for (std::uint64_t i = 1; i <= 16; i++) {
+        Command c = {CommandType::ADD};
+        c.idNumber = i;
+        queue.push(c);
+        c.idNumber = 100 + i;
+        queue.push(second, c);
+    }
+    Command out[8];
+    assert(queue.popBulk(out, 8) == 8 && "a backed up queue should fill the pop");
+    for (std::size_t i = 0; i < 4; i++) {
+        assert(out[i].idNumber == i + 1 && out[4 + i].idNumber == 101 + i && "each lane should give half of the pop, in order");
+    }
+    assert(queue.popBulk(out, 8) == 8 && out[0].idNumber == 105 && "the next pop should start from the other lane");
+    queue.markApplied();
+    assert(queue.applied(LaneQueue::DEFAULT_PRODUCER) == 8 && queue.applied(second) == 8 && "applied positions should be per lane");
+
+    // Producers submit without a shared counter, the engine sequences every command as it dequeues it
+    constexpr ProducerId NUM_PRODUCERS = 4;
+    constexpr IdNumber ORDERS_PER_PRODUCER = 5000;
+    LaneEngine eng(1 << 8);
+    eng.start();
+    std::vector<std::thread> producers;
+    for (ProducerId p = 0; p < NUM_PRODUCERS; p++) {
+        producers.emplace_back([&eng, p] {
+            const ProducerId producer = eng.registerProducer();
+            SeqNum position = 0;
+            for (IdNumber i = 0; i < ORDERS_PER_PRODUCER; i++) {
+                // Every add is cancelled right after, a cancel overtaking its add would be rejected
+                Command add = {CommandType::ADD};
+                add.idNumber = p * ORDERS_PER_PRODUCER + i; add.side = p % 2 ? Side::SELL : Side::BUY;
+                add.price = p % 2 ? 10100 : 9900; add.qty = 1;
+                assert(eng.submit(producer, add) == ++position && "positions should count the producer's commands");
+                if (i + 1 < ORDERS_PER_PRODUCER) {
+                    Command cancel = {CommandType::CANCEL};
+                    cancel.idNumber = add.idNumber;
+                    position = eng.submit(producer, cancel);
+                }
+            }
+            while (eng.lastProcessed(producer) < position) { std::this_thread::yield(); }
+        });
+    }
+    for (std::thread& producer : producers) { producer.join(); }
+    eng.stop();
+
+    constexpr SeqNum TOTAL = NUM_PRODUCERS * (2 * ORDERS_PER_PRODUCER - 1);
+    assert(eng.lastProcessed() == TOTAL && eng.lastSubmitted() == TOTAL && "every command should get a consecutive sequence number");
+    assert(eng.getCounters().rejected == 0 && "each producer's commands should be applied in order");
+    assert(eng.getBook().getNumberOfOrders() == NUM_PRODUCERS && "the last add of each producer should rest");
+
+    std::cout << "producerLanesTest() passed!\n";
+}
+
+template<typename EngineType>
+void benchmarkFiveMillionOrders(const char* config) {
+    using namespace std::chrono;
+
+    constexpr int NUM_ORDERS = 5000000;
+    const std::vector<Command> commands = generateOrders(NUM_ORDERS);
+
+    EngineType eng;
+    eng.enableMetrics(true);
+    eng.start();
+
+    const auto start = high_resolution_clock::now();
+
+    SeqNum lastSeqNum = 0;
+    for (const Command& c : commands) {
+        lastSeqNum = eng.submit(c);
+    }
+
+    waitUntil(eng, lastSeqNum);
+    eng.stop();
+
+    const auto end = high_resolution_clock::now();
+    const double elapsed = duration<double>(end - start).count();
+
+    std::cout << "5 Million Orders Benchmark (Add Only, " << config << "):\n";
+    std::cout << "Processed " << NUM_ORDERS << " orders in " << elapsed << " seconds.\n";
+    std::cout << "Throughput: " << (NUM_ORDERS / elapsed) << " orders/sec\n";
+    printLatencyReport(eng.getMetrics(), eng.getCounters());
+    std::cout << "\n";
+}
+
+template<typename EngineType>
+void benchmarkFiveMillionOperations(const char* config) {
+    using namespace std::chrono;
+
+    constexpr int NUM_OPS = 5000000;
+    const std::vector<Command> commands = generateOperations(NUM_OPS);
+    std::atomic<int> adds = 0, cancels = 0, modifies = 0;
+    for (const Command& c : commands) {
+        switch (c.type) {
+            case CommandType::ADD: adds++; break;
+            case CommandType::CANCEL: cancels++; break;
+            case CommandType::MODIFY: modifies++; break;
+        }
+    }
+
+    EngineType eng;
+    eng.enableMetrics(true);
+
+    // Rejects arrive as events on a preallocated ring instead of exceptions
+    RejectRing rejects(1 << 16);
+    std::atomic<bool> draining = true;
+    std::thread rejectConsumer([&] {
+        RejectEvent batch[256];
+        Backoff backoff;
+        while (true) {
+            const std::size_t n = rejects.popBulk(batch, 256);
+            for (std::size_t i = 0; i < n; i++) {
+                switch (batch[i].type) {
+                    case CommandType::ADD: adds.fetch_sub(1, std::memory_order_relaxed); break;
+                    case CommandType::CANCEL: cancels.fetch_sub(1, std::memory_order_relaxed); break;
+                    case CommandType::MODIFY: modifies.fetch_sub(1, std::memory_order_relaxed); break;
+                }
+            }
+            if (n > 0) { backoff.reset(); continue; }
+            if (!draining.load(std::memory_order_acquire) && rejects.isEmpty()) { break; }
+            backoff.pause();
+        }
+    });
+    eng.setRejectRing(&rejects);
+    eng.start();
+
+    const auto start = high_resolution_clock::now();
+
+    SeqNum lastSeqNum = 0;
+    for (const Command& c : commands) {
+        lastSeqNum = eng.submit(c);
+    }
 
     waitUntil(eng, lastSeqNum);
     eng.stop();
@@ -301,29 +1517,832 @@ void benchmarkFiveMillionOperations() {
     const auto end = high_resolution_clock::now();
     const double elapsed = duration<double>(end - start).count();
 
-    std::cout << "5 Million Operations Benchmark (Add/Cancel/Modify):\n";
+    draining.store(false, std::memory_order_release);
+    rejectConsumer.join();
+
+    std::cout << "5 Million Operations Benchmark (Add/Cancel/Modify, " << config << "):\n";
     std::cout << "Adds: " << adds << ", Cancels: " << cancels << ", Modifies: " << modifies << "\n";
     std::cout << "Processed " << NUM_OPS << " operations in " << elapsed << " seconds.\n";
-    std::cout << "Throughput: " << (NUM_OPS / elapsed) << " ops/sec\n\n";
+    std::cout << "Throughput: " << (NUM_OPS / elapsed) << " ops/sec\n";
+    printLatencyReport(eng.getMetrics(), eng.getCounters());
+    std::cout << "\n";
+}
+
+template<typename EngineType>
+static void runUnitTests() {
+    completeFillTest<EngineType>();
+    partialFillTest<EngineType>();
+    multiplePriceLevelTest<EngineType>();
+    timePriorityMatchingTest<EngineType>();
+    modifyValidOrderTest<EngineType>();
+    cancelValidOrderTest<EngineType>();
+    submitBatchTest<EngineType>();
+}
+
+template<typename BookType>
+void benchmarkDepthQueries(const char* config) {
+    using namespace std::chrono;
+
+    constexpr int NUM_ORDERS = 5000000;
+    constexpr std::size_t DEPTH = 10;
+
+    const std::vector<Command> commands = generateOrders(NUM_ORDERS);
+
+    // Quote after every update: top of book, spread and the top levels of both sides
+    BookType book(BookConfig{.orderCapacity = NUM_ORDERS, .matchingMode = MatchingMode::CONTINUOUS});
+    DepthLevel bids[DEPTH];
+    DepthLevel asks[DEPTH];
+    std::uint64_t checksum = 0;
+    nanoseconds queryTime{0};
+    const auto start = high_resolution_clock::now();
+    for (int i = 0; i < NUM_ORDERS; i++) {
+        book.addOrder(i, commands[i].side, commands[i].price, commands[i].qty);
+
+        const auto queryStart = high_resolution_clock::now();
+        checksum += book.getBestBid().quantity + book.getBestAsk().quantity + book.getSpread().value_or(0);
+        checksum += book.getDepth(Side::BUY, bids) + book.getDepth(Side::SELL, asks) + bids[0].quantity + asks[0].quantity;
+        queryTime += high_resolution_clock::now() - queryStart;
+    }
+    const double elapsed = duration<double>(high_resolution_clock::now() - start).count();
+
+    std::cout << "5 Million Orders Benchmark (Depth Queries, " << config << "):\n";
+    std::cout << "Processed " << NUM_ORDERS << " orders in " << elapsed << " seconds with a top-" << DEPTH << " query after each\n";
+    std::cout << "Average query (BBO, spread, top-" << DEPTH << " both sides): " << duration<double, std::nano>(queryTime).count() / NUM_ORDERS
+              << " ns (checksum " << checksum << ")\n\n";
+}
+
+template<typename BookType>
+void benchmarkModifyHeavy(const char* config) {
+    using namespace std::chrono;
+
+    constexpr int NUM_ORDERS = 1000000;
+    constexpr int NUM_MODIFIES = 5000000;
+    const std::vector<Command> orders = generateOrders(NUM_ORDERS);
+
+    std::cout << "5 Million Modifies Benchmark (" << NUM_ORDERS << " resting orders, " << config << "):\n";
+    for (const bool sizeDown : {true, false}) {
+        // Same targets and prices for both runs, only the direction of the size change differs
+        Xoshiro256 rng(42);
+        std::vector<Quantity> qty(NUM_ORDERS);
+        std::vector<Command> modifies(NUM_MODIFIES);
+        for (int i = 0; i < NUM_ORDERS; i++) { qty[i] = orders[i].qty; }
+        for (int i = 0; i < NUM_MODIFIES; i++) {
+            const IdNumber id = rng() % NUM_ORDERS;
+            qty[id] = sizeDown ? std::max<Quantity>(1, qty[id] - 1) : qty[id] + 1;
+            modifies[i] = {CommandType::MODIFY};
+            modifies[i].idNumber = id; modifies[i].price = orders[id].price; modifies[i].qty = qty[id];
+        }
+
+        // Batch mode without match passes, so every order stays resting
+        BookType book(BookConfig{.orderCapacity = NUM_ORDERS});
+        for (const Command& c : orders) {
+            book.addOrder(c.idNumber, c.side, c.price, c.qty);
+        }
+
+        const auto start = high_resolution_clock::now();
+        for (const Command& c : modifies) {
+            book.modifyOrder(c.idNumber, c.price, c.qty);
+        }
+        const double elapsed = duration<double>(high_resolution_clock::now() - start).count();
+        std::cout << (sizeDown ? "Size-down at the same price (in place): " : "Size-up at the same price (requeued): ") << elapsed << " seconds, "
+                  << (NUM_MODIFIES / elapsed) << " modifies/sec\n";
+    }
+    std::cout << "\n";
+}
+
+template<typename BookType>
+void benchmarkSideEntryPoints(const char* config) {
+    using namespace std::chrono;
+
+    constexpr int NUM_ORDERS = 5000000;
+    constexpr std::size_t QUOTE_BLOCK = 16; // orders added on one side before turning to the other, the way a quoter updates
+    std::vector<Command> orders = generateOrders(NUM_ORDERS);
+    const auto firstAsk = std::stable_partition(orders.begin(), orders.end(), [](const Command& c) { return c.side == Side::BUY; });
+    const std::span<const Command> bids(orders.begin(), firstAsk);
+    const std::span<const Command> asks(firstAsk, orders.end());
+
+    std::cout << "5 Million Orders Side Entry Points Benchmark (" << config << ", continuous matching):\n";
+    for (const bool specialized : {false, true}) {
+        BookType book(BookConfig{.orderCapacity = NUM_ORDERS, .matchingMode = MatchingMode::CONTINUOUS});
+        const auto addBlock = [&]<Side S>(const std::span<const Command> block) {
+            for (const Command& c : block) {
+                if (specialized) { book.template addOrder<S>(c.idNumber, c.price, c.qty); }
+                else { book.addOrder(c.idNumber, c.side, c.price, c.qty); }
+            }
+        };
+        const auto start = high_resolution_clock::now();
+        for (std::size_t offset = 0; offset < std::max(bids.size(), asks.size()); offset += QUOTE_BLOCK) {
+            if (offset < bids.size()) { addBlock.template operator()<Side::BUY>(bids.subspan(offset, std::min(QUOTE_BLOCK, bids.size() - offset))); }
+            if (offset < asks.size()) { addBlock.template operator()<Side::SELL>(asks.subspan(offset, std::min(QUOTE_BLOCK, asks.size() - offset))); }
+        }
+        const auto end = high_resolution_clock::now();
+        std::cout << (specialized ? "Side-specialized entry points: " : "Run-time side: ")
+                  << duration<double, std::nano>(end - start).count() / NUM_ORDERS << " ns per add, " << book.getCounters().trades << " trades\n";
+    }
+    std::cout << "\n";
+}
+
+void benchmarkMemoryFootprint() {
+    constexpr std::size_t NUM_ORDERS = 10000000;
+    const std::vector<Command> orders = generateOrders(NUM_ORDERS);
+
+    std::cout << "10 Million Resting Orders Memory Benchmark:\n";
+    const auto load = [&]<typename BookType>(const char* config, const OrderIndexMode mode) {
+        // Batch mode without match passes, so every order rests
+        BookType book(BookConfig{.orderCapacity = NUM_ORDERS, .orderIndex = mode});
+        for (const Command& c : orders) {
+            book.addOrder(c.idNumber, c.side, c.price, c.qty);
+        }
+        const BookMemoryUsage usage = book.getMemoryUsage();
+        const double perOrder = static_cast<double>(usage.total()) / book.getNumberOfOrders();
+        std::cout << config << (mode == OrderIndexMode::HASHED ? ", hashed index: " : ", direct index: ")
+                  << usage.orders / 1e6 << " MB orders, " << usage.levels / 1e6 << " MB levels, " << usage.index / 1e6
+                  << " MB index, " << perOrder << " bytes per order\n";
+    };
+    for (const OrderIndexMode mode : {OrderIndexMode::HASHED, OrderIndexMode::DIRECT}) {
+        load.template operator()<OrderBook>("Map book", mode);
+        load.template operator()<LadderOrderBook>("Ladder book", mode);
+    }
+    std::cout << "\n";
+}
+
+template<typename BookType>
+void benchmarkCancelHeavy(const char* config) {
+    using namespace std::chrono;
+
+    constexpr int NUM_ORDERS = 5000000;
+    const std::vector<Command> orders = generateOrders(NUM_ORDERS);
+    std::vector<IdNumber> cancels(NUM_ORDERS);
+    std::iota(cancels.begin(), cancels.end(), 0);
+    std::shuffle(cancels.begin(), cancels.end(), Xoshiro256(42));
+
+    std::cout << "5 Million Cancels Benchmark (" << config << "):\n";
+    for (const OrderIndexMode mode : {OrderIndexMode::HASHED, OrderIndexMode::DIRECT}) {
+        // Batch mode without match passes, so every order rests until it is canceled
+        BookType book(BookConfig{.orderCapacity = NUM_ORDERS, .orderIndex = mode});
+        const auto start = high_resolution_clock::now();
+        for (const Command& c : orders) {
+            book.addOrder(c.idNumber, c.side, c.price, c.qty);
+        }
+        const auto added = high_resolution_clock::now();
+        for (const IdNumber idNumber : cancels) {
+            book.cancelOrder(idNumber);
+        }
+        const auto end = high_resolution_clock::now();
+        assert(book.getNumberOfOrders() == 0 && "every order should be canceled");
+        std::cout << (mode == OrderIndexMode::HASHED ? "Hashed index: " : "Direct index: ")
+                  << duration<double, std::nano>(added - start).count() / NUM_ORDERS << " ns per add, "
+                  << duration<double, std::nano>(end - added).count() / NUM_ORDERS << " ns per cancel\n";
+    }
+    std::cout << "\n";
+}
+
+void benchmarkExecutionReports() {
+    using namespace std::chrono;
+
+    constexpr int NUM_ORDERS = 5000000;
+
+    // Generate the flow up front so both runs match the exact same orders
+    const std::vector<Command> commands = generateOrders(NUM_ORDERS);
+
+    std::cout << "5 Million Orders Benchmark (Execution Reports):\n";
+    for (const bool streamEnabled : {false, true}) {
+        ExecutionReportRing reports(1 << 16);
+        std::atomic<bool> draining = true;
+        std::uint64_t fills = 0;
+        std::thread consumer;
+
+        SpscEngine eng;
+        if (streamEnabled) {
+            eng.setExecutionReportRing(&reports);
+            consumer = std::thread([&] {
+                ExecutionReport batch[256];
+                Backoff backoff;
+                while (true) {
+                    const std::size_t n = reports.popBulk(batch, 256);
+                    fills += n;
+                    if (n > 0) { backoff.reset(); continue; }
+                    if (!draining.load(std::memory_order_acquire) && reports.isEmpty()) { break; }
+                    backoff.pause();
+                }
+            });
+        }
+        eng.start();
+
+        const auto start = high_resolution_clock::now();
+
+        SeqNum lastSeqNum = 0;
+        for (const Command& c : commands) {
+            lastSeqNum = eng.submit(c);
+        }
+
+        waitUntil(eng, lastSeqNum);
+        eng.stop();
+
+        const auto end = high_resolution_clock::now();
+        const double elapsed = duration<double>(end - start).count();
+
+        draining.store(false, std::memory_order_release);
+        if (consumer.joinable()) { consumer.join(); }
+
+        std::cout << "Trade stream " << (streamEnabled ? "enabled" : "disabled") << ": processed " << NUM_ORDERS << " orders in " << elapsed << " seconds";
+        if (streamEnabled) { std::cout << " (" << fills << " fills drained)"; }
+        std::cout << ".\n";
+        std::cout << "Throughput: " << (NUM_ORDERS / elapsed) << " orders/sec\n";
+    }
+    std::cout << "\n";
+}
+
+void benchmarkMarketData() {
+    using namespace std::chrono;
+
+    constexpr int NUM_ORDERS = 5000000;
+
+    const std::vector<Command> commands = generateOrders(NUM_ORDERS);
+
+    const std::filesystem::path shm = "/dev/shm";
+    const std::string path = ((std::filesystem::is_directory(shm) ? shm : std::filesystem::temp_directory_path()) / "lob_market_data_bench").string();
+
+    std::cout << "5 Million Orders Benchmark (Market Data Ring):\n";
+    for (const bool publishing : {false, true}) {
+        std::optional<MarketDataPublisher> publisher;
+        std::optional<MarketDataSubscriber> subscriber;
+        std::atomic<bool> reading = true;
+        std::uint64_t eventsRead = 0;
+        std::uint64_t eventsLost = 0;
+        std::thread reader;
+
+        SpscEngine eng;
+        if (publishing) {
+            publisher.emplace(path, 1 << 20);
+            subscriber.emplace(path); // subscribed before the first event
+            eng.setMarketDataPublisher(&*publisher);
+            reader = std::thread([&] {
+                BookEvent event{};
+                Backoff backoff;
+                while (true) {
+                    const ReadResult result = subscriber->tryRead(event);
+                    if (result == ReadResult::EVENT) { eventsRead++; backoff.reset(); continue; }
+                    if (result == ReadResult::OVERRUN) { continue; }
+                    if (!reading.load(std::memory_order_acquire)) { break; }
+                    backoff.pause();
+                }
+                eventsLost = subscriber->getLostEvents();
+            });
+        }
+        eng.start();
+
+        const auto start = high_resolution_clock::now();
+        waitUntil(eng, eng.submitBatch(commands));
+        eng.stop();
+        const double elapsed = duration<double>(high_resolution_clock::now() - start).count();
+
+        reading.store(false, std::memory_order_release);
+        if (reader.joinable()) { reader.join(); }
+
+        std::cout << "Market data " << (publishing ? "enabled" : "disabled") << ": processed " << NUM_ORDERS << " orders in " << elapsed << " seconds, "
+                  << (NUM_ORDERS / elapsed) << " orders/sec";
+        if (publishing) {
+            std::cout << ", " << publisher->getPublished() << " events published, " << eventsRead << " read, " << eventsLost << " lost to overruns";
+        }
+        std::cout << "\n";
+    }
+    std::filesystem::remove(path);
+    std::cout << "\n";
+}
+
+void benchmarkBookViews() {
+    using namespace std::chrono;
+
+    constexpr int NUM_ORDERS = 5000000;
+    constexpr std::size_t DEPTH = 10;
+
+    const std::vector<Command> commands = generateOrders(NUM_ORDERS);
+
+    std::cout << "5 Million Orders Benchmark (Book Views):\n";
+    for (const bool viewing : {false, true}) {
+        std::atomic<bool> reading = true;
+        std::uint64_t reads = 0;
+        std::uint64_t updates = 0;
+        std::thread reader;
+
+        SpscEngine eng;
+        if (viewing) {
+            eng.enableBookViews(DEPTH);
+            reader = std::thread([&] {
+                const BookView& view = eng.getBookView();
+                DepthLevel bids[DEPTH];
+                DepthLevel asks[DEPTH];
+                SeqNum lastSeqNum = 0;
+                Backoff backoff;
+                while (reading.load(std::memory_order_acquire)) {
+                    const TopOfBook top = view.readTopOfBook();
+                    reads++;
+                    if (top.seqNum == lastSeqNum) { backoff.pause(); continue; }
+                    // Take the depth image only when the top of book moved on
+                    view.readDepth(bids, asks);
+                    lastSeqNum = top.seqNum;
+                    updates++;
+                    backoff.reset();
+                }
+            });
+        }
+        eng.start();
+
+        const auto start = high_resolution_clock::now();
+        waitUntil(eng, eng.submitBatch(commands));
+        eng.stop();
+        const double elapsed = duration<double>(high_resolution_clock::now() - start).count();
+
+        reading.store(false, std::memory_order_release);
+        if (reader.joinable()) { reader.join(); }
+
+        std::cout << "Book views " << (viewing ? "enabled" : "disabled") << ": processed " << NUM_ORDERS << " orders in " << elapsed << " seconds, "
+                  << (NUM_ORDERS / elapsed) << " orders/sec";
+        if (viewing) {
+            std::cout << ", " << reads << " top of book reads, " << updates << " new views with a top-" << DEPTH << " depth read";
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+}
+
+template<typename EngineType>
+void benchmarkWaitStrategies(const char* config) {
+    using namespace std::chrono;
+
+    constexpr int ROUND_TRIPS = 2000;
+
+    std::cout << "Round Trip Benchmark (Wait Strategies, " << config << "):\n";
+    const std::pair<const char*, WaitStrategy> strategies[] = {
+        {"busy spin", WaitStrategy::BUSY_SPIN},
+        {"spin then yield", WaitStrategy::SPIN_YIELD},
+        {"spin then park", WaitStrategy::SPIN_PARK}
+    };
+    for (const auto& [name, strategy] : strategies) {
+        if (strategy == WaitStrategy::BUSY_SPIN && std::thread::hardware_concurrency() < 2) {
+            // A busy engine thread would only hand the only core back to the submitter when preempted
+            std::cout << "Strategy " << name << ": skipped, needs a core for the engine thread and one for the submitter\n";
+            continue;
+        }
+        EngineType eng;
+        eng.setWaitStrategy(strategy);
+        eng.start();
+
+        // One command at a time after an idle gap, so each round trip includes waking the engine thread
+        LatencyHistogram roundTrips;
+        Command c = {CommandType::ADD};
+        c.side = Side::BUY; c.price = 10000; c.qty = 1;
+        for (int i = 0; i < ROUND_TRIPS; i++) {
+            std::this_thread::sleep_for(microseconds(50));
+            c.type = (i % 2) ? CommandType::CANCEL : CommandType::ADD;
+            c.idNumber = i / 2;
+            const auto start = high_resolution_clock::now();
+            waitUntil(eng, eng.submit(c));
+            roundTrips.record(static_cast<std::uint64_t>(duration_cast<nanoseconds>(high_resolution_clock::now() - start).count()));
+        }
+        eng.stop();
+
+        std::cout << "Strategy " << name << ": round trip (ns) p50 " << roundTrips.percentile(50.0) << ", p99 " << roundTrips.percentile(99.0)
+                  << ", max " << roundTrips.max() << " (" << roundTrips.count() << " samples)\n";
+    }
+    std::cout << "\n";
+}
+
+void benchmarkBatchPolicies() {
+    using namespace std::chrono;
+
+    constexpr int NUM_OPS = 5000000;
+    const std::vector<Command> commands = generateOperations(NUM_OPS);
+
+    const std::pair<const char*, BatchConfig> policies[] = {
+        {"count", BatchConfig{.policy = BatchPolicy::COUNT}},
+        {"time", BatchConfig{.policy = BatchPolicy::TIME}},
+        {"adaptive", BatchConfig{.policy = BatchPolicy::ADAPTIVE}}
+    };
+
+    std::cout << "5 Million Operations Benchmark (Batch Policies):\n";
+    for (const auto& [name, batchConfig] : policies) {
+        SpscEngine eng(1 << 16, {}, batchConfig);
+        eng.start();
+
+        const auto start = high_resolution_clock::now();
+
+        SeqNum lastSeqNum = 0;
+        for (const Command& c : commands) {
+            lastSeqNum = eng.submit(c);
+        }
+
+        waitUntil(eng, lastSeqNum);
+        eng.stop();
+
+        const auto end = high_resolution_clock::now();
+        const double elapsed = duration<double>(end - start).count();
+        const BatchStats stats = eng.batchStats();
+
+        std::cout << "Policy " << name << ": processed " << NUM_OPS << " operations in " << elapsed << " seconds, " << (NUM_OPS / elapsed) << " ops/sec\n";
+        std::cout << "  Match passes: " << stats.passes << ", average batch: " << (stats.passes ? stats.commands / stats.passes : 0)
+                  << ", min: " << stats.minBatch << ", max: " << stats.maxBatch << ", target: " << stats.targetBatch << "\n";
+    }
+    std::cout << "\n";
+}
+
+void benchmarkBatchSubmit() {
+    using namespace std::chrono;
+
+    constexpr int NUM_ORDERS = 5000000;
+    constexpr std::size_t PACKET_SIZE = 32; // commands decoded from one gateway packet
+
+    const std::vector<Command> commands = generateOrders(NUM_ORDERS);
+
+    const auto run = [&]<typename EngineType>(const char* config, const bool batched) {
+        EngineType eng;
+        eng.start();
+
+        const auto start = high_resolution_clock::now();
+
+        SeqNum lastSeqNum = 0;
+        if (batched) {
+            for (std::size_t offset = 0; offset < commands.size(); offset += PACKET_SIZE) {
+                const std::size_t n = std::min(PACKET_SIZE, commands.size() - offset);
+                lastSeqNum = eng.submitBatch(std::span<const Command>(commands.data() + offset, n));
+            }
+        }
+        else {
+            for (const Command& c : commands) {
+                lastSeqNum = eng.submit(c);
+            }
+        }
+
+        waitUntil(eng, lastSeqNum);
+        eng.stop();
+
+        const auto end = high_resolution_clock::now();
+        const double elapsed = duration<double>(end - start).count();
+        std::cout << config << (batched ? ", submitBatch(" + std::to_string(PACKET_SIZE) + ")" : std::string(", submit")) << ": processed "
+                  << NUM_ORDERS << " orders in " << elapsed << " seconds, " << (NUM_ORDERS / elapsed) << " orders/sec\n";
+    };
+
+    std::cout << "5 Million Orders Benchmark (Batch Submit):\n";
+    for (const bool batched : {false, true}) {
+        run.operator()<Engine>("map book, mutex queue", batched);
+        run.operator()<SpscEngine>("map book, SPSC ring", batched);
+        run.operator()<MpscEngine>("map book, MPSC ring", batched);
+    }
+    std::cout << "\n";
+}
+
+void benchmarkJournal() {
+    using namespace std::chrono;
+
+    constexpr int NUM_OPS = 5000000;
+    const std::vector<Command> commands = generateOperations(NUM_OPS);
+    const std::string path = (std::filesystem::temp_directory_path() / "lob_journal_bench.bin").string();
+
+    const std::pair<const char*, std::optional<SyncPolicy>> policies[] = {
+        {"no journal", std::nullopt},
+        {"journal, no sync", SyncPolicy::NONE},
+        {"journal, sync per batch", SyncPolicy::PER_BATCH},
+        {"journal, sync every 5 ms", SyncPolicy::INTERVAL}
+    };
+
+    std::cout << "5 Million Operations Benchmark (Journal):\n";
+    for (const auto& [name, policy] : policies) {
+        std::unique_ptr<Journal> journal;
+        if (policy) {
+            journal = std::make_unique<Journal>(JournalConfig{.path = path, .capacity = NUM_OPS + (NUM_OPS >> 2), .syncPolicy = *policy, .truncate = true});
+        }
+        SpscEngine eng;
+        eng.setJournal(journal.get());
+        eng.enableMetrics(true);
+        eng.start();
+
+        const auto start = high_resolution_clock::now();
+
+        SeqNum lastSeqNum = 0;
+        for (const Command& c : commands) {
+            lastSeqNum = eng.submit(c);
+        }
+
+        waitUntil(eng, lastSeqNum);
+        eng.stop();
+
+        const auto end = high_resolution_clock::now();
+        const double elapsed = duration<double>(end - start).count();
+        const EngineMetrics& metrics = eng.getMetrics();
+
+        std::cout << name << ": processed " << NUM_OPS << " operations in " << elapsed << " seconds, " << (NUM_OPS / elapsed) << " ops/sec";
+        if (journal) { std::cout << ", " << journal->size() << " records, " << journal->getSyncCount() << " syncs"; }
+        std::cout << "\n  Add apply (ns): p50 " << metrics.addTime.percentile(50.0) << ", p99 " << metrics.addTime.percentile(99.0)
+                  << ", p99.9 " << metrics.addTime.percentile(99.9) << "\n";
+    }
+
+    // Rebuild the books from the last journal
+    {
+        Journal journal(JournalConfig{.path = path});
+        SpscEngine eng;
+        eng.setJournal(&journal);
+
+        const auto start = high_resolution_clock::now();
+        const std::size_t replayed = eng.recover();
+        const auto end = high_resolution_clock::now();
+        const double elapsed = duration<double>(end - start).count();
+
+        std::cout << "Recovery: replayed " << replayed << " operations in " << elapsed << " seconds, " << (replayed / elapsed) << " ops/sec\n";
+    }
+    std::filesystem::remove(path);
+    std::cout << "\n";
+}
+
+void benchmarkSnapshot() {
+    using namespace std::chrono;
+
+    constexpr int NUM_ORDERS = 10000000;
+    const std::string path = (std::filesystem::temp_directory_path() / "lob_snapshot_bench.bin").string();
+
+    // Resting orders only, bids below and asks above the reference price so nothing crosses
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<Price> offsetDist(1, 1000);
+    std::uniform_int_distribution<Quantity> qtyDist(1, 100);
+    std::vector<Command> commands(NUM_ORDERS);
+    for (int i = 0; i < NUM_ORDERS; i++) {
+        const Side side = (i % 2) ? Side::SELL : Side::BUY;
+        commands[i] = {CommandType::ADD};
+        commands[i].idNumber = i; commands[i].side = side; commands[i].qty = qtyDist(rng);
+        commands[i].price = side == Side::BUY ? 10000 - offsetDist(rng) : 10000 + offsetDist(rng);
+    }
+
+    std::cout << "10 Million Orders Benchmark (Snapshot):\n";
+    {
+        SpscEngine eng(1 << 16, BookConfig{.orderCapacity = NUM_ORDERS});
+        eng.start();
+        waitUntil(eng, eng.submitBatch(commands));
+        eng.stop();
+
+        const auto start = high_resolution_clock::now();
+        eng.saveSnapshot(path);
+        const auto end = high_resolution_clock::now();
+        std::cout << "Saved " << eng.getBook().getNumberOfOrders() << " orders (" << std::filesystem::file_size(path) / (1 << 20)
+                  << " MiB) in " << duration<double>(end - start).count() << " seconds\n";
+    }
+    {
+        SpscEngine eng(1 << 16, BookConfig{.orderCapacity = NUM_ORDERS});
+
+        const auto start = high_resolution_clock::now();
+        eng.loadSnapshot(path);
+        const auto end = high_resolution_clock::now();
+        std::cout << "Loaded " << eng.getBook().getNumberOfOrders() << " orders in " << duration<double>(end - start).count() << " seconds\n";
+    }
+    std::filesystem::remove(path);
+    std::cout << "\n";
+}
+
+void benchmarkShardScaling() {
+    using namespace std::chrono;
+
+    TransitionMatrix matrix = {
+        {0.80, 0.10, 0.10}, // Neutral
+        {0.10, 0.85, 0.05}, // Buy Pressure
+        {0.10, 0.05, 0.85} // Sell Pressure
+    };
+
+    std::random_device rd;
+    std::mt19937 rng(rd());
+
+    constexpr SymbolId NUM_SYMBOLS = 1000;
+    constexpr int NUM_ORDERS = 5000000;
+
+    // Every symbol follows its own market state so the books evolve independently
+    std::vector<OrderGenerator> generators;
+    generators.reserve(NUM_SYMBOLS);
+    for (SymbolId symbol = 0; symbol < NUM_SYMBOLS; symbol++) {
+        generators.emplace_back(matrix, rng);
+    }
+    std::uniform_int_distribution<SymbolId> symbolDist(0, NUM_SYMBOLS - 1);
+
+    std::vector<Command> commands(NUM_ORDERS);
+    for (int i = 0; i < NUM_ORDERS; i++) {
+        const SymbolId symbol = symbolDist(rng);
+        OrderGenerator& generator = generators[symbol];
+        generator.nextState();
+        const Side orderSide = generator.pickOrderSide();
+        commands[i] = {CommandType::ADD};
+        commands[i].symbol = symbol; commands[i].idNumber = i; commands[i].side = orderSide;
+        commands[i].price = generator.generateOrderPrice(10000, orderSide, 1.0, 2.5); // reference price is $100.00
+        commands[i].qty = generator.generateOrderSize(10.0, 1.7);
+    }
+
+    const std::size_t maxShards = std::max<std::size_t>(2, std::thread::hardware_concurrency());
+    const std::vector<int> cores = usableCores();
+    std::cout << "5 Million Orders Benchmark (" << NUM_SYMBOLS << " symbols, sharded SPSC engines):\n";
+    for (std::size_t shards = 1; shards <= maxShards; shards *= 2) {
+        ShardConfig config{.shards = shards};
+        for (std::size_t core = 0; core < shards && cores.size() > 1; core++) {
+            config.cores.push_back(cores[1 + core % (cores.size() - 1)]); // keep the first core for the submitting thread
+        }
+        ShardedEngine<SpscEngine> eng(config);
+        eng.start();
+
+        const auto start = high_resolution_clock::now();
+
+        for (const Command& c : commands) {
+            eng.submit(c);
+        }
+        eng.flush();
+
+        const auto end = high_resolution_clock::now();
+        const double elapsed = duration<double>(end - start).count();
+        const EngineCounters counters = eng.getCounters();
+        eng.stop();
+
+        std::cout << shards << " shard(s): processed " << NUM_ORDERS << " orders in " << elapsed << " seconds, "
+                  << (NUM_ORDERS / elapsed) << " orders/sec, " << counters.trades << " trades\n";
+    }
+    std::cout << "\n";
+}
+
+/**
+ * @brief Submits an equal share of the commands from each producer thread, one command per submit, and
+ * returns the seconds until the engine applied them all
+ */
+template<typename EngineType>
+static double timeProducers(const std::vector<Command>& commands, const std::size_t numProducers) {
+    using namespace std::chrono;
+
+    EngineType eng;
+    eng.start();
+    std::atomic<bool> go{false};
+    std::vector<std::thread> producers;
+    const std::size_t share = commands.size() / numProducers;
+    for (std::size_t p = 0; p < numProducers; p++) {
+        producers.emplace_back([&, p] {
+            const std::size_t first = p * share;
+            const std::size_t last = p + 1 == numProducers ? commands.size() : first + share;
+            while (!go.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+            if constexpr (requires { eng.registerProducer(); }) {
+                const ProducerId producer = eng.registerProducer();
+                for (std::size_t i = first; i < last; i++) { eng.submit(producer, commands[i]); }
+            }
+            else {
+                for (std::size_t i = first; i < last; i++) { eng.submit(commands[i]); }
+            }
+        });
+    }
+
+    const auto start = high_resolution_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& producer : producers) { producer.join(); }
+    waitUntil(eng, commands.size());
+    const auto end = high_resolution_clock::now();
+    eng.stop();
+    return duration<double>(end - start).count();
+}
+
+void benchmarkProducerScaling() {
+    constexpr std::size_t NUM_ORDERS = 1000000;
+    const std::vector<Command> commands = generateOrders(NUM_ORDERS);
+
+    std::cout << "1 Million Orders Producer Scaling Benchmark (one command per submit):\n";
+    for (std::size_t producers = 1; producers <= 16; producers *= 2) {
+        const double mutexTime = timeProducers<Engine>(commands, producers);
+        const double mpscTime = timeProducers<MpscEngine>(commands, producers);
+        const double laneTime = timeProducers<LaneEngine>(commands, producers);
+        std::cout << producers << " producer(s): mutex queue " << (NUM_ORDERS / mutexTime) << " orders/sec, MPSC ring "
+                  << (NUM_ORDERS / mpscTime) << " orders/sec, producer lanes " << (NUM_ORDERS / laneTime) << " orders/sec\n";
+    }
+    std::cout << "\n";
+}
+
+void benchmarkOrderGeneration() {
+    using namespace std::chrono;
+
+    TransitionMatrix matrix = {
+        {0.80, 0.10, 0.10}, // Neutral
+        {0.10, 0.85, 0.05}, // Buy Pressure
+        {0.10, 0.05, 0.85} // Sell Pressure
+    };
+    constexpr std::size_t NUM_ORDERS = 5000000;
+    OrderColumns columns;
+    columns.resize(NUM_ORDERS);
+
+    std::cout << "5 Million Orders Benchmark (Order Generation):\n";
+    {
+        std::mt19937 rng(42);
+        OrderGenerator generator(matrix, rng);
+        const auto start = high_resolution_clock::now();
+        for (std::size_t i = 0; i < NUM_ORDERS; i++) {
+            generator.nextState();
+            columns.side[i] = generator.pickOrderSide();
+            columns.price[i] = generator.generateOrderPrice(10000, columns.side[i], 1.0, 2.5);
+            columns.qty[i] = generator.generateOrderSize(10.0, 1.7);
+        }
+        const double elapsed = duration<double>(high_resolution_clock::now() - start).count();
+        std::cout << "OrderGenerator, one call per field: " << elapsed << " seconds, " << (NUM_ORDERS / elapsed) << " orders/sec\n";
+    }
+
+    const BulkOrderGenerator generator(matrix);
+    const std::size_t maxThreads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    for (std::size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        const auto start = high_resolution_clock::now();
+        generator.generate(columns, NUM_ORDERS, threads);
+        const double elapsed = duration<double>(high_resolution_clock::now() - start).count();
+        std::cout << "BulkOrderGenerator, " << threads << " thread(s): " << elapsed << " seconds, " << (NUM_ORDERS / elapsed) << " orders/sec\n";
+    }
+    std::cout << "\n";
 }
 
 int main() {
     std::cout << "UNIT TESTS\n";
     std::cout << "----------------\n";
-    completeFillTest();
-    partialFillTest();
-    multiplePriceLevelTest();
-    timePriorityMatchingTest();
-    modifyValidOrderTest();
-    cancelValidOrderTest();
+    std::cout << "Map book:\n";
+    runUnitTests<Engine>();
+    std::cout << "Ladder book:\n";
+    runUnitTests<LadderEngine>();
+    std::cout << "SPSC ring queue:\n";
+    runUnitTests<SpscEngine>();
+    std::cout << "MPSC ring queue:\n";
+    runUnitTests<MpscEngine>();
+    std::cout << "Continuous matching:\n";
+    runUnitTests<ContinuousEngine>();
+    std::cout << "Producer lanes:\n";
+    runUnitTests<LaneEngine>();
+    ladderBestLevelTest();
+    orderPoolTest();
+    orderIndexTest();
+    continuousMatchingTest();
+    depthTest<OrderBook>();
+    depthTest<LadderOrderBook>();
+    modifyReduceTest<OrderBook>();
+    modifyReduceTest<LadderOrderBook>();
+    orderTypesTest<OrderBook>();
+    orderTypesTest<LadderOrderBook>();
+    memoryUsageTest<OrderBook>();
+    memoryUsageTest<LadderOrderBook>();
+    sideEntryPointsTest<OrderBook>();
+    sideEntryPointsTest<LadderOrderBook>();
+    batchControllerTest();
+    executionReportTest();
+    latencyHistogramTest();
+    engineCountersTest();
+    rejectEventTest();
+    marketDataTest();
+    journalRecoveryTest();
+    journalTornTailTest();
+    snapshotTest<Engine>();
+    snapshotTest<LadderEngine>();
+    bulkQueueTest<BoundedQueue>("BoundedQueue");
+    bulkQueueTest<SpscRingQueue>("SpscRingQueue");
+    bulkQueueTest<MpscRingQueue>("MpscRingQueue");
+    bulkQueueTest<LaneQueue>("LaneQueue");
+    waitStrategyTest<Engine>("BoundedQueue");
+    waitStrategyTest<SpscEngine>("SpscRingQueue");
+    waitStrategyTest<MpscEngine>("MpscRingQueue");
+    waitStrategyTest<LaneEngine>("LaneQueue");
+    bookViewTest<Engine>();
+    bookViewTest<ContinuousEngine>();
+    multiSymbolEngineTest();
+    shardedEngineTest();
+    cpuAffinityTest();
+    producerLanesTest();
+    replayTest();
+    bulkGeneratorTest();
 
     std::cout << "All tests passed!\n";
     std::cout << "----------------\n";
 
     std::cout << "BENCHMARKING\n";
     std::cout << "----------------\n";
-    benchmarkFiveMillionOrders();
-    benchmarkFiveMillionOperations();
+    benchmarkFiveMillionOrders<Engine>("map book, mutex queue");
+    benchmarkFiveMillionOrders<LadderEngine>("ladder book, mutex queue");
+    benchmarkFiveMillionOrders<SpscEngine>("map book, SPSC ring");
+    benchmarkFiveMillionOrders<MpscEngine>("map book, MPSC ring");
+    benchmarkFiveMillionOrders<ContinuousEngine>("map book, mutex queue, continuous matching");
+    benchmarkFiveMillionOperations<Engine>("map book, mutex queue");
+    benchmarkFiveMillionOperations<LadderEngine>("ladder book, mutex queue");
+    benchmarkFiveMillionOperations<SpscEngine>("map book, SPSC ring");
+    benchmarkFiveMillionOperations<MpscEngine>("map book, MPSC ring");
+    benchmarkFiveMillionOperations<ContinuousEngine>("map book, mutex queue, continuous matching");
+    benchmarkDepthQueries<OrderBook>("map book");
+    benchmarkDepthQueries<LadderOrderBook>("ladder book");
+    benchmarkModifyHeavy<OrderBook>("map book");
+    benchmarkModifyHeavy<LadderOrderBook>("ladder book");
+    benchmarkSideEntryPoints<OrderBook>("map book");
+    benchmarkSideEntryPoints<LadderOrderBook>("ladder book");
+    benchmarkCancelHeavy<OrderBook>("map book");
+    benchmarkCancelHeavy<LadderOrderBook>("ladder book");
+    benchmarkMemoryFootprint();
+    benchmarkExecutionReports();
+    benchmarkMarketData();
+    benchmarkBookViews();
+    benchmarkWaitStrategies<Engine>("mutex queue");
+    benchmarkWaitStrategies<SpscEngine>("SPSC ring");
+    benchmarkBatchPolicies();
+    benchmarkBatchSubmit();
+    benchmarkJournal();
+    benchmarkSnapshot();
+    benchmarkShardScaling();
+    benchmarkProducerScaling();
+    benchmarkOrderGeneration();
 
     return 0;
 }
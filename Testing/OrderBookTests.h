@@ -1,43 +1,277 @@
 #pragma once
 #include "Order_Book/OrderBook.h"
 #include "Order_Generator/MarkovParetoOrderGenerator.h"
+#include "Order_Generator/BulkOrderGenerator.h"
+#include "Order_Generator/Xoshiro256.h"
 #include "Engine/Engine.h"
+#include "Engine/ShardedEngine.h"
+#include "Engine/CpuAffinity.h"
+#include "Replay/Replayer.h"
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 #include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <optional>
 #include <thread>
+#include <unordered_map>
 
-static void waitUntil(Engine& eng, SeqNum target);
+template<typename EngineType>
+static void waitUntil(EngineType& eng, SeqNum target);
 
 /**
  * @brief Tests filling orders completely in the order book
  */
+template<typename EngineType>
 void completeFillTest();
 /**
  * @brief Tests filling orders partially in the order book
  */
+template<typename EngineType>
 void partialFillTest();
 /**
  * @brief Tests if matching occurs at best price in an order book with multiple price levels
  */
+template<typename EngineType>
 void multiplePriceLevelTest();
 /**
  * @brief Tests matching orders according to time priority in the order book
  */
+template<typename EngineType>
 void timePriorityMatchingTest();
 /**
  * @brief Tests modifying a valid order in the order book
  */
+template<typename EngineType>
 void modifyValidOrderTest();
+/**
+ * @brief Tests that a same-price size-down keeps queue position while size-ups and price changes requeue the order
+ */
+template<typename BookType>
+void modifyReduceTest();
+/**
+ * @brief Tests that IOC, FOK and market orders are matched on arrival and never rest, and the FOK liquidity check
+ */
+template<typename BookType>
+void orderTypesTest();
+/**
+ * @brief Tests that the memory accounting counts orders, levels and the id index and keeps reserved slots counted
+ */
+template<typename BookType>
+void memoryUsageTest();
+/**
+ * @brief Tests that the side-specialized entry points leave the same book as the run-time side ones
+ */
+template<typename BookType>
+void sideEntryPointsTest();
 /**
  * @brief Tests canceling valid orders in the order book
  */
+template<typename EngineType>
 void cancelValidOrderTest();
+/**
+ * @brief Tests that business rejects are published as events with their reason instead of raising exceptions
+ */
+void rejectEventTest();
+/**
+ * @brief Tests that a fresh engine rebuilds every book and continues the sequence from a journal
+ */
+void journalRecoveryTest();
+/**
+ * @brief Tests that a reopened journal discards the records after a torn one and that replay stops at a sequence gap
+ */
+void journalTornTailTest();
+/**
+ * @brief Tests that a snapshot plus the journal after it restores levels, fill state, time priority and sequence numbers,
+ * and that damaged snapshots are rejected
+ */
+template<typename EngineType>
+void snapshotTest();
+/**
+ * @brief Tests that a batch submit reserves a contiguous sequence range and every command is applied
+ */
+template<typename EngineType>
+void submitBatchTest();
+/**
+ * @brief Tests bulk push and pop of a queue with runs longer than its capacity
+ *
+ * @param name The name of the queue being tested
+ */
+template<typename Queue>
+void bulkQueueTest(const char* name);
+/**
+ * @brief Tests that an engine applies commands arriving after an idle gap and stops cleanly with every wait strategy
+ *
+ * @param name The name of the queue being tested
+ */
+template<typename EngineType>
+void waitStrategyTest(const char* name);
+/**
+ * @brief Tests best level tracking of the ladder book across bitmap words and the overflow range
+ */
+void ladderBestLevelTest();
+/**
+ * @brief Tests slot reuse and intrusive level linking in the order pool
+ */
+void orderPoolTest();
+/**
+ * @brief Tests lookups, overwrites and backward-shift erasure of both id index modes against a reference map
+ */
+void orderIndexTest();
+/**
+ * @brief Tests matching aggressive orders on arrival in continuous matching mode
+ */
+void continuousMatchingTest();
+/**
+ * @brief Tests that level aggregates, the best bid and offer, the spread and top-N depth follow adds, cancels and fills
+ */
+template<typename BookType>
+void depthTest();
+/**
+ * @brief Tests the count, time and adaptive batching policies and their metrics
+ */
+void batchControllerTest();
+/**
+ * @brief Tests that fills are streamed as execution reports with maker, taker, symbol and per-symbol sequence
+ */
+void executionReportTest();
+/**
+ * @brief Tests percentile accuracy of the latency histogram
+ */
+void latencyHistogramTest();
+/**
+ * @brief Tests the engine counters and that latencies are recorded per command type
+ */
+void engineCountersTest();
+/**
+ * @brief Tests the published book event sequence, overrun detection and symbol stamping of the market data ring
+ */
+void marketDataTest();
+/**
+ * @brief Tests that book views read from another thread while the engine runs are consistent, uncrossed and
+ * monotonic, and match the books once the engine is idle
+ */
+template<typename EngineType>
+void bookViewTest();
+/**
+ * @brief Tests that one engine keeps a separate book per symbol and rejects commands for unknown symbols
+ */
+void multiSymbolEngineTest();
+/**
+ * @brief Tests routing by symbol, per-shard sequence numbers and flushing in the sharded engine
+ */
+void shardedEngineTest();
+/**
+ * @brief Tests that start fails and leaves the engine stopped when its thread cannot be pinned, and pins to a usable core
+ */
+void cpuAffinityTest();
+/**
+ * @brief Tests the fair merge of producer lanes and that an engine sequences commands of several producers on dequeue
+ */
+void producerLanesTest();
+/**
+ * @brief Tests replaying binary and CSV files, skipping malformed CSV lines and recorded pacing
+ */
+void replayTest();
+/**
+ * @brief Tests that the bulk generator is deterministic across thread counts and follows the configured mix
+ */
+void bulkGeneratorTest();
 /**
  * @brief Benchmarks the efficiency of simulating 5,000,000 nonconcurrent orders in the order book
+ *
+ * @param config The name of the book backend and queue being benchmarked
  */
-void benchmarkFiveMillionOrders();
+template<typename EngineType>
+void benchmarkFiveMillionOrders(const char* config);
 /**
  * @brief Benchmarks the efficiency of simulating 5,000,000 nonconcurrent operations in the order book
+ *
+ * @param config The name of the book backend and queue being benchmarked
+ */
+template<typename EngineType>
+void benchmarkFiveMillionOperations(const char* config);
+/**
+ * @brief Benchmarks querying the best bid and offer, the spread and the top 10 levels of both sides after every add
+ *
+ * @param config The name of the book backend being benchmarked
+ */
+template<typename BookType>
+void benchmarkDepthQueries(const char* config);
+/**
+ * @brief Benchmarks 5,000,000 same-price modifies of 1,000,000 resting orders, all size-downs and then all size-ups
+ *
+ * @param config The name of the book backend being benchmarked
+ */
+template<typename BookType>
+void benchmarkModifyHeavy(const char* config);
+/**
+ * @brief Benchmarks 5,000,000 adds in blocks of one side through the run-time side and the side-specialized entry points
+ *
+ * @param config The name of the book backend being benchmarked
+ */
+template<typename BookType>
+void benchmarkSideEntryPoints(const char* config);
+/**
+ * @brief Benchmarks the memory held by 10,000,000 resting orders with each book backend and id index mode and prints the bytes per order
+ */
+void benchmarkMemoryFootprint();
+/**
+ * @brief Benchmarks adding 5,000,000 resting orders and canceling them in random order with the hashed and the direct id index
+ *
+ * @param config The name of the book backend being benchmarked
+ */
+template<typename BookType>
+void benchmarkCancelHeavy(const char* config);
+/**
+ * @brief Benchmarks matching throughput of 5,000,000 pre-generated orders with the execution report stream disabled and enabled
+ */
+void benchmarkExecutionReports();
+/**
+ * @brief Benchmarks matching throughput of 5,000,000 pre-generated orders with the market data ring disabled and
+ * enabled, with a subscriber thread reading the ring
+ */
+void benchmarkMarketData();
+/**
+ * @brief Benchmarks matching throughput of 5,000,000 pre-generated orders with the book views disabled and enabled,
+ * with a reader thread polling the top of book and taking the depth image whenever it changed
+ */
+void benchmarkBookViews();
+/**
+ * @brief Benchmarks the round trip of single commands submitted after an idle gap with each engine wait strategy
+ *
+ * @param config The name of the queue being benchmarked
+ */
+template<typename EngineType>
+void benchmarkWaitStrategies(const char* config);
+/**
+ * @brief Benchmarks 5,000,000 pre-generated operations under the count, time and adaptive batching policies
+ */
+void benchmarkBatchPolicies();
+/**
+ * @brief Benchmarks 5,000,000 pre-generated orders submitted one at a time and in packet-sized batches
+ */
+void benchmarkBatchSubmit();
+/**
+ * @brief Benchmarks 5,000,000 pre-generated operations without a journal and under each sync policy, then replays the journal
+ */
+void benchmarkJournal();
+/**
+ * @brief Benchmarks saving and bulk loading a snapshot of a book with 10,000,000 resting orders
+ */
+void benchmarkSnapshot();
+/**
+ * @brief Benchmarks aggregate throughput of 5,000,000 pre-generated orders across 1,000 symbols as the number of shards grows
+ */
+void benchmarkShardScaling();
+/**
+ * @brief Benchmarks 1,000,000 pre-generated orders submitted from 1 to 16 producer threads through the mutex queue, the MPSC ring and producer lanes
+ */
+void benchmarkProducerScaling();
+/**
+ * @brief Benchmarks generating 5,000,000 orders with the per-call OrderGenerator and with the bulk generator on 1 to N threads
  */
-void benchmarkFiveMillionOperations();
+void benchmarkOrderGeneration();